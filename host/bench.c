@@ -0,0 +1,292 @@
+// Microbenchmarks of the app core primitives
+//
+// Numbers are host CPU time and only meaningful relative to each other
+// (e.g. before/after a change), the device is orders of magnitude slower.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "common.h"
+#include "host.h"
+#include "platform.h"
+
+#include "stream.h"
+#include "cbor.h"
+#include "base58.h"
+#include "crc32.h"
+#include "textUtils.h"
+#include "bip44.h"
+#include "hash.h"
+#include "hex_utils.h"
+#include "txHashBuilder.h"
+#include "attestUtxo.h"
+#include "keyDerivation.h"
+#include "messageSigning.h"
+
+// Prevents the compiler from optimizing the measured work away
+static volatile uint64_t sink;
+
+// https://cardanoexplorer.com/tx/f33b1f56240c9f4afc9dd9a9141737b2937b6cd856dd67fda81cc794d2670580
+static const char* txHex =
+        "839f8200d818582482582034bbdf0a10e7290ad22e3ee791b6b3c35c206ab8b5"
+        "1bb749a2b06489ceebf5f400ff9f8282d818584283581c5f5bee73ed41ff6c84"
+        "90dfdb4732178e0216ccf7badbe1e77d5d7ff8a101581e581c1e9a0361bdc37d"
+        "b7ab7ea2a3f187761877f3db11211fc7436131f15e001ab10129441b00000185"
+        "ae645c2d8282d818584283581cada4052647c47745abfc9e04d7dc5c5c0a8542"
+        "8f5b741be6687e6005a101581e581cd8669b0c1a9f2fccb28d3ef58ef8efad73"
+        "aead7117b6559a5f857813001acdb5f5841a1633e6208282d818584283581c65"
+        "32caadc0b498be1813d12f33bf81d68d5662255cc640b881a29315a101581e58"
+        "1cca3e553c9c63c580936df7433aac461e4efb6ce966206e083af22d0e001a9c"
+        "7427f71a19cf10348282d818584283581c6fd85cfe0ae8c346552717424229d5"
+        "ac928e72b0cbd5587a5d9bd8e5a101581e581c2b0b011ba3683d2eb420332a08"
+        "4fe7ecbdefa204c415cd7aa17e216d001a1c29005f1ac38bbcf88282d8185842"
+        "83581c431923e34d95851fba3c88e99d9d366eb1d595e5436c68da1b4699a5a1"
+        "01581e581c3054e511bd5acd29e7540b417600367915afa6f95b1a40246aa4fc"
+        "9f001af7fec6a71a794fa104ffa0";
+
+static uint8_t tx[500];
+static size_t txSize;
+
+// Hash of the input and raw address of the first output of the tx above
+static const size_t INPUT_HASH_OFFSET = 11;
+static const size_t ADDRESS_OFFSET = 52;
+static const size_t ADDRESS_SIZE = 66;
+
+// One APDU worth of data
+static uint8_t data[255];
+
+
+// Primitives (one call = one op)
+
+// Returns number of bytes processed
+typedef size_t (*bench_fn_t)();
+
+static size_t bench_cborWriteToken()
+{
+	uint8_t buf[9];
+	size_t size = cbor_writeToken(CBOR_TYPE_UNSIGNED, sink + 1673668090925, buf, SIZEOF(buf));
+	sink += buf[0];
+	return size;
+}
+
+static size_t bench_cborParseToken()
+{
+	const uint8_t buf[] = {0x1b, 0x00, 0x00, 0x01, 0x85, 0xae, 0x64, 0x5c, 0x2d};
+	cbor_token_t token = cbor_parseToken(buf, SIZEOF(buf));
+	sink += token.value;
+	return SIZEOF(buf);
+}
+
+static size_t bench_streamAppendShift()
+{
+	static stream_t stream;
+	stream_init(&stream);
+	stream_appendData(&stream, data, 64);
+	stream_advancePos(&stream, 32);
+	stream_shift(&stream);
+	sink += stream_availableBytes(&stream);
+	return 64;
+}
+
+static size_t bench_base58Encode()
+{
+	char out[120];
+	sink += encode_base58(tx + ADDRESS_OFFSET, ADDRESS_SIZE, out, SIZEOF(out));
+	return ADDRESS_SIZE;
+}
+
+static size_t bench_crc32()
+{
+	sink += crc32(data, SIZEOF(data));
+	return SIZEOF(data);
+}
+
+static size_t bench_formatAdaAmount()
+{
+	char out[30];
+	sink += str_formatAdaAmount(out, SIZEOF(out), 1673668090925 + sink % 2);
+	return 0;
+}
+
+static size_t bench_bip44Parse()
+{
+	const uint8_t wire[] = {
+		5,
+		0x80, 0x00, 0x00, 0x2c,
+		0x80, 0x00, 0x07, 0x17,
+		0x80, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x01,
+	};
+	bip44_path_t path;
+	size_t size = bip44_parseFromWire(&path, wire, SIZEOF(wire));
+	sink += path.path[BIP44_I_ADDRESS];
+	return size;
+}
+
+static size_t bench_bip44Print()
+{
+	const bip44_path_t path = {
+		.path = {BIP_44 | HARDENED_BIP32, ADA_COIN_TYPE | HARDENED_BIP32, HARDENED_BIP32, 0, 1},
+		.length = 5,
+	};
+	char out[100];
+	bip44_printToStr(&path, out, SIZEOF(out));
+	sink += out[0];
+	return 0;
+}
+
+static size_t bench_blake2b256()
+{
+	uint8_t hash[32];
+	blake2b_256_hash(data, SIZEOF(data), hash, SIZEOF(hash));
+	sink += hash[0];
+	return SIZEOF(data);
+}
+
+static size_t bench_txHashBuilder()
+{
+	static tx_hash_builder_t builder;
+	uint8_t hash[32];
+
+	txHashBuilder_init(&builder);
+	txHashBuilder_enterInputs(&builder);
+	txHashBuilder_addUtxoInput(&builder, tx + INPUT_HASH_OFFSET, 32, 0);
+	txHashBuilder_enterOutputs(&builder);
+	for (unsigned i = 0; i < 5; i++) {
+		txHashBuilder_addOutput(&builder, tx + ADDRESS_OFFSET, ADDRESS_SIZE, 1000000);
+	}
+	txHashBuilder_enterMetadata(&builder);
+	size_t size = txHashBuilder_getSerializedSize(&builder);
+	txHashBuilder_finalize(&builder, hash, SIZEOF(hash));
+	sink += hash[0];
+	return size;
+}
+
+static size_t bench_attestUtxoParse()
+{
+	static attest_utxo_parser_state_t state;
+
+	parser_init(&state, 4);
+	// The parser buffers only part of the tx, feed it as the signTx APDUs would
+	for (size_t pos = 0; pos < txSize; pos += 64) {
+		size_t size = (txSize - pos < 64) ? txSize - pos : 64;
+		stream_appendData(&state.stream, tx + pos, size);
+		BEGIN_TRY {
+			TRY {
+				parser_keepParsing(&state);
+			}
+			CATCH(ERR_NOT_ENOUGH_INPUT)
+			{
+			}
+			FINALLY {
+			}
+		} END_TRY;
+	}
+	sink += parser_getAttestedAmount(&state);
+	return txSize;
+}
+
+static const bip44_path_t WITNESS_PATH = {
+	.path = {BIP_44 | HARDENED_BIP32, ADA_COIN_TYPE | HARDENED_BIP32, HARDENED_BIP32, 0, 5},
+	.length = 5,
+};
+
+static size_t bench_derivePublicKey()
+{
+	extendedPublicKey_t extPubKey;
+	deriveExtendedPublicKey(&WITNESS_PATH, &extPubKey);
+	sink += extPubKey.pubKey[0];
+	return 0;
+}
+
+static size_t bench_getTxWitness()
+{
+	bip44_path_t path = WITNESS_PATH;
+	uint8_t signature[64];
+	getTxWitness(&path, tx + INPUT_HASH_OFFSET, 32, signature, SIZEOF(signature));
+	sink += signature[0];
+	return 32;
+}
+
+
+// Measurement
+
+typedef struct {
+	const char* name;
+	bench_fn_t fn;
+} bench_t;
+
+#define BENCH(fn) { #fn, fn }
+
+static const bench_t BENCHMARKS[] = {
+	BENCH(bench_cborWriteToken),
+	BENCH(bench_cborParseToken),
+	BENCH(bench_streamAppendShift),
+	BENCH(bench_base58Encode),
+	BENCH(bench_crc32),
+	BENCH(bench_formatAdaAmount),
+	BENCH(bench_bip44Parse),
+	BENCH(bench_bip44Print),
+	BENCH(bench_blake2b256),
+	BENCH(bench_txHashBuilder),
+	BENCH(bench_attestUtxoParse),
+	BENCH(bench_derivePublicKey),
+	BENCH(bench_getTxWitness),
+};
+
+static uint64_t nowNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Minimal wall time spent in each benchmark round
+static const uint64_t ROUND_NS = 200 * 1000 * 1000;
+
+static void runBenchmark(const bench_t* bench)
+{
+	// Warm up and calibrate the number of iterations
+	uint64_t iterations = 1;
+	uint64_t elapsed = 0;
+	size_t bytesPerOp = 0;
+
+	while (true) {
+		uint64_t start = nowNs();
+		for (uint64_t i = 0; i < iterations; i++) {
+			bytesPerOp = bench->fn();
+		}
+		elapsed = nowNs() - start;
+		if (elapsed >= ROUND_NS) break;
+		iterations *= 2;
+	}
+
+	double nsPerOp = (double) elapsed / iterations;
+	printf("%-26s %12.1f ns/op", bench->name, nsPerOp);
+	if (bytesPerOp > 0) {
+		printf(" %12.2f MB/s (%u B/op)", bytesPerOp * 1000.0 / nsPerOp, (unsigned) bytesPerOp);
+	}
+	printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+	host_platform_init();
+
+	txSize = parseHexString(txHex, tx, SIZEOF(tx));
+	for (size_t i = 0; i < SIZEOF(data); i++) {
+		data[i] = (uint8_t) (i * 31 + 7);
+	}
+
+	// Optional arguments select benchmarks by name
+	for (size_t i = 0; i < ARRAY_LEN(BENCHMARKS); i++) {
+		bool isSelected = (argc <= 1);
+		for (int a = 1; a < argc; a++) {
+			if (strstr(BENCHMARKS[i].name, argv[a]) != NULL) isSelected = true;
+		}
+		if (isSelected) runBenchmark(&BENCHMARKS[i]);
+	}
+	return 0;
+}
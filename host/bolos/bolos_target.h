@@ -0,0 +1,6 @@
+#ifndef H_HOST_BOLOS_TARGET
+#define H_HOST_BOLOS_TARGET
+
+// Host build mimics Nano S (TARGET_NANOS is set by host/Makefile)
+
+#endif
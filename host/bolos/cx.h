@@ -0,0 +1,135 @@
+#ifndef H_HOST_BOLOS_CX
+#define H_HOST_BOLOS_CX
+
+// Stand-in for the BOLOS cryptography API (cx_*) used by the host build.
+// Implemented in host/crypto/cx.c
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CX_APILEVEL 10
+
+// cx_hash mode
+#define CX_LAST (1 << 0)
+
+typedef enum {
+	CX_NONE = 0,
+	CX_SHA256 = 3,
+	CX_SHA512 = 5,
+	CX_SHA3 = 7,
+	CX_BLAKE2B = 9,
+} cx_md_t;
+
+typedef enum {
+	CX_CURVE_NONE = 0,
+	CX_CURVE_Ed25519 = 0x41,
+} cx_curve_t;
+
+// Common prefix of all hash contexts
+typedef struct {
+	cx_md_t algo;
+	unsigned int counter;
+} cx_hash_t;
+
+typedef struct {
+	cx_hash_t header;
+	size_t outputSize;
+	uint64_t h[8];
+	uint64_t t[2];
+	uint8_t buffer[128];
+	size_t bufferSize;
+} cx_blake2b_t;
+
+typedef struct {
+	cx_hash_t header;
+	size_t outputSize;
+	size_t rate;
+	uint64_t state[25];
+	uint8_t buffer[200];
+	size_t bufferSize;
+} cx_sha3_t;
+
+typedef struct {
+	cx_hash_t header;
+	uint64_t h[8];
+	uint64_t length;
+	uint8_t buffer[128];
+	size_t bufferSize;
+} cx_sha512_t;
+
+typedef struct {
+	cx_hash_t header;
+	uint32_t h[8];
+	uint64_t length;
+	uint8_t buffer[64];
+	size_t bufferSize;
+} cx_sha256_t;
+
+int cx_blake2b_init(cx_blake2b_t* hash, unsigned int outputBits);
+int cx_blake2b_init2(
+        cx_blake2b_t* hash, unsigned int outputBits,
+        unsigned char* salt, unsigned int saltSize,
+        unsigned char* personalization, unsigned int personalizationSize
+);
+int cx_sha3_init(cx_sha3_t* hash, unsigned int outputBits);
+int cx_sha512_init(cx_sha512_t* hash);
+int cx_sha256_init(cx_sha256_t* hash);
+
+int cx_hash(
+        cx_hash_t* hash, int mode,
+        const unsigned char* in, unsigned int inSize,
+        unsigned char* out, unsigned int outSize
+);
+
+int cx_hmac_sha256(
+        const unsigned char* key, unsigned int keySize,
+        const unsigned char* in, unsigned int inSize,
+        unsigned char* mac, unsigned int macSize
+);
+
+// Keys
+
+struct cx_ecfp_256_private_key_s {
+	cx_curve_t curve;
+	unsigned int d_len;
+	unsigned char d[32];
+};
+typedef struct cx_ecfp_256_private_key_s cx_ecfp_256_private_key_t;
+
+// Cardano (BIP32-Ed25519) extended key kL || kR
+typedef struct {
+	cx_curve_t curve;
+	unsigned int d_len;
+	unsigned char d[64];
+} cx_ecfp_256_extended_private_key_t;
+
+// W = 0x04 || x (big endian) || y (big endian)
+typedef struct {
+	cx_curve_t curve;
+	unsigned int W_len;
+	unsigned char W[65];
+} cx_ecfp_public_key_t;
+
+// Note: private key with d_len == 64 is an extended key (used as is),
+// d_len == 32 is a seed expanded by SHA-512 as in RFC 8032
+void cx_eddsa_get_public_key(
+        const struct cx_ecfp_256_private_key_s* privateKey,
+        cx_md_t hashId,
+        cx_ecfp_public_key_t* publicKey,
+        unsigned char* a, unsigned int aSize,
+        unsigned char* h, unsigned int hSize
+);
+
+int cx_eddsa_sign(
+        const struct cx_ecfp_256_private_key_s* privateKey,
+        int mode, cx_md_t hashId,
+        const unsigned char* in, unsigned int inSize,
+        const unsigned char* ctx, unsigned int ctxSize,
+        unsigned char* signature, unsigned int signatureSize,
+        unsigned int* info
+);
+
+// Deterministic on the host, see host_rng_seed
+unsigned char* cx_rng(unsigned char* buffer, unsigned int size);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef H_HOST_BOLOS_HOST
+#define H_HOST_BOLOS_HOST
+
+// Host-only controls of the BOLOS stand-in (not available on the device)
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// PRINTF (and thus TRACE) output is dropped unless enabled
+void host_setVerbose(bool isVerbose);
+
+// cx_rng is a deterministic generator on the host (one per thread)
+void host_rng_seed(uint64_t seed);
+
+// Keys are derived (os_perso_derive_node_bip32) from this BIP39 mnemonic,
+// "abandon abandon ... about" (the one used by the unit tests) by default.
+// Set per thread, i.e. per app instance (see host_startApp)
+void host_setMnemonic(const char* mnemonic);
+
+// NVRAM variables of the app are const (they live in flash on the device).
+// Makes the given variable writable (for nvm_write) and wipes it
+void host_nvm_init(const void* start, size_t size);
+
+#endif
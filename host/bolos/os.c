@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "os.h"
+#include "os_io_seproxyhal.h"
+#include "host.h"
+
+// The formatting below forwards standard conversions to libc
+#undef snprintf
+
+// Exceptions
+
+static __thread try_context_t* currentTryContext;
+
+try_context_t* try_context_get(void)
+{
+	return currentTryContext;
+}
+
+try_context_t* try_context_set(try_context_t* context)
+{
+	try_context_t* previous = currentTryContext;
+	currentTryContext = context;
+	return previous;
+}
+
+void os_longjmp(unsigned int exception)
+{
+	if (currentTryContext == NULL) {
+		// Device would reset here
+		fprintf(stderr, "Uncaught exception 0x%04x\n", exception);
+		abort();
+	}
+	longjmp(currentTryContext->jmp_buf, exception);
+}
+
+// NVRAM
+
+void nvm_write(void* dst, void* src, unsigned int size)
+{
+	if (src == NULL) {
+		memset(dst, 0, size);
+	} else {
+		memmove(dst, src, size);
+	}
+}
+
+void host_nvm_init(const void* start, size_t size)
+{
+	const uintptr_t pageSize = (uintptr_t) sysconf(_SC_PAGESIZE);
+	const uintptr_t begin = (uintptr_t) start & ~(pageSize - 1);
+	const uintptr_t end = ((uintptr_t) start + size + pageSize - 1) & ~(pageSize - 1);
+
+	if (mprotect((void*) begin, end - begin, PROT_READ | PROT_WRITE) != 0) {
+		perror("host_nvm_init");
+		abort();
+	}
+	memset((void*) start, 0, size);
+}
+
+// Formatting
+
+static bool isVerbose = false;
+
+void host_setVerbose(bool verbose)
+{
+	isVerbose = verbose;
+}
+
+static void appendChar(char* out, size_t outSize, size_t* pos, char c)
+{
+	if (*pos + 1 < outSize) {
+		out[*pos] = c;
+	}
+	(*pos)++;
+}
+
+static void appendStr(char* out, size_t outSize, size_t* pos, const char* str)
+{
+	while (*str) {
+		appendChar(out, outSize, pos, *str++);
+	}
+}
+
+// Handles standard conversions used by the app plus SDK specific
+// "%.*h" and "%.*H" (hex dump of a buffer, lower/upper case)
+static int host_vsnprintf(char* out, size_t outSize, const char* format, va_list args)
+{
+	size_t pos = 0;
+
+	for (const char* f = format; *f; f++) {
+		if (*f != '%') {
+			appendChar(out, outSize, &pos, *f);
+			continue;
+		}
+
+		// Collect the conversion spec to forward it to vsnprintf
+		char spec[32];
+		size_t specSize = 0;
+		spec[specSize++] = *f++;
+
+		int precision = -1;
+		while (*f && strchr("-+ #0", *f) && specSize < 20) spec[specSize++] = *f++;
+		while (*f >= '0' && *f <= '9' && specSize < 20) spec[specSize++] = *f++;
+		if (*f == '.') {
+			f++;
+			if (*f == '*') {
+				precision = va_arg(args, int);
+				f++;
+			} else {
+				precision = 0;
+				while (*f >= '0' && *f <= '9') {
+					precision = precision * 10 + (*f - '0');
+					f++;
+				}
+			}
+		}
+
+		if ((*f == 'h' || *f == 'H') && precision >= 0) {
+			const uint8_t* buffer = va_arg(args, const uint8_t*);
+			const char* digits = (*f == 'h') ? "0123456789abcdef" : "0123456789ABCDEF";
+			for (int i = 0; i < precision; i++) {
+				appendChar(out, outSize, &pos, digits[buffer[i] >> 4]);
+				appendChar(out, outSize, &pos, digits[buffer[i] & 0x0F]);
+			}
+			continue;
+		}
+
+		if (precision >= 0) {
+			specSize += (size_t) snprintf(spec + specSize, sizeof(spec) - specSize, ".%d", precision);
+		}
+		int longs = 0;
+		bool isSizeT = false;
+		while (*f == 'l') {
+			longs++;
+			spec[specSize++] = *f++;
+		}
+		if (*f == 'z') {
+			isSizeT = true;
+			spec[specSize++] = *f++;
+		}
+		spec[specSize++] = *f;
+		spec[specSize] = '\0';
+
+		char tmp[64];
+		switch (*f) {
+		case 'd':
+		case 'i':
+			if (isSizeT) snprintf(tmp, sizeof(tmp), spec, va_arg(args, ssize_t));
+			else if (longs == 0) snprintf(tmp, sizeof(tmp), spec, va_arg(args, int));
+			else if (longs == 1) snprintf(tmp, sizeof(tmp), spec, va_arg(args, long));
+			else snprintf(tmp, sizeof(tmp), spec, va_arg(args, long long));
+			appendStr(out, outSize, &pos, tmp);
+			break;
+		case 'u':
+		case 'x':
+		case 'X':
+			if (isSizeT) snprintf(tmp, sizeof(tmp), spec, va_arg(args, size_t));
+			else if (longs == 0) snprintf(tmp, sizeof(tmp), spec, va_arg(args, unsigned int));
+			else if (longs == 1) snprintf(tmp, sizeof(tmp), spec, va_arg(args, unsigned long));
+			else snprintf(tmp, sizeof(tmp), spec, va_arg(args, unsigned long long));
+			appendStr(out, outSize, &pos, tmp);
+			break;
+		case 'c':
+			appendChar(out, outSize, &pos, (char) va_arg(args, int));
+			break;
+		case 'p':
+			snprintf(tmp, sizeof(tmp), "%p", va_arg(args, void*));
+			appendStr(out, outSize, &pos, tmp);
+			break;
+		case 's': {
+			const char* str = va_arg(args, const char*);
+			if (str == NULL) str = "(null)";
+			size_t size = strlen(str);
+			if (precision >= 0 && (size_t) precision < size) size = (size_t) precision;
+			for (size_t i = 0; i < size; i++) {
+				appendChar(out, outSize, &pos, str[i]);
+			}
+			break;
+		}
+		case '%':
+			appendChar(out, outSize, &pos, '%');
+			break;
+		default:
+			// Unsupported conversion, better to notice than to misinterpret arguments
+			fprintf(stderr, "host_vsnprintf: unsupported format \"%s\"\n", format);
+			abort();
+		}
+	}
+
+	if (outSize > 0) {
+		out[(pos < outSize) ? pos : outSize - 1] = '\0';
+	}
+	return (int) pos;
+}
+
+int host_snprintf(char* out, size_t outSize, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	int result = host_vsnprintf(out, outSize, format, args);
+	va_end(args);
+	return result;
+}
+
+int host_printf(const char* format, ...)
+{
+	if (!isVerbose) return 0;
+
+	char buffer[1024];
+	va_list args;
+	va_start(args, format);
+	int result = host_vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+	fputs(buffer, stdout);
+	return result;
+}
+
+// Misc
+
+void os_sched_exit(unsigned int exitCode)
+{
+	exit((int) exitCode);
+}
+
+unsigned int os_global_pin_is_validated(void)
+{
+	return BOLOS_UX_OK;
+}
+
+__thread unsigned char G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+
+void io_seproxyhal_display_default(bagl_element_t* element)
+{
+	(void) element;
+}
+
+void io_seproxyhal_se_reset(void)
+{
+	fprintf(stderr, "Device reset\n");
+	abort();
+}
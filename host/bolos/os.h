@@ -0,0 +1,132 @@
+#ifndef H_HOST_BOLOS_OS
+#define H_HOST_BOLOS_OS
+
+// Stand-in for the BOLOS os.h used by the host build (see README.md).
+// Provides only what the app uses, with the same semantics as the SDK.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <setjmp.h>
+
+// Exceptions
+
+typedef unsigned short exception_t;
+
+typedef struct try_context_s {
+	jmp_buf jmp_buf;
+	struct try_context_s* previous;
+	exception_t ex;
+} try_context_t;
+
+try_context_t* try_context_get(void);
+try_context_t* try_context_set(try_context_t* context);
+
+void os_longjmp(unsigned int exception) __attribute__((noreturn));
+
+// Note: same structure as SDK macros so that the app code
+// behaves identically (including FINALLY and rethrowing in END_TRY)
+#define BEGIN_TRY_L(L) \
+	{ \
+		try_context_t __try##L;
+
+#define TRY_L(L) \
+		__try##L.ex = setjmp(__try##L.jmp_buf); \
+		if (__try##L.ex == 0) { \
+			__try##L.previous = try_context_set(&__try##L);
+
+#define CATCH_L(L, x) \
+			goto __FINALLY##L; \
+		} \
+		else if (__try##L.ex == x) { \
+			__try##L.ex = 0; \
+			try_context_set(__try##L.previous);
+
+#define CATCH_OTHER_L(L, e) \
+			goto __FINALLY##L; \
+		} \
+		else { \
+			exception_t e; \
+			e = __try##L.ex; \
+			__try##L.ex = 0; \
+			try_context_set(__try##L.previous);
+
+#define CATCH_ALL_L(L) \
+			goto __FINALLY##L; \
+		} \
+		else { \
+			__try##L.ex = 0; \
+			try_context_set(__try##L.previous);
+
+#define FINALLY_L(L) \
+			goto __FINALLY##L; \
+		} \
+		__FINALLY##L: \
+		try_context_set(__try##L.previous);
+
+#define END_TRY_L(L) \
+		if (__try##L.ex != 0) { \
+			THROW_L(L, __try##L.ex); \
+		} \
+	}
+
+#define THROW_L(L, x) os_longjmp(x)
+
+#define BEGIN_TRY      BEGIN_TRY_L(EX)
+#define TRY            TRY_L(EX)
+#define CATCH(x)       CATCH_L(EX, x)
+#define CATCH_OTHER(e) CATCH_OTHER_L(EX, e)
+#define CATCH_ALL      CATCH_ALL_L(EX)
+#define FINALLY        FINALLY_L(EX)
+#define END_TRY        END_TRY_L(EX)
+#define THROW(x)       THROW_L(EX, x)
+
+enum {
+	EXCEPTION = 1,
+	INVALID_PARAMETER = 2,
+	EXCEPTION_IO_RESET = 0x10,
+};
+
+// Memory
+
+// Note: there is no relocation on the host
+#define PIC(x) ((void*) (x))
+
+#define os_memmove memmove
+#define os_memcpy  memcpy
+#define os_memset  memset
+#define os_memcmp  memcmp
+
+// NVRAM is plain memory on the host
+void nvm_write(void* dst, void* src, unsigned int size);
+
+// Formatting
+
+// SDK formatting supports "%.*h" / "%.*H" (hex dump of a buffer)
+// which the standard library does not have
+int host_snprintf(char* out, size_t outSize, const char* format, ...);
+int host_printf(const char* format, ...);
+
+#define snprintf host_snprintf
+#define PRINTF   host_printf
+
+// Misc
+
+void os_sched_exit(unsigned int exitCode);
+
+enum {
+	BOLOS_UX_OK = 0xAA,
+};
+unsigned int os_global_pin_is_validated(void);
+
+#include "cx.h"
+
+void os_perso_derive_node_bip32(
+        cx_curve_t curve,
+        const uint32_t* path, unsigned int pathLength,
+        unsigned char* privateKey,
+        unsigned char* chain
+);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef H_HOST_BOLOS_OS_IO_SEPROXYHAL
+#define H_HOST_BOLOS_OS_IO_SEPROXYHAL
+
+// Stand-in for the BOLOS I/O layer used by the host build
+
+#include "os.h"
+
+#define IO_APDU_BUFFER_SIZE (5 + 255)
+// Per thread, see platform.c
+extern __thread unsigned char G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+
+#define CHANNEL_APDU       0
+#define CHANNEL_KEYBOARD   1
+#define CHANNEL_SPI        2
+#define IO_RESET_AFTER_REPLIED 0x80
+#define IO_RECEIVE_DATA    0x40
+#define IO_RETURN_AFTER_TX 0x20
+#define IO_ASYNCH_REPLY    0x10
+#define IO_FLAGS           0xF8
+
+unsigned short io_exchange(unsigned char channelAndFlags, unsigned short txSize);
+
+// There is no display on the host
+typedef struct {
+	int unused;
+} bagl_element_t;
+
+void io_seproxyhal_display_default(bagl_element_t* element);
+void io_seproxyhal_se_reset(void) __attribute__((noreturn));
+
+#endif
@@ -0,0 +1,131 @@
+// BIP32-Ed25519 key derivation as done by os_perso_derive_node_bip32
+// for CX_CURVE_Ed25519 (i.e. as a Ledger device initialized with the
+// given mnemonic derives keys)
+//
+// Master key: "ed25519 seed" HMAC of the BIP39 seed, repeated until
+// the third highest bit is clear. Children: Khovratovich & Law V2.
+
+#include <string.h>
+#include <os.h>
+#include "crypto.h"
+#include "host.h"
+
+static const char* TEST_MNEMONIC =
+        "abandon abandon abandon abandon abandon abandon "
+        "abandon abandon abandon abandon abandon about";
+
+static const uint8_t SEED_KEY[] = "ed25519 seed";
+
+// Per thread, i.e. per simulated device
+static __thread struct {
+	char mnemonic[256];
+	bool isSeedValid;
+	uint8_t seed[64];
+} bip39 = {
+	.isSeedValid = false,
+};
+
+void host_setMnemonic(const char* mnemonic)
+{
+	if (strlen(mnemonic) >= sizeof(bip39.mnemonic)) THROW(INVALID_PARAMETER);
+	strcpy(bip39.mnemonic, mnemonic);
+	bip39.isSeedValid = false;
+}
+
+// BIP39 seed without passphrase, computed lazily as PBKDF2 is slow
+static const uint8_t* getSeed()
+{
+	if (!bip39.isSeedValid) {
+		if (bip39.mnemonic[0] == '\0') host_setMnemonic(TEST_MNEMONIC);
+
+		const uint8_t salt[] = "mnemonic";
+		crypto_pbkdf2HmacSha512(
+		        (const uint8_t*) bip39.mnemonic, strlen(bip39.mnemonic),
+		        salt, sizeof(salt) - 1,
+		        2048,
+		        bip39.seed
+		);
+		bip39.isSeedValid = true;
+	}
+	return bip39.seed;
+}
+
+static void deriveMaster(uint8_t key[64], uint8_t chainCode[32])
+{
+	const uint8_t* seed = getSeed();
+
+	uint8_t buffer[1 + 64];
+	buffer[0] = 0x01;
+	memcpy(buffer + 1, seed, 64);
+	crypto_hmacSha256(SEED_KEY, sizeof(SEED_KEY) - 1, buffer, sizeof(buffer), chainCode);
+
+	crypto_hmacSha512(SEED_KEY, sizeof(SEED_KEY) - 1, seed, 64, key);
+	while (key[31] & 0x20) {
+		crypto_hmacSha512(SEED_KEY, sizeof(SEED_KEY) - 1, key, 64, key);
+	}
+	key[0] &= 0xF8;
+	key[31] = (key[31] & 0x7F) | 0x40;
+}
+
+static void deriveChild(uint8_t key[64], uint8_t chainCode[32], uint32_t index)
+{
+	// tag || (kL || kR for hardened, A for normal derivation) || index (little endian)
+	uint8_t buffer[1 + 64 + 4];
+	size_t size;
+
+	if (index & 0x80000000) {
+		memcpy(buffer + 1, key, 64);
+		size = 1 + 64;
+	} else {
+		uint8_t x[32], y[32];
+		ed25519_scalarmultBase(key, x, y);
+		ed25519_encodePoint(x, y, buffer + 1);
+		size = 1 + 32;
+	}
+	for (int i = 0; i < 4; i++) buffer[size++] = (uint8_t) (index >> (8 * i));
+
+	const bool isHardened = (index & 0x80000000) != 0;
+	uint8_t z[64], c[64];
+	buffer[0] = isHardened ? 0x00 : 0x02;
+	crypto_hmacSha512(chainCode, 32, buffer, size, z);
+	buffer[0] = isHardened ? 0x01 : 0x03;
+	crypto_hmacSha512(chainCode, 32, buffer, size, c);
+
+	// kL' = kL + 8 * zL[0:28], kR' = kR + zR (both mod 2^256)
+	unsigned carry = 0;
+	for (int i = 0; i < 32; i++) {
+		unsigned zl = (i < 28) ? z[i] : 0;
+		// 8 * zL as a byte stream: shift left by 3 bits
+		unsigned shifted = ((zl << 3) | ((i > 0 && i <= 28) ? (z[i - 1] >> 5) : 0)) & 0xFF;
+		carry += key[i] + shifted;
+		key[i] = (uint8_t) carry;
+		carry >>= 8;
+	}
+	carry = 0;
+	for (int i = 0; i < 32; i++) {
+		carry += key[32 + i] + z[32 + i];
+		key[32 + i] = (uint8_t) carry;
+		carry >>= 8;
+	}
+
+	memcpy(chainCode, c + 32, 32);
+}
+
+void os_perso_derive_node_bip32(
+        cx_curve_t curve,
+        const uint32_t* path, unsigned int pathLength,
+        unsigned char* privateKey,
+        unsigned char* chain
+)
+{
+	if (curve != CX_CURVE_Ed25519) THROW(INVALID_PARAMETER);
+
+	uint8_t key[64], chainCode[32];
+	deriveMaster(key, chainCode);
+	for (unsigned int i = 0; i < pathLength; i++) {
+		deriveChild(key, chainCode, path[i]);
+	}
+
+	memcpy(privateKey, key, sizeof(key));
+	if (chain != NULL) memcpy(chain, chainCode, sizeof(chainCode));
+}
@@ -0,0 +1,145 @@
+// BLAKE2b as specified in RFC 7693
+
+#include <string.h>
+#include "crypto.h"
+
+static const uint64_t BLAKE2B_IV[8] = {
+	0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
+	0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+	0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+	0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+};
+
+static const uint8_t BLAKE2B_SIGMA[12][16] = {
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+	{ 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+	{ 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+	{ 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+	{ 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+	{ 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+	{ 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+	{ 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+	{ 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+};
+
+static inline uint64_t rotr64(uint64_t x, unsigned n)
+{
+	return (x >> n) | (x << (64 - n));
+}
+
+static inline uint64_t load64le(const uint8_t* p)
+{
+	uint64_t x = 0;
+	for (int i = 7; i >= 0; i--) x = (x << 8) | p[i];
+	return x;
+}
+
+static void blake2b_compress(cx_blake2b_t* hash, const uint8_t block[128], bool isLast)
+{
+	uint64_t v[16], m[16];
+
+	for (int i = 0; i < 8; i++) {
+		v[i] = hash->h[i];
+		v[i + 8] = BLAKE2B_IV[i];
+	}
+	v[12] ^= hash->t[0];
+	v[13] ^= hash->t[1];
+	if (isLast) v[14] = ~v[14];
+
+	for (int i = 0; i < 16; i++) m[i] = load64le(block + 8 * i);
+
+#define G(a, b, c, d, x, y) \
+	do { \
+		v[a] = v[a] + v[b] + x; v[d] = rotr64(v[d] ^ v[a], 32); \
+		v[c] = v[c] + v[d];     v[b] = rotr64(v[b] ^ v[c], 24); \
+		v[a] = v[a] + v[b] + y; v[d] = rotr64(v[d] ^ v[a], 16); \
+		v[c] = v[c] + v[d];     v[b] = rotr64(v[b] ^ v[c], 63); \
+	} while (0)
+
+	for (int r = 0; r < 12; r++) {
+		const uint8_t* s = BLAKE2B_SIGMA[r];
+		G(0, 4,  8, 12, m[s[ 0]], m[s[ 1]]);
+		G(1, 5,  9, 13, m[s[ 2]], m[s[ 3]]);
+		G(2, 6, 10, 14, m[s[ 4]], m[s[ 5]]);
+		G(3, 7, 11, 15, m[s[ 6]], m[s[ 7]]);
+		G(0, 5, 10, 15, m[s[ 8]], m[s[ 9]]);
+		G(1, 6, 11, 12, m[s[10]], m[s[11]]);
+		G(2, 7,  8, 13, m[s[12]], m[s[13]]);
+		G(3, 4,  9, 14, m[s[14]], m[s[15]]);
+	}
+#undef G
+
+	for (int i = 0; i < 8; i++) hash->h[i] ^= v[i] ^ v[i + 8];
+}
+
+int cx_blake2b_init2(
+        cx_blake2b_t* hash, unsigned int outputBits,
+        unsigned char* salt, unsigned int saltSize,
+        unsigned char* personalization, unsigned int personalizationSize
+)
+{
+	memset(hash, 0, sizeof(*hash));
+	if (outputBits == 0 || outputBits > 512 || outputBits % 8 != 0) return 0;
+	if (saltSize > 16 || personalizationSize > 16) return 0;
+
+	hash->header.algo = CX_BLAKE2B;
+	hash->outputSize = outputBits / 8;
+
+	// Parameter block: digest length, no key, fanout 1, depth 1,
+	// salt at offset 32, personalization at offset 48
+	uint8_t params[64];
+	memset(params, 0, sizeof(params));
+	params[0] = (uint8_t) hash->outputSize;
+	params[2] = 1;
+	params[3] = 1;
+	if (salt != NULL) memcpy(params + 32, salt, saltSize);
+	if (personalization != NULL) memcpy(params + 48, personalization, personalizationSize);
+
+	for (int i = 0; i < 8; i++) {
+		hash->h[i] = BLAKE2B_IV[i] ^ load64le(params + 8 * i);
+	}
+	return (int) outputBits;
+}
+
+int cx_blake2b_init(cx_blake2b_t* hash, unsigned int outputBits)
+{
+	return cx_blake2b_init2(hash, outputBits, NULL, 0, NULL, 0);
+}
+
+static void blake2b_incrementCounter(cx_blake2b_t* hash, uint64_t by)
+{
+	hash->t[0] += by;
+	if (hash->t[0] < by) hash->t[1]++;
+}
+
+void blake2b_update(cx_blake2b_t* hash, const uint8_t* in, size_t inSize)
+{
+	while (inSize > 0) {
+		// Note: the last block has to be kept for finalization
+		if (hash->bufferSize == sizeof(hash->buffer)) {
+			blake2b_incrementCounter(hash, sizeof(hash->buffer));
+			blake2b_compress(hash, hash->buffer, false);
+			hash->bufferSize = 0;
+		}
+		size_t size = sizeof(hash->buffer) - hash->bufferSize;
+		if (size > inSize) size = inSize;
+		memcpy(hash->buffer + hash->bufferSize, in, size);
+		hash->bufferSize += size;
+		in += size;
+		inSize -= size;
+	}
+}
+
+void blake2b_final(cx_blake2b_t* hash, uint8_t* out)
+{
+	blake2b_incrementCounter(hash, hash->bufferSize);
+	memset(hash->buffer + hash->bufferSize, 0, sizeof(hash->buffer) - hash->bufferSize);
+	blake2b_compress(hash, hash->buffer, true);
+
+	for (size_t i = 0; i < hash->outputSize; i++) {
+		out[i] = (uint8_t) (hash->h[i / 8] >> (8 * (i % 8)));
+	}
+}
@@ -0,0 +1,54 @@
+#ifndef H_HOST_CRYPTO
+#define H_HOST_CRYPTO
+
+// Internal interface of the host reference implementations of cx_* API
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <cx.h>
+
+void blake2b_update(cx_blake2b_t* hash, const uint8_t* in, size_t inSize);
+void blake2b_final(cx_blake2b_t* hash, uint8_t* out);
+
+void sha256_update(cx_sha256_t* hash, const uint8_t* in, size_t inSize);
+void sha256_final(cx_sha256_t* hash, uint8_t out[32]);
+
+void sha512_update(cx_sha512_t* hash, const uint8_t* in, size_t inSize);
+void sha512_final(cx_sha512_t* hash, uint8_t out[64]);
+void sha512(const uint8_t* in, size_t inSize, uint8_t out[64]);
+
+void sha3_update(cx_sha3_t* hash, const uint8_t* in, size_t inSize);
+void sha3_final(cx_sha3_t* hash, uint8_t* out);
+
+void crypto_hmacSha256(
+        const uint8_t* key, size_t keySize,
+        const uint8_t* in, size_t inSize,
+        uint8_t out[32]
+);
+void crypto_hmacSha512(
+        const uint8_t* key, size_t keySize,
+        const uint8_t* in, size_t inSize,
+        uint8_t out[64]
+);
+void crypto_pbkdf2HmacSha512(
+        const uint8_t* password, size_t passwordSize,
+        const uint8_t* salt, size_t saltSize,
+        unsigned iterations,
+        uint8_t out[64]
+);
+
+// Points are affine little endian coordinates, scalars little endian
+void ed25519_scalarmultBase(const uint8_t scalar[32], uint8_t x[32], uint8_t y[32]);
+void ed25519_encodePoint(const uint8_t x[32], const uint8_t y[32], uint8_t out[32]);
+void ed25519_scReduce(const uint8_t in[64], uint8_t out[32]);
+void ed25519_scMulAdd(const uint8_t a[32], const uint8_t b[32], const uint8_t c[32], uint8_t out[32]);
+void ed25519_signExpanded(
+        const uint8_t kL[32], const uint8_t kR[32], const uint8_t publicKey[32],
+        const uint8_t* msg, size_t msgSize,
+        uint8_t signature[64]
+);
+
+void run_crypto_test();
+
+#endif
@@ -0,0 +1,200 @@
+// Known-answer tests of the host cx_* implementation
+
+#include <string.h>
+#include <os.h>
+#include "crypto.h"
+#include "host.h"
+#include "test_utils.h"
+#include "hex_utils.h"
+#include "utils.h"
+
+static const char* ABC = "abc";
+
+static void expectHex(const uint8_t* buffer, size_t size, const char* expectedHex)
+{
+	uint8_t expected[64];
+	size_t expectedSize = parseHexString(expectedHex, expected, SIZEOF(expected));
+	EXPECT_EQ(expectedSize, size);
+	EXPECT_EQ_BYTES(buffer, expected, size);
+}
+
+static void testcase_hash(cx_hash_t* hash, const char* input, const char* expectedHex)
+{
+	PRINTF("testcase_hash %d \"%s\"\n", hash->algo, input);
+	uint8_t out[64];
+	// Split the input to check streaming
+	size_t half = strlen(input) / 2;
+	cx_hash(hash, 0, (const uint8_t*) input, half, NULL, 0);
+	int size = cx_hash(hash, CX_LAST, (const uint8_t*) input + half, strlen(input) - half, out, SIZEOF(out));
+	expectHex(out, (size_t) size, expectedHex);
+}
+
+// FIPS 180-4 / FIPS 202 / RFC 7693 examples
+static void test_hashes()
+{
+	cx_sha256_t sha256;
+	cx_sha256_init(&sha256);
+	testcase_hash(
+	        &sha256.header, ABC,
+	        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"
+	);
+
+	cx_sha256_init(&sha256);
+	testcase_hash(
+	        &sha256.header, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+	        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"
+	);
+
+	cx_sha512_t sha512;
+	cx_sha512_init(&sha512);
+	testcase_hash(
+	        &sha512.header, ABC,
+	        "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+	        "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"
+	);
+
+	cx_sha3_t sha3;
+	cx_sha3_init(&sha3, 256);
+	testcase_hash(
+	        &sha3.header, ABC,
+	        "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532"
+	);
+
+	cx_sha3_init(&sha3, 256);
+	testcase_hash(
+	        &sha3.header, "",
+	        "a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a"
+	);
+
+	cx_blake2b_t blake2b;
+	cx_blake2b_init(&blake2b, 512);
+	testcase_hash(
+	        &blake2b.header, ABC,
+	        "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+	        "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923"
+	);
+}
+
+// RFC 4231 test case 2 and the BIP39 seed of the test mnemonic
+static void test_hmac()
+{
+	PRINTF("test_hmac\n");
+	const char* key = "Jefe";
+	const char* data = "what do ya want for nothing?";
+	uint8_t out[64];
+
+	int size = cx_hmac_sha256((const uint8_t*) key, strlen(key), (const uint8_t*) data, strlen(data), out, 32);
+	expectHex(out, (size_t) size, "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+	crypto_hmacSha512((const uint8_t*) key, strlen(key), (const uint8_t*) data, strlen(data), out);
+	expectHex(
+	        out, 64,
+	        "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+	        "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737"
+	);
+
+	const char* mnemonic =
+	        "abandon abandon abandon abandon abandon abandon "
+	        "abandon abandon abandon abandon abandon about";
+	const char* salt = "mnemonic";
+	crypto_pbkdf2HmacSha512(
+	        (const uint8_t*) mnemonic, strlen(mnemonic),
+	        (const uint8_t*) salt, strlen(salt),
+	        2048, out
+	);
+	expectHex(
+	        out, 64,
+	        "5eb00bbddcf069084889a8ab9155568165f5c453ccb85e70811aaed6f6da5fc1"
+	        "9a5ac40b389cd370d086206dec8aa6c43daea6690f20ad3d8d48b2d2ce9e38e4"
+	);
+}
+
+static void testcase_eddsa(const char* secretHex, const char* publicKeyHex, const char* messageHex, const char* signatureHex)
+{
+	PRINTF("testcase_eddsa %s\n", publicKeyHex);
+	cx_ecfp_256_extended_private_key_t privateKey;
+	privateKey.curve = CX_CURVE_Ed25519;
+	privateKey.d_len = parseHexString(secretHex, privateKey.d, SIZEOF(privateKey.d));
+
+	cx_ecfp_public_key_t publicKey;
+	cx_eddsa_get_public_key((const struct cx_ecfp_256_private_key_s*) &privateKey, CX_SHA512, &publicKey, NULL, 0, NULL, 0);
+
+	// Same conversion as extractRawPublicKey
+	uint8_t rawPublicKey[32];
+	for (int i = 0; i < 32; i++) rawPublicKey[i] = publicKey.W[64 - i];
+	if (publicKey.W[32] & 1) rawPublicKey[31] |= 0x80;
+	expectHex(rawPublicKey, SIZEOF(rawPublicKey), publicKeyHex);
+
+	uint8_t message[64];
+	size_t messageSize = parseHexString(messageHex, message, SIZEOF(message));
+	uint8_t signature[64];
+	int size = cx_eddsa_sign(
+	                   (const struct cx_ecfp_256_private_key_s*) &privateKey, CX_LAST, CX_SHA512,
+	                   message, messageSize, NULL, 0,
+	                   signature, SIZEOF(signature), NULL
+	           );
+	expectHex(signature, (size_t) size, signatureHex);
+}
+
+static void test_eddsa()
+{
+	// RFC 8032 section 7.1, tests 1 and 2
+	testcase_eddsa(
+	        "9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+	        "d75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a",
+	        "",
+	        "e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e06522490155"
+	        "5fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b"
+	);
+	testcase_eddsa(
+	        "4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+	        "3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c",
+	        "72",
+	        "92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da"
+	        "085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00"
+	);
+	// Cardano extended key of m/44'/1815'/1'/0/5 of the test mnemonic signing
+	// tx f33b1f56240c9f4afc9dd9a9141737b2937b6cd856dd67fda81cc794d2670580
+	testcase_eddsa(
+	        "d0351c6c8443b071161cd591942ed9c3350c451167d6e9a508311b222be69d41"
+	        "f6f79aeddbf4c8bafdf68d72691f7fd71ceae9a8eff6bb646afcfb8d42cc5999",
+	        "81623976bc72792dd97ab087ce3feca43682282b4df8e4d95af4f825629d7cf6",
+	        "f33b1f56240c9f4afc9dd9a9141737b2937b6cd856dd67fda81cc794d2670580",
+	        "4e81d7ec9a367d18876b8a4863036e6035235795097c1efe37c929cbe914c4a8"
+	        "3e2201fdcdd510149d1d886c3ce0d8679d163062d558bfeed1ed9e597250c207"
+	);
+}
+
+// Private keys are covered by run_key_derivation_test, chain codes are not
+static void test_bip32()
+{
+	PRINTF("test_bip32\n");
+	host_setMnemonic(
+	        "abandon abandon abandon abandon abandon abandon "
+	        "abandon abandon abandon abandon abandon about"
+	);
+
+	const uint32_t HD = 0x80000000;
+	uint8_t privateKey[64], chainCode[32];
+
+	const uint32_t hardenedPath[] = {HD + 44, HD + 1815, HD + 1};
+	os_perso_derive_node_bip32(CX_CURVE_Ed25519, hardenedPath, ARRAY_LEN(hardenedPath), privateKey, chainCode);
+	expectHex(chainCode, SIZEOF(chainCode), "0b161cb11babe1f56c3f9f1cbbb7b6d2d13eeb3efa67205198a69b8d81885354");
+
+	const uint32_t path[] = {HD + 44, HD + 1815, HD + 1, 0, 5};
+	os_perso_derive_node_bip32(CX_CURVE_Ed25519, path, ARRAY_LEN(path), privateKey, chainCode);
+	expectHex(
+	        privateKey, SIZEOF(privateKey),
+	        "d0351c6c8443b071161cd591942ed9c3350c451167d6e9a508311b222be69d41"
+	        "f6f79aeddbf4c8bafdf68d72691f7fd71ceae9a8eff6bb646afcfb8d42cc5999"
+	);
+	expectHex(chainCode, SIZEOF(chainCode), "1a2f33deea07cb7c70c666553e95da07ab60a11ac643b0f4edd79eeea0631452");
+}
+
+void run_crypto_test()
+{
+	test_hashes();
+	test_hmac();
+	test_eddsa();
+	test_bip32();
+}
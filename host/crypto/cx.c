@@ -0,0 +1,168 @@
+// Host implementation of the cx_* entry points used by the app
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <os.h>
+#include "crypto.h"
+#include "host.h"
+
+int cx_hash(
+        cx_hash_t* hash, int mode,
+        const unsigned char* in, unsigned int inSize,
+        unsigned char* out, unsigned int outSize
+)
+{
+	switch (hash->algo) {
+	case CX_BLAKE2B: {
+		cx_blake2b_t* blake2b = (cx_blake2b_t*) hash;
+		blake2b_update(blake2b, in, inSize);
+		if (!(mode & CX_LAST)) return 0;
+		if (outSize < blake2b->outputSize) THROW(INVALID_PARAMETER);
+		blake2b_final(blake2b, out);
+		return (int) blake2b->outputSize;
+	}
+	case CX_SHA3: {
+		cx_sha3_t* sha3 = (cx_sha3_t*) hash;
+		sha3_update(sha3, in, inSize);
+		if (!(mode & CX_LAST)) return 0;
+		if (outSize < sha3->outputSize) THROW(INVALID_PARAMETER);
+		sha3_final(sha3, out);
+		return (int) sha3->outputSize;
+	}
+	case CX_SHA512: {
+		cx_sha512_t* sha512 = (cx_sha512_t*) hash;
+		sha512_update(sha512, in, inSize);
+		if (!(mode & CX_LAST)) return 0;
+		if (outSize < 64) THROW(INVALID_PARAMETER);
+		sha512_final(sha512, out);
+		return 64;
+	}
+	case CX_SHA256: {
+		cx_sha256_t* sha256 = (cx_sha256_t*) hash;
+		sha256_update(sha256, in, inSize);
+		if (!(mode & CX_LAST)) return 0;
+		if (outSize < 32) THROW(INVALID_PARAMETER);
+		sha256_final(sha256, out);
+		return 32;
+	}
+	default:
+		THROW(INVALID_PARAMETER);
+	}
+}
+
+int cx_hmac_sha256(
+        const unsigned char* key, unsigned int keySize,
+        const unsigned char* in, unsigned int inSize,
+        unsigned char* mac, unsigned int macSize
+)
+{
+	uint8_t out[32];
+	crypto_hmacSha256(key, keySize, in, inSize, out);
+	if (macSize > sizeof(out)) macSize = sizeof(out);
+	memcpy(mac, out, macSize);
+	return (int) macSize;
+}
+
+
+// EdDSA
+
+// Expanded key (a, prefix): Cardano extended keys (d_len == 64) are
+// already expanded, RFC 8032 seeds (d_len == 32) are hashed and clamped
+static void eddsa_expandKey(const struct cx_ecfp_256_private_key_s* privateKey, uint8_t expanded[64])
+{
+	if (privateKey->curve != CX_CURVE_Ed25519) THROW(INVALID_PARAMETER);
+
+	switch (privateKey->d_len) {
+	case 64:
+		memcpy(expanded, ((const cx_ecfp_256_extended_private_key_t*) privateKey)->d, 64);
+		break;
+	case 32:
+		sha512(privateKey->d, 32, expanded);
+		expanded[0] &= 0xF8;
+		expanded[31] = (expanded[31] & 0x7F) | 0x40;
+		break;
+	default:
+		THROW(INVALID_PARAMETER);
+	}
+}
+
+void cx_eddsa_get_public_key(
+        const struct cx_ecfp_256_private_key_s* privateKey,
+        cx_md_t hashId,
+        cx_ecfp_public_key_t* publicKey,
+        unsigned char* a, unsigned int aSize,
+        unsigned char* h, unsigned int hSize
+)
+{
+	if (hashId != CX_SHA512) THROW(INVALID_PARAMETER);
+
+	uint8_t expanded[64];
+	eddsa_expandKey(privateKey, expanded);
+
+	uint8_t x[32], y[32];
+	ed25519_scalarmultBase(expanded, x, y);
+
+	publicKey->curve = CX_CURVE_Ed25519;
+	publicKey->W_len = 65;
+	publicKey->W[0] = 0x04;
+	for (int i = 0; i < 32; i++) {
+		publicKey->W[1 + i] = x[31 - i];
+		publicKey->W[33 + i] = y[31 - i];
+	}
+
+	if (a != NULL) memcpy(a, expanded, (aSize < 32) ? aSize : 32);
+	if (h != NULL) memcpy(h, expanded + 32, (hSize < 32) ? hSize : 32);
+	memset(expanded, 0, sizeof(expanded));
+}
+
+int cx_eddsa_sign(
+        const struct cx_ecfp_256_private_key_s* privateKey,
+        int mode, cx_md_t hashId,
+        const unsigned char* in, unsigned int inSize,
+        const unsigned char* ctx, unsigned int ctxSize,
+        unsigned char* signature, unsigned int signatureSize,
+        unsigned int* info
+)
+{
+	(void) mode;
+	(void) ctx;
+	(void) ctxSize;
+	if (hashId != CX_SHA512) THROW(INVALID_PARAMETER);
+	if (signatureSize < 64) THROW(INVALID_PARAMETER);
+
+	uint8_t expanded[64];
+	eddsa_expandKey(privateKey, expanded);
+
+	uint8_t x[32], y[32], publicKey[32];
+	ed25519_scalarmultBase(expanded, x, y);
+	ed25519_encodePoint(x, y, publicKey);
+
+	ed25519_signExpanded(expanded, expanded + 32, publicKey, in, inSize, signature);
+	memset(expanded, 0, sizeof(expanded));
+
+	if (info != NULL) *info = 0;
+	return 64;
+}
+
+
+// Deterministic so that host runs are reproducible (splitmix64)
+static __thread uint64_t rngState = 0x0123456789abcdefULL;
+
+void host_rng_seed(uint64_t seed)
+{
+	rngState = seed;
+}
+
+unsigned char* cx_rng(unsigned char* buffer, unsigned int size)
+{
+	for (unsigned int i = 0; i < size; i++) {
+		if (i % 8 == 0) rngState += 0x9e3779b97f4a7c15ULL;
+		uint64_t z = rngState;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		z ^= z >> 31;
+		buffer[i] = (uint8_t) (z >> (8 * (i % 8)));
+	}
+	return buffer;
+}
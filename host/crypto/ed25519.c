@@ -0,0 +1,333 @@
+// Ed25519 (RFC 8032) arithmetic for key generation and signing
+//
+// Straightforward (variable time) reference code, only meant for the host build.
+
+#include <string.h>
+#include "crypto.h"
+
+typedef unsigned __int128 uint128_t;
+
+// Field element mod p = 2^255 - 19, 5 limbs of 51 bits
+typedef uint64_t fe_t[5];
+
+static const uint64_t MASK51 = (1ULL << 51) - 1;
+
+static void fe_carry(fe_t h)
+{
+	for (int i = 0; i < 4; i++) {
+		h[i + 1] += h[i] >> 51;
+		h[i] &= MASK51;
+	}
+	h[0] += 19 * (h[4] >> 51);
+	h[4] &= MASK51;
+}
+
+static void fe_frombytes(fe_t h, const uint8_t s[32])
+{
+	uint64_t w[4];
+	for (int i = 0; i < 4; i++) {
+		w[i] = 0;
+		for (int b = 7; b >= 0; b--) w[i] = (w[i] << 8) | s[8 * i + b];
+	}
+	h[0] = w[0] & MASK51;
+	h[1] = ((w[0] >> 51) | (w[1] << 13)) & MASK51;
+	h[2] = ((w[1] >> 38) | (w[2] << 26)) & MASK51;
+	h[3] = ((w[2] >> 25) | (w[3] << 39)) & MASK51;
+	h[4] = (w[3] >> 12) & MASK51;
+}
+
+static void fe_tobytes(uint8_t s[32], const fe_t f)
+{
+	fe_t h;
+	memcpy(h, f, sizeof(h));
+	fe_carry(h);
+	fe_carry(h);
+	fe_carry(h);
+
+	// Subtract p if h >= p
+	uint64_t q = (h[0] + 19) >> 51;
+	for (int i = 1; i < 5; i++) q = (h[i] + q) >> 51;
+	h[0] += 19 * q;
+	for (int i = 0; i < 4; i++) {
+		h[i + 1] += h[i] >> 51;
+		h[i] &= MASK51;
+	}
+	h[4] &= MASK51;
+
+	uint64_t w[4] = {
+		h[0] | (h[1] << 51),
+		(h[1] >> 13) | (h[2] << 38),
+		(h[2] >> 26) | (h[3] << 25),
+		(h[3] >> 39) | (h[4] << 12),
+	};
+	for (int i = 0; i < 32; i++) s[i] = (uint8_t) (w[i / 8] >> (8 * (i % 8)));
+}
+
+static void fe_add(fe_t h, const fe_t f, const fe_t g)
+{
+	for (int i = 0; i < 5; i++) h[i] = f[i] + g[i];
+	fe_carry(h);
+}
+
+static void fe_sub(fe_t h, const fe_t f, const fe_t g)
+{
+	// Adds 4p so that limbs do not underflow
+	h[0] = f[0] + 0x1FFFFFFFFFFFB4ULL - g[0];
+	for (int i = 1; i < 5; i++) h[i] = f[i] + 0x1FFFFFFFFFFFFCULL - g[i];
+	fe_carry(h);
+}
+
+static void fe_mul(fe_t h, const fe_t f, const fe_t g)
+{
+	uint64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+	uint64_t g0 = g[0], g1 = g[1], g2 = g[2], g3 = g[3], g4 = g[4];
+	uint64_t g1_19 = 19 * g1, g2_19 = 19 * g2, g3_19 = 19 * g3, g4_19 = 19 * g4;
+
+	uint128_t r0 = (uint128_t) f0 * g0 + (uint128_t) f1 * g4_19 + (uint128_t) f2 * g3_19 + (uint128_t) f3 * g2_19 + (uint128_t) f4 * g1_19;
+	uint128_t r1 = (uint128_t) f0 * g1 + (uint128_t) f1 * g0 + (uint128_t) f2 * g4_19 + (uint128_t) f3 * g3_19 + (uint128_t) f4 * g2_19;
+	uint128_t r2 = (uint128_t) f0 * g2 + (uint128_t) f1 * g1 + (uint128_t) f2 * g0 + (uint128_t) f3 * g4_19 + (uint128_t) f4 * g3_19;
+	uint128_t r3 = (uint128_t) f0 * g3 + (uint128_t) f1 * g2 + (uint128_t) f2 * g1 + (uint128_t) f3 * g0 + (uint128_t) f4 * g4_19;
+	uint128_t r4 = (uint128_t) f0 * g4 + (uint128_t) f1 * g3 + (uint128_t) f2 * g2 + (uint128_t) f3 * g1 + (uint128_t) f4 * g0;
+
+	r1 += (uint64_t) (r0 >> 51);
+	h[0] = (uint64_t) r0 & MASK51;
+	r2 += (uint64_t) (r1 >> 51);
+	h[1] = (uint64_t) r1 & MASK51;
+	r3 += (uint64_t) (r2 >> 51);
+	h[2] = (uint64_t) r2 & MASK51;
+	r4 += (uint64_t) (r3 >> 51);
+	h[3] = (uint64_t) r3 & MASK51;
+	h[0] += 19 * (uint64_t) (r4 >> 51);
+	h[4] = (uint64_t) r4 & MASK51;
+	h[1] += h[0] >> 51;
+	h[0] &= MASK51;
+}
+
+// z^(p-2)
+static void fe_invert(fe_t out, const fe_t z)
+{
+	// p - 2 = 2^255 - 21, little endian
+	uint8_t e[32];
+	memset(e, 0xFF, sizeof(e));
+	e[0] = 0xEB;
+	e[31] = 0x7F;
+
+	fe_t r = {1, 0, 0, 0, 0};
+	for (int i = 254; i >= 0; i--) {
+		fe_mul(r, r, r);
+		if ((e[i / 8] >> (i % 8)) & 1) fe_mul(r, r, z);
+	}
+	memcpy(out, r, sizeof(r));
+}
+
+
+// Points in extended twisted Edwards coordinates (X:Y:Z:T), x = X/Z, y = Y/Z, xy = T/Z
+
+typedef struct {
+	fe_t X, Y, Z, T;
+} ge_t;
+
+static const uint8_t BASE_X[32] = {
+	0x1a, 0xd5, 0x25, 0x8f, 0x60, 0x2d, 0x56, 0xc9, 0xb2, 0xa7, 0x25, 0x95, 0x60, 0xc7, 0x2c, 0x69,
+	0x5c, 0xdc, 0xd6, 0xfd, 0x31, 0xe2, 0xa4, 0xc0, 0xfe, 0x53, 0x6e, 0xcd, 0xd3, 0x36, 0x69, 0x21,
+};
+
+static const uint8_t BASE_Y[32] = {
+	0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+	0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+};
+
+// 2 * d where d = -121665/121666
+static const uint8_t D2[32] = {
+	0x59, 0xf1, 0xb2, 0x26, 0x94, 0x9b, 0xd6, 0xeb, 0x56, 0xb1, 0x83, 0x82, 0x9a, 0x14, 0xe0, 0x00,
+	0x30, 0xd1, 0xf3, 0xee, 0xf2, 0x80, 0x8e, 0x19, 0xe7, 0xfc, 0xdf, 0x56, 0xdc, 0xd9, 0x06, 0x24,
+};
+
+// Complete addition formula (add-2008-hwcd-3), also used for doubling
+static void ge_add(ge_t* r, const ge_t* p, const ge_t* q)
+{
+	fe_t a, b, c, d, e, f, g, h, t, d2;
+
+	fe_frombytes(d2, D2);
+
+	fe_sub(a, p->Y, p->X);
+	fe_sub(t, q->Y, q->X);
+	fe_mul(a, a, t);
+	fe_add(b, p->Y, p->X);
+	fe_add(t, q->Y, q->X);
+	fe_mul(b, b, t);
+	fe_mul(c, p->T, q->T);
+	fe_mul(c, c, d2);
+	fe_mul(d, p->Z, q->Z);
+	fe_add(d, d, d);
+
+	fe_sub(e, b, a);
+	fe_sub(f, d, c);
+	fe_add(g, d, c);
+	fe_add(h, b, a);
+
+	fe_mul(r->X, e, f);
+	fe_mul(r->Y, g, h);
+	fe_mul(r->T, e, h);
+	fe_mul(r->Z, f, g);
+}
+
+// Scalar is used as a 256-bit integer without reduction mod L
+// (as Cardano extended keys are not reduced)
+static void ge_scalarmultBase(ge_t* r, const uint8_t scalar[32])
+{
+	ge_t base;
+	fe_frombytes(base.X, BASE_X);
+	fe_frombytes(base.Y, BASE_Y);
+	fe_t one = {1, 0, 0, 0, 0};
+	memcpy(base.Z, one, sizeof(one));
+	fe_mul(base.T, base.X, base.Y);
+
+	ge_t acc = {{0}, {1, 0, 0, 0, 0}, {1, 0, 0, 0, 0}, {0}};
+	for (int i = 255; i >= 0; i--) {
+		ge_add(&acc, &acc, &acc);
+		if ((scalar[i / 8] >> (i % 8)) & 1) ge_add(&acc, &acc, &base);
+	}
+	*r = acc;
+}
+
+static void ge_toAffine(const ge_t* p, uint8_t x[32], uint8_t y[32])
+{
+	fe_t zInv, t;
+	fe_invert(zInv, p->Z);
+	fe_mul(t, p->X, zInv);
+	fe_tobytes(x, t);
+	fe_mul(t, p->Y, zInv);
+	fe_tobytes(y, t);
+}
+
+void ed25519_scalarmultBase(const uint8_t scalar[32], uint8_t x[32], uint8_t y[32])
+{
+	ge_t p;
+	ge_scalarmultBase(&p, scalar);
+	ge_toAffine(&p, x, y);
+}
+
+void ed25519_encodePoint(const uint8_t x[32], const uint8_t y[32], uint8_t out[32])
+{
+	memcpy(out, y, 32);
+	out[31] |= (uint8_t) ((x[0] & 1) << 7);
+}
+
+
+// Scalars mod L = 2^252 + 27742317777372353535851937790883648493, 8 limbs of 32 bits
+
+static const uint32_t L[8] = {
+	0x5cf5d3ed, 0x5812631a, 0xa2f79cd6, 0x14def9de, 0x00000000, 0x00000000, 0x00000000, 0x10000000,
+};
+
+// Reduces a little endian number of given size mod L (bit by bit)
+static void sc_reduceBytes(const uint8_t* in, size_t inSize, uint8_t out[32])
+{
+	uint32_t r[8] = {0};
+
+	for (size_t bit = inSize * 8; bit-- > 0;) {
+		// r = 2r + bit, r < L < 2^253 so this does not overflow
+		for (int i = 7; i > 0; i--) r[i] = (r[i] << 1) | (r[i - 1] >> 31);
+		r[0] = (r[0] << 1) | ((in[bit / 8] >> (bit % 8)) & 1);
+
+		// if r >= L then r -= L
+		bool isGreaterOrEqual = true;
+		for (int i = 7; i >= 0; i--) {
+			if (r[i] != L[i]) {
+				isGreaterOrEqual = r[i] > L[i];
+				break;
+			}
+		}
+		if (isGreaterOrEqual) {
+			uint64_t borrow = 0;
+			for (int i = 0; i < 8; i++) {
+				uint64_t diff = (uint64_t) r[i] - L[i] - borrow;
+				r[i] = (uint32_t) diff;
+				borrow = (diff >> 63) & 1;
+			}
+		}
+	}
+
+	for (int i = 0; i < 32; i++) out[i] = (uint8_t) (r[i / 4] >> (8 * (i % 4)));
+}
+
+void ed25519_scReduce(const uint8_t in[64], uint8_t out[32])
+{
+	sc_reduceBytes(in, 64, out);
+}
+
+// out = (a * b + c) mod L
+void ed25519_scMulAdd(const uint8_t a[32], const uint8_t b[32], const uint8_t c[32], uint8_t out[32])
+{
+	uint64_t product[16] = {0};
+	uint32_t aw[8], bw[8];
+	for (int i = 0; i < 8; i++) {
+		aw[i] = (uint32_t) a[4 * i] | ((uint32_t) a[4 * i + 1] << 8) | ((uint32_t) a[4 * i + 2] << 16) | ((uint32_t) a[4 * i + 3] << 24);
+		bw[i] = (uint32_t) b[4 * i] | ((uint32_t) b[4 * i + 1] << 8) | ((uint32_t) b[4 * i + 2] << 16) | ((uint32_t) b[4 * i + 3] << 24);
+	}
+
+	for (int i = 0; i < 8; i++) {
+		uint64_t carry = 0;
+		for (int j = 0; j < 8; j++) {
+			uint64_t t = (uint64_t) aw[i] * bw[j] + product[i + j] + carry;
+			product[i + j] = t & 0xFFFFFFFF;
+			carry = t >> 32;
+		}
+		product[i + 8] += carry;
+	}
+
+	uint64_t carry = 0;
+	for (int i = 0; i < 16; i++) {
+		uint64_t t = product[i] + carry;
+		if (i < 8) {
+			t += (uint32_t) c[4 * i] | ((uint32_t) c[4 * i + 1] << 8) | ((uint32_t) c[4 * i + 2] << 16) | ((uint32_t) c[4 * i + 3] << 24);
+		}
+		product[i] = t & 0xFFFFFFFF;
+		carry = t >> 32;
+	}
+
+	// a, b < 2^256 and c < 2^256 so the sum fits into 513 bits
+	uint8_t bytes[65];
+	for (int i = 0; i < 64; i++) bytes[i] = (uint8_t) (product[i / 4] >> (8 * (i % 4)));
+	bytes[64] = (uint8_t) carry;
+	sc_reduceBytes(bytes, sizeof(bytes), out);
+}
+
+
+// Signing with an expanded key (a = kL, prefix = kR)
+
+void ed25519_signExpanded(
+        const uint8_t kL[32], const uint8_t kR[32], const uint8_t publicKey[32],
+        const uint8_t* msg, size_t msgSize,
+        uint8_t signature[64]
+)
+{
+	cx_sha512_t hash;
+	uint8_t digest[64];
+
+	// r = H(prefix || M)
+	uint8_t r[32];
+	cx_sha512_init(&hash);
+	sha512_update(&hash, kR, 32);
+	sha512_update(&hash, msg, msgSize);
+	sha512_final(&hash, digest);
+	ed25519_scReduce(digest, r);
+
+	// R = rB
+	uint8_t x[32], y[32];
+	ed25519_scalarmultBase(r, x, y);
+	ed25519_encodePoint(x, y, signature);
+
+	// k = H(R || A || M)
+	uint8_t k[32];
+	cx_sha512_init(&hash);
+	sha512_update(&hash, signature, 32);
+	sha512_update(&hash, publicKey, 32);
+	sha512_update(&hash, msg, msgSize);
+	sha512_final(&hash, digest);
+	ed25519_scReduce(digest, k);
+
+	// S = r + k * a
+	ed25519_scMulAdd(k, kL, r, signature + 32);
+}
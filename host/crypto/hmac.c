@@ -0,0 +1,94 @@
+// HMAC (RFC 2104) over SHA-256 / SHA-512 and PBKDF2 (RFC 8018)
+
+#include <string.h>
+#include <os.h>
+#include "crypto.h"
+
+void crypto_hmacSha256(
+        const uint8_t* key, size_t keySize,
+        const uint8_t* in, size_t inSize,
+        uint8_t out[32]
+)
+{
+	uint8_t block[64] = {0};
+	cx_sha256_t hash;
+
+	if (keySize > sizeof(block)) {
+		cx_sha256_init(&hash);
+		sha256_update(&hash, key, keySize);
+		sha256_final(&hash, block);
+	} else {
+		memcpy(block, key, keySize);
+	}
+
+	uint8_t pad[64];
+	for (size_t i = 0; i < sizeof(pad); i++) pad[i] = block[i] ^ 0x36;
+	cx_sha256_init(&hash);
+	sha256_update(&hash, pad, sizeof(pad));
+	sha256_update(&hash, in, inSize);
+	uint8_t inner[32];
+	sha256_final(&hash, inner);
+
+	for (size_t i = 0; i < sizeof(pad); i++) pad[i] = block[i] ^ 0x5c;
+	cx_sha256_init(&hash);
+	sha256_update(&hash, pad, sizeof(pad));
+	sha256_update(&hash, inner, sizeof(inner));
+	sha256_final(&hash, out);
+}
+
+void crypto_hmacSha512(
+        const uint8_t* key, size_t keySize,
+        const uint8_t* in, size_t inSize,
+        uint8_t out[64]
+)
+{
+	uint8_t block[128] = {0};
+	cx_sha512_t hash;
+
+	if (keySize > sizeof(block)) {
+		sha512(key, keySize, block);
+	} else {
+		memcpy(block, key, keySize);
+	}
+
+	uint8_t pad[128];
+	for (size_t i = 0; i < sizeof(pad); i++) pad[i] = block[i] ^ 0x36;
+	cx_sha512_init(&hash);
+	sha512_update(&hash, pad, sizeof(pad));
+	sha512_update(&hash, in, inSize);
+	uint8_t inner[64];
+	sha512_final(&hash, inner);
+
+	for (size_t i = 0; i < sizeof(pad); i++) pad[i] = block[i] ^ 0x5c;
+	cx_sha512_init(&hash);
+	sha512_update(&hash, pad, sizeof(pad));
+	sha512_update(&hash, inner, sizeof(inner));
+	sha512_final(&hash, out);
+}
+
+// Only the first output block is needed (BIP39 seeds are 64 bytes)
+void crypto_pbkdf2HmacSha512(
+        const uint8_t* password, size_t passwordSize,
+        const uint8_t* salt, size_t saltSize,
+        unsigned iterations,
+        uint8_t out[64]
+)
+{
+	uint8_t u[64];
+	uint8_t saltBlock[256];
+	if (saltSize + 4 > sizeof(saltBlock)) THROW(INVALID_PARAMETER);
+
+	memcpy(saltBlock, salt, saltSize);
+	// Block index 1 (big endian)
+	saltBlock[saltSize + 0] = 0;
+	saltBlock[saltSize + 1] = 0;
+	saltBlock[saltSize + 2] = 0;
+	saltBlock[saltSize + 3] = 1;
+
+	crypto_hmacSha512(password, passwordSize, saltBlock, saltSize + 4, u);
+	memcpy(out, u, sizeof(u));
+	for (unsigned i = 1; i < iterations; i++) {
+		crypto_hmacSha512(password, passwordSize, u, sizeof(u), u);
+		for (size_t j = 0; j < sizeof(u); j++) out[j] ^= u[j];
+	}
+}
@@ -0,0 +1,251 @@
+// SHA-256 and SHA-512 as specified in FIPS 180-4
+
+#include <string.h>
+#include "crypto.h"
+
+static inline uint32_t rotr32(uint32_t x, unsigned n)
+{
+	return (x >> n) | (x << (32 - n));
+}
+
+static inline uint64_t rotr64(uint64_t x, unsigned n)
+{
+	return (x >> n) | (x << (64 - n));
+}
+
+static inline uint32_t load32be(const uint8_t* p)
+{
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+static inline uint64_t load64be(const uint8_t* p)
+{
+	return ((uint64_t) load32be(p) << 32) | load32be(p + 4);
+}
+
+static inline void store64be(uint8_t* p, uint64_t x)
+{
+	for (int i = 7; i >= 0; i--) {
+		p[i] = (uint8_t) x;
+		x >>= 8;
+	}
+}
+
+
+// SHA-256
+
+static const uint32_t SHA256_K[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static void sha256_compress(cx_sha256_t* hash, const uint8_t block[64])
+{
+	uint32_t w[64];
+	for (int i = 0; i < 16; i++) w[i] = load32be(block + 4 * i);
+	for (int i = 16; i < 64; i++) {
+		uint32_t s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		uint32_t s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	uint32_t a = hash->h[0], b = hash->h[1], c = hash->h[2], d = hash->h[3];
+	uint32_t e = hash->h[4], f = hash->h[5], g = hash->h[6], h = hash->h[7];
+
+	for (int i = 0; i < 64; i++) {
+		uint32_t t1 = h + (rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25)) + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+		uint32_t t2 = (rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+
+	hash->h[0] += a;
+	hash->h[1] += b;
+	hash->h[2] += c;
+	hash->h[3] += d;
+	hash->h[4] += e;
+	hash->h[5] += f;
+	hash->h[6] += g;
+	hash->h[7] += h;
+}
+
+int cx_sha256_init(cx_sha256_t* hash)
+{
+	static const uint32_t IV[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+	};
+
+	memset(hash, 0, sizeof(*hash));
+	hash->header.algo = CX_SHA256;
+	memcpy(hash->h, IV, sizeof(IV));
+	return 0;
+}
+
+void sha256_update(cx_sha256_t* hash, const uint8_t* in, size_t inSize)
+{
+	hash->length += inSize;
+	while (inSize > 0) {
+		size_t size = sizeof(hash->buffer) - hash->bufferSize;
+		if (size > inSize) size = inSize;
+		memcpy(hash->buffer + hash->bufferSize, in, size);
+		hash->bufferSize += size;
+		in += size;
+		inSize -= size;
+
+		if (hash->bufferSize == sizeof(hash->buffer)) {
+			sha256_compress(hash, hash->buffer);
+			hash->bufferSize = 0;
+		}
+	}
+}
+
+void sha256_final(cx_sha256_t* hash, uint8_t out[32])
+{
+	uint64_t bitLength = hash->length * 8;
+	const uint8_t pad = 0x80;
+	const uint8_t zero = 0x00;
+
+	sha256_update(hash, &pad, 1);
+	while (hash->bufferSize != 56) sha256_update(hash, &zero, 1);
+
+	uint8_t length[8];
+	store64be(length, bitLength);
+	sha256_update(hash, length, sizeof(length));
+
+	for (int i = 0; i < 8; i++) {
+		out[4 * i + 0] = (uint8_t) (hash->h[i] >> 24);
+		out[4 * i + 1] = (uint8_t) (hash->h[i] >> 16);
+		out[4 * i + 2] = (uint8_t) (hash->h[i] >> 8);
+		out[4 * i + 3] = (uint8_t) (hash->h[i]);
+	}
+}
+
+
+// SHA-512
+
+static const uint64_t SHA512_K[80] = {
+	0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+	0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+	0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+	0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+	0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+	0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+	0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+	0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+	0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+	0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+	0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+	0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+	0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+	0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+	0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+	0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+	0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+	0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+	0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+	0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL,
+};
+
+static void sha512_compress(cx_sha512_t* hash, const uint8_t block[128])
+{
+	uint64_t w[80];
+	for (int i = 0; i < 16; i++) w[i] = load64be(block + 8 * i);
+	for (int i = 16; i < 80; i++) {
+		uint64_t s0 = rotr64(w[i - 15], 1) ^ rotr64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+		uint64_t s1 = rotr64(w[i - 2], 19) ^ rotr64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	uint64_t a = hash->h[0], b = hash->h[1], c = hash->h[2], d = hash->h[3];
+	uint64_t e = hash->h[4], f = hash->h[5], g = hash->h[6], h = hash->h[7];
+
+	for (int i = 0; i < 80; i++) {
+		uint64_t t1 = h + (rotr64(e, 14) ^ rotr64(e, 18) ^ rotr64(e, 41)) + ((e & f) ^ (~e & g)) + SHA512_K[i] + w[i];
+		uint64_t t2 = (rotr64(a, 28) ^ rotr64(a, 34) ^ rotr64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+
+	hash->h[0] += a;
+	hash->h[1] += b;
+	hash->h[2] += c;
+	hash->h[3] += d;
+	hash->h[4] += e;
+	hash->h[5] += f;
+	hash->h[6] += g;
+	hash->h[7] += h;
+}
+
+int cx_sha512_init(cx_sha512_t* hash)
+{
+	static const uint64_t IV[8] = {
+		0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+		0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL,
+	};
+
+	memset(hash, 0, sizeof(*hash));
+	hash->header.algo = CX_SHA512;
+	memcpy(hash->h, IV, sizeof(IV));
+	return 0;
+}
+
+void sha512_update(cx_sha512_t* hash, const uint8_t* in, size_t inSize)
+{
+	hash->length += inSize;
+	while (inSize > 0) {
+		size_t size = sizeof(hash->buffer) - hash->bufferSize;
+		if (size > inSize) size = inSize;
+		memcpy(hash->buffer + hash->bufferSize, in, size);
+		hash->bufferSize += size;
+		in += size;
+		inSize -= size;
+
+		if (hash->bufferSize == sizeof(hash->buffer)) {
+			sha512_compress(hash, hash->buffer);
+			hash->bufferSize = 0;
+		}
+	}
+}
+
+void sha512_final(cx_sha512_t* hash, uint8_t out[64])
+{
+	uint64_t bitLength = hash->length * 8;
+	const uint8_t pad = 0x80;
+	const uint8_t zero = 0x00;
+
+	sha512_update(hash, &pad, 1);
+	while (hash->bufferSize != 112) sha512_update(hash, &zero, 1);
+
+	// 128-bit length, messages are never longer than 2^64 bits here
+	uint8_t length[16] = {0};
+	store64be(length + 8, bitLength);
+	sha512_update(hash, length, sizeof(length));
+
+	for (int i = 0; i < 8; i++) store64be(out + 8 * i, hash->h[i]);
+}
+
+void sha512(const uint8_t* in, size_t inSize, uint8_t out[64])
+{
+	cx_sha512_t hash;
+	cx_sha512_init(&hash);
+	sha512_update(&hash, in, inSize);
+	sha512_final(&hash, out);
+}
@@ -0,0 +1,110 @@
+// SHA3 as specified in FIPS 202
+
+#include <string.h>
+#include <os.h>
+#include "crypto.h"
+
+static const uint64_t KECCAK_RC[24] = {
+	0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+	0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+	0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+	0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+	0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+	0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+
+static const unsigned KECCAK_ROTATIONS[24] = {
+	1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44,
+};
+
+static const unsigned KECCAK_PI[24] = {
+	10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1,
+};
+
+static inline uint64_t rotl64(uint64_t x, unsigned n)
+{
+	return (x << n) | (x >> (64 - n));
+}
+
+static void keccak_f1600(uint64_t s[25])
+{
+	for (int round = 0; round < 24; round++) {
+		// Theta
+		uint64_t c[5];
+		for (int x = 0; x < 5; x++) c[x] = s[x] ^ s[x + 5] ^ s[x + 10] ^ s[x + 15] ^ s[x + 20];
+		for (int x = 0; x < 5; x++) {
+			uint64_t d = c[(x + 4) % 5] ^ rotl64(c[(x + 1) % 5], 1);
+			for (int y = 0; y < 25; y += 5) s[y + x] ^= d;
+		}
+
+		// Rho and pi
+		uint64_t t = s[1];
+		for (int i = 0; i < 24; i++) {
+			unsigned j = KECCAK_PI[i];
+			uint64_t tmp = s[j];
+			s[j] = rotl64(t, KECCAK_ROTATIONS[i]);
+			t = tmp;
+		}
+
+		// Chi
+		for (int y = 0; y < 25; y += 5) {
+			uint64_t row[5];
+			for (int x = 0; x < 5; x++) row[x] = s[y + x];
+			for (int x = 0; x < 5; x++) s[y + x] = row[x] ^ (~row[(x + 1) % 5] & row[(x + 2) % 5]);
+		}
+
+		// Iota
+		s[0] ^= KECCAK_RC[round];
+	}
+}
+
+static void sha3_absorbBlock(cx_sha3_t* hash)
+{
+	for (size_t i = 0; i < hash->rate / 8; i++) {
+		uint64_t lane = 0;
+		for (int b = 7; b >= 0; b--) lane = (lane << 8) | hash->buffer[8 * i + b];
+		hash->state[i] ^= lane;
+	}
+	keccak_f1600(hash->state);
+	hash->bufferSize = 0;
+}
+
+int cx_sha3_init(cx_sha3_t* hash, unsigned int outputBits)
+{
+	if (outputBits != 224 && outputBits != 256 && outputBits != 384 && outputBits != 512) {
+		THROW(INVALID_PARAMETER);
+	}
+
+	memset(hash, 0, sizeof(*hash));
+	hash->header.algo = CX_SHA3;
+	hash->outputSize = outputBits / 8;
+	hash->rate = 200 - 2 * hash->outputSize;
+	return 0;
+}
+
+void sha3_update(cx_sha3_t* hash, const uint8_t* in, size_t inSize)
+{
+	while (inSize > 0) {
+		size_t size = hash->rate - hash->bufferSize;
+		if (size > inSize) size = inSize;
+		memcpy(hash->buffer + hash->bufferSize, in, size);
+		hash->bufferSize += size;
+		in += size;
+		inSize -= size;
+
+		if (hash->bufferSize == hash->rate) sha3_absorbBlock(hash);
+	}
+}
+
+void sha3_final(cx_sha3_t* hash, uint8_t* out)
+{
+	// SHA3 domain separation bits 01 followed by pad10*1
+	memset(hash->buffer + hash->bufferSize, 0, hash->rate - hash->bufferSize);
+	hash->buffer[hash->bufferSize] ^= 0x06;
+	hash->buffer[hash->rate - 1] ^= 0x80;
+	sha3_absorbBlock(hash);
+
+	for (size_t i = 0; i < hash->outputSize; i++) {
+		out[i] = (uint8_t) (hash->state[i / 8] >> (8 * (i % 8)));
+	}
+}
@@ -0,0 +1,236 @@
+#include <time.h>
+
+#include "common.h"
+#include "platform.h"
+#include "host.h"
+#include "storage.h"
+#include "attestKey.h"
+#include "trustedAddress.h"
+#include "state.h"
+#include "profiling.h"
+#include "stackUsage.h"
+#include "flightRecorder.h"
+
+// I/O (see src/io.c)
+// Note: the I/O and display state is per thread, as is the app state
+// (see appContext), so that each thread can run its own app instance
+
+static __thread host_response_t response;
+
+const host_response_t* host_getResponse()
+{
+	return &response;
+}
+
+unsigned short io_exchange(unsigned char channelAndFlags, unsigned short txSize)
+{
+	ASSERT(channelAndFlags == (CHANNEL_APDU | IO_RETURN_AFTER_TX));
+	ASSERT(txSize <= SIZEOF(response.buffer));
+
+	os_memmove(response.buffer, G_io_apdu_buffer, txSize);
+	response.size = txSize;
+	response.count++;
+	return 0;
+}
+
+void CHECK_RESPONSE_SIZE(unsigned int tx)
+{
+	ASSERT(tx < sizeof(G_io_apdu_buffer));
+	ASSERT(tx + 2u < sizeof(G_io_apdu_buffer));
+}
+
+void _io_send_G_io_apdu_buffer(uint16_t code, uint16_t tx)
+{
+	CHECK_RESPONSE_SIZE(tx);
+	flightRecorder_recordStatus(code);
+	G_io_apdu_buffer[tx++] = code >> 8;
+	G_io_apdu_buffer[tx++] = code & 0xFF;
+	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
+
+	appContext->io_state = IO_EXPECT_IO;
+}
+
+void io_send_buf(uint16_t code, uint8_t* buffer, size_t bufferSize)
+{
+	CHECK_RESPONSE_SIZE(bufferSize);
+
+	os_memmove(G_io_apdu_buffer, buffer, bufferSize);
+	_io_send_G_io_apdu_buffer(code, bufferSize);
+}
+
+bool device_is_unlocked()
+{
+	return true;
+}
+
+// Ticker events of the device (see src/io.c), 100 ms of wall time
+
+uint32_t io_getTickerCount()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t) ((uint64_t) ts.tv_sec * 10 + ts.tv_nsec / 100000000);
+}
+
+// Profiling (see src/io.c), CPU time of the calling thread in microseconds
+
+uint32_t profiling_getTicks()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint32_t) ((uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+uint32_t profiling_getTicksPerSecond()
+{
+	return 1000000;
+}
+
+// Display (see src/uiHelpers.c)
+
+static __thread host_screen_t screen;
+
+const host_screen_t* host_getScreen()
+{
+	return &screen;
+}
+
+static void host_setScreen(
+        host_screen_type_t type,
+        const char* headerStr, const char* textStr,
+        ui_callback_fn_t* confirm, ui_callback_fn_t* reject
+)
+{
+	os_memset(&screen, 0, SIZEOF(screen));
+	screen.type = type;
+	snprintf(screen.header, SIZEOF(screen.header), "%s", headerStr);
+	snprintf(screen.text, SIZEOF(screen.text), "%s", textStr);
+	screen.callback.state = CALLBACK_NOT_RUN;
+	screen.callback.confirm = confirm;
+	screen.callback.reject = reject;
+}
+
+void ui_idle(void)
+{
+	// Same as INS_NONE in main.c
+	appContext->currentInstruction = -1;
+	host_setScreen(HOST_SCREEN_IDLE, "", "", NULL, NULL);
+}
+
+void ui_displayBusy()
+{
+	host_setScreen(HOST_SCREEN_BUSY, "", "", NULL, NULL);
+}
+
+void ui_displayPrompt(
+        const char* headerStr,
+        const char* bodyStr,
+        ui_callback_fn_t* confirm,
+        ui_callback_fn_t* reject)
+{
+	// Same limits as on the device
+	ASSERT(strlen(headerStr) < SIZEOF(promptState->header));
+	ASSERT(strlen(bodyStr) < SIZEOF(promptState->text));
+
+	host_setScreen(HOST_SCREEN_PROMPT, headerStr, bodyStr, confirm, reject);
+
+	ASSERT(appContext->io_state == IO_EXPECT_NONE || appContext->io_state == IO_EXPECT_UI);
+	appContext->io_state = IO_EXPECT_UI;
+}
+
+void ui_displayPaginatedText(
+        const char* headerStr,
+        const char* bodyStr,
+        ui_callback_fn_t* callback)
+{
+	ASSERT(strlen(headerStr) < SIZEOF(paginatedTextState->header));
+	ASSERT(strlen(bodyStr) < SIZEOF(paginatedTextState->fullText));
+
+	host_setScreen(HOST_SCREEN_PAGINATED_TEXT, headerStr, bodyStr, callback, NULL);
+
+	ASSERT(appContext->io_state == IO_EXPECT_NONE || appContext->io_state == IO_EXPECT_UI);
+	appContext->io_state = IO_EXPECT_UI;
+}
+
+// Same as on the device (see src/uiHelpers.c)
+void uiCallback_confirm(ui_callback_t* cb)
+{
+	if (!cb->confirm) return;
+
+	switch(cb->state) {
+	case CALLBACK_NOT_RUN:
+		// Note: needs to be done before resolving in case it throws
+		cb->state = CALLBACK_RUN;
+		cb->confirm();
+		break;
+	case CALLBACK_RUN:
+		// Ignore
+		break;
+	default:
+		ASSERT(false);
+	}
+}
+
+void uiCallback_reject(ui_callback_t* cb)
+{
+	if (!cb->reject) return;
+
+	switch(cb->state) {
+	case CALLBACK_NOT_RUN:
+		cb->state = CALLBACK_RUN;
+		cb->reject();
+		break;
+	case CALLBACK_RUN:
+		// Ignore
+		break;
+	default:
+		ASSERT(false);
+	}
+}
+
+void host_pressConfirm()
+{
+	ASSERT(appContext->io_state == IO_EXPECT_UI);
+	uiCallback_confirm(&screen.callback);
+}
+
+void host_pressReject()
+{
+	ASSERT(appContext->io_state == IO_EXPECT_UI);
+	uiCallback_reject(&screen.callback);
+}
+
+void respond_with_user_reject()
+{
+	io_send_buf(ERR_REJECTED_BY_USER, NULL, 0);
+	ui_idle();
+}
+
+void host_platform_reset()
+{
+	os_memset(&response, 0, SIZEOF(response));
+	ui_idle();
+	appContext->io_state = IO_EXPECT_NONE;
+}
+
+// Defined (as const) by storage.c
+extern const storage_t N_storage_real;
+
+void host_platform_init()
+{
+	host_nvm_init(&N_storage_real, sizeof(N_storage_real));
+	storage_initialize();
+
+	host_startApp(appContext);
+}
+
+void host_startApp(app_context_t* context)
+{
+	os_memset(context, 0, SIZEOF(*context));
+	appContext = context;
+	host_platform_reset();
+
+	attestKey_initialize();
+	trustedAddress_initialize();
+	stackUsage_init();
+}
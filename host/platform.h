@@ -0,0 +1,54 @@
+#ifndef H_HOST_PLATFORM
+#define H_HOST_PLATFORM
+
+// Host replacement of the device I/O and display (io.c, uiHelpers*.c)
+
+#include "common.h"
+#include "uiHelpers.h"
+#include "state.h"
+
+typedef enum {
+	HOST_SCREEN_NONE = 0,
+	HOST_SCREEN_IDLE,
+	HOST_SCREEN_BUSY,
+	HOST_SCREEN_PAGINATED_TEXT,
+	HOST_SCREEN_PROMPT,
+} host_screen_type_t;
+
+// What the device would display right now
+typedef struct {
+	host_screen_type_t type;
+	char header[30];
+	char text[200];
+	ui_callback_t callback;
+} host_screen_t;
+
+const host_screen_t* host_getScreen();
+
+// Button presses on the current prompt / paginated text, run the UI
+// callbacks as the device would (and may throw as they would)
+void host_pressConfirm();
+void host_pressReject();
+
+// Last response sent by the app through io_exchange
+typedef struct {
+	uint8_t buffer[IO_APDU_BUFFER_SIZE];
+	size_t size;
+	unsigned int count;
+} host_response_t;
+
+const host_response_t* host_getResponse();
+
+// Same initialization as app startup on the device (see src/main.c)
+// on a wiped NVRAM
+void host_platform_init();
+
+// Starts another app instance in the calling thread (after
+// host_platform_init). All instances share the NVRAM, i.e. they
+// behave as devices restored from the same backup.
+void host_startApp(app_context_t* context);
+
+// Resets the I/O and display state (e.g. before each APDU exchange)
+void host_platform_reset();
+
+#endif
@@ -0,0 +1,1304 @@
+// Replays APDU transcripts through the app dispatch (as cardano_main in
+// src/main.c does) with a scripted button driver and reports round trips,
+// bytes and CPU time per stage (instruction and P1). With --wcet it also
+// checks the estimated device time of the worst APDU of each stage.
+//
+// Transcript format (one item per line, same arrows as ledgerjs logs):
+//   => d7210100080000000100000001   APDU sent to the app
+//   <= 9000                         expected response (optional); a bare
+//                                   status word accepts any response data
+//   ! confirm reject                buttons for the prompts of the next APDU,
+//                                   prompts without a button are confirmed
+//   # comment
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "host.h"
+#include "platform.h"
+#include "handlers.h"
+#include "state.h"
+#include "io.h"
+#include "hash.h"
+#include "endian.h"
+#include "attestKey.h"
+#include "hex_utils.h"
+#include "profiling.h"
+#include "stackUsage.h"
+#include "flightRecorder.h"
+#include "syscalls.h"
+#include "crc32.h"
+#include "bip44.h"
+#include "cardano.h"
+#include "base58.h"
+#include "securityPolicy.h"
+
+static const uint8_t CLA = 0xD7;
+
+enum {
+	MAX_STEPS = 8192,
+	MAX_BUTTONS = 32,
+	MAX_STAGES = 64,
+	// Guards against flows that never respond
+	MAX_SCREENS_PER_APDU = 1000,
+};
+
+typedef struct {
+	uint8_t apdu[5 + 255];
+	size_t apduSize;
+	// expectedSize == 0 means the response is not checked
+	uint8_t expected[IO_APDU_BUFFER_SIZE];
+	size_t expectedSize;
+	// true = confirm, false = reject
+	bool buttons[MAX_BUTTONS];
+	size_t numButtons;
+} step_t;
+
+static step_t steps[MAX_STEPS];
+static size_t numSteps;
+
+typedef struct {
+	uint16_t key; // ins << 8 | p1
+	unsigned numApdus;
+	size_t bytesIn;
+	size_t bytesOut;
+	unsigned numScreens;
+	uint64_t cpuNs;
+	// Most expensive APDU of the stage (see --wcet)
+	size_t maxStepIndex;
+	uint64_t maxAppCpuNs;
+	uint64_t maxDeviceUs;
+	syscall_counter_t maxSyscalls[_SYSCALL_COUNT];
+	// Syscall table of the app was full, estimates are incomplete
+	bool hasDroppedSyscalls;
+} stage_stats_t;
+
+// Per thread, i.e. per app instance (see --threads)
+static __thread stage_stats_t stages[MAX_STAGES];
+static __thread size_t numStages;
+
+static bool isVerbose = false;
+
+// Nano X drops the BLE connection if a command takes longer
+static const unsigned BLE_COMMAND_TIMEOUT_MS = 2000;
+// Default limit of --wcet, leaves half of the timeout to the transport
+// and screen refreshes
+static const unsigned DEFAULT_BUDGET_MS = BLE_COMMAND_TIMEOUT_MS / 2;
+
+// Pessimistic Nano S costs of the syscalls (calibrate with INS 0xF4 on a
+// DEVEL device). Units are bytes hashed / signed / generated, path
+// components for the derivation (see syscalls.h)
+static const struct {
+	uint32_t usPerCall;
+	uint32_t usPerUnit;
+} SYSCALL_COSTS[_SYSCALL_COUNT] = {
+	[SYSCALL_CX_HASH] = {200, 1},
+	[SYSCALL_CX_HMAC_SHA256] = {1000, 1},
+	[SYSCALL_OS_PERSO_DERIVE_NODE_BIP32] = {100000, 20000},
+	[SYSCALL_CX_EDDSA_SIGN] = {150000, 1},
+	[SYSCALL_CX_EDDSA_GET_PUBLIC_KEY] = {100000, 0},
+	[SYSCALL_CX_RNG] = {100, 1},
+};
+
+// Device vs host speed of the app code, i.e. host CPU time outside of the
+// profiled syscall sites (their device cost is in SYSCALL_COSTS)
+static const uint32_t DEVICE_SLOWDOWN = 200;
+
+static const profiling_site_t SYSCALL_SITES[] = {
+	PROFILING_SITE_DERIVE_PRIVATE_KEY,
+	PROFILING_SITE_DERIVE_PUBLIC_KEY,
+	PROFILING_SITE_SIGN,
+	PROFILING_SITE_HASH,
+};
+
+
+// Transcript
+
+static step_t* newStep()
+{
+	if (numSteps >= MAX_STEPS) {
+		fprintf(stderr, "too many APDUs (max %d)\n", MAX_STEPS);
+		exit(EXIT_FAILURE);
+	}
+	step_t* step = &steps[numSteps++];
+	os_memset(step, 0, SIZEOF(*step));
+	return step;
+}
+
+// Returns size of parsed data, hex may contain spaces
+static size_t parseHexLine(const char* line, uint8_t* out, size_t outSize, unsigned lineNumber)
+{
+	char compact[2 * IO_APDU_BUFFER_SIZE + 1];
+	size_t size = 0;
+	for (const char* c = line; *c && *c != '\n' && *c != '\r'; c++) {
+		if (*c == ' ' || *c == '\t') continue;
+		if (size + 1 >= SIZEOF(compact)) {
+			fprintf(stderr, "line %u: too long\n", lineNumber);
+			exit(EXIT_FAILURE);
+		}
+		compact[size++] = *c;
+	}
+	compact[size] = '\0';
+
+	if (size % 2 != 0 || size / 2 > outSize) {
+		fprintf(stderr, "line %u: bad hex data\n", lineNumber);
+		exit(EXIT_FAILURE);
+	}
+	return parseHexString(compact, out, outSize);
+}
+
+static void loadTranscript(const char* path)
+{
+	FILE* f = fopen(path, "r");
+	if (f == NULL) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+
+	char line[1024];
+	unsigned lineNumber = 0;
+	bool pendingButtons[MAX_BUTTONS];
+	size_t numPendingButtons = 0;
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		lineNumber++;
+		if (strncmp(line, "=>", 2) == 0) {
+			step_t* step = newStep();
+			step->apduSize = parseHexLine(line + 2, step->apdu, SIZEOF(step->apdu), lineNumber);
+			os_memmove(step->buttons, pendingButtons, numPendingButtons * sizeof(bool));
+			step->numButtons = numPendingButtons;
+			numPendingButtons = 0;
+		} else if (strncmp(line, "<=", 2) == 0) {
+			if (numSteps == 0) {
+				fprintf(stderr, "%s:%u: response without APDU\n", path, lineNumber);
+				exit(EXIT_FAILURE);
+			}
+			step_t* step = &steps[numSteps - 1];
+			step->expectedSize = parseHexLine(line + 2, step->expected, SIZEOF(step->expected), lineNumber);
+		} else if (line[0] == '!') {
+			for (char* word = strtok(line + 1, " \t\r\n"); word != NULL; word = strtok(NULL, " \t\r\n")) {
+				if (numPendingButtons >= MAX_BUTTONS) {
+					fprintf(stderr, "%s:%u: too many buttons\n", path, lineNumber);
+					exit(EXIT_FAILURE);
+				}
+				if (strcmp(word, "confirm") == 0) {
+					pendingButtons[numPendingButtons++] = true;
+				} else if (strcmp(word, "reject") == 0) {
+					pendingButtons[numPendingButtons++] = false;
+				} else {
+					fprintf(stderr, "%s:%u: unknown button %s\n", path, lineNumber, word);
+					exit(EXIT_FAILURE);
+				}
+			}
+		}
+		// Anything else is a comment
+	}
+	fclose(f);
+}
+
+static void printHex(FILE* out, const uint8_t* buffer, size_t size)
+{
+	for (size_t i = 0; i < size; i++) fprintf(out, "%02x", buffer[i]);
+}
+
+static void dumpTranscript(FILE* out)
+{
+	for (size_t i = 0; i < numSteps; i++) {
+		const step_t* step = &steps[i];
+		if (step->numButtons > 0) {
+			fprintf(out, "!");
+			for (size_t b = 0; b < step->numButtons; b++) {
+				fprintf(out, " %s", step->buttons[b] ? "confirm" : "reject");
+			}
+			fprintf(out, "\n");
+		}
+		fprintf(out, "=> ");
+		printHex(out, step->apdu, step->apduSize);
+		fprintf(out, "\n");
+		if (step->expectedSize > 0) {
+			fprintf(out, "<= ");
+			printHex(out, step->expected, step->expectedSize);
+			fprintf(out, "\n");
+		}
+	}
+}
+
+
+// Generated transcripts
+
+static step_t* addApdu(uint8_t ins, uint8_t p1, uint8_t p2, const uint8_t* data, size_t dataSize)
+{
+	ASSERT(dataSize <= 255);
+	step_t* step = newStep();
+	step->apdu[0] = CLA;
+	step->apdu[1] = ins;
+	step->apdu[2] = p1;
+	step->apdu[3] = p2;
+	step->apdu[4] = (uint8_t) dataSize;
+	os_memmove(step->apdu + 5, data, dataSize);
+	step->apduSize = 5 + dataSize;
+	return step;
+}
+
+static void expectSuccess(step_t* step, const uint8_t* data, size_t dataSize)
+{
+	ASSERT(dataSize + 2 <= SIZEOF(step->expected));
+	os_memmove(step->expected, data, dataSize);
+	u2be_write(step->expected + dataSize, SUCCESS);
+	step->expectedSize = dataSize + 2;
+}
+
+// Bare status word, i.e. any response data
+static void expectAnySuccess(step_t* step)
+{
+	u2be_write(step->expected, SUCCESS);
+	step->expectedSize = 2;
+}
+
+// First output of tx f33b1f56240c9f4afc9dd9a9141737b2937b6cd856dd67fda81cc794d2670580,
+// CBOR [Tag(24)(Bytes), checksum] as sent in SIGN_TX_OUTPUT_TYPE_ADDRESS
+static const char* RAW_ADDRESS_HEX =
+        "82d818584283581c5f5bee73ed41ff6c8490dfdb4732178e0216ccf7badbe1e77d5d7ff8a101"
+        "581e581c1e9a0361bdc37db7ab7ea2a3f187761877f3db11211fc7436131f15e001ab1012944";
+
+enum {
+	OUTPUTS_PER_PARENT = 5,
+	RAW_ADDRESS_SIZE = 76,
+	ATTESTED_INPUT_SIZE = 32 + 4 + 8 + ATTEST_HMAC_SIZE,
+	ATTEST_CHUNK_SIZE = 200,
+};
+
+static const uint64_t PARENT_OUTPUT_AMOUNT = 5000000000; // > 2^32, i.e. 9-byte CBOR
+static const uint64_t OUTPUT_AMOUNT = 1000000;
+
+static size_t appendBytes(uint8_t* buffer, size_t pos, const uint8_t* data, size_t size)
+{
+	os_memmove(buffer + pos, data, size);
+	return pos + size;
+}
+
+// Parent tx with one input and OUTPUTS_PER_PARENT outputs, unique per parentIndex
+static size_t buildParentTx(uint32_t parentIndex, uint8_t* tx, size_t txSize)
+{
+	uint8_t rawAddress[RAW_ADDRESS_SIZE];
+	parseHexString(RAW_ADDRESS_HEX, rawAddress, SIZEOF(rawAddress));
+
+	size_t pos = 0;
+	ASSERT(txSize >= 100 + OUTPUTS_PER_PARENT * (1 + RAW_ADDRESS_SIZE + 9));
+
+	const uint8_t header[] = {0x83, 0x9f, 0x82, 0x00, 0xd8, 0x18, 0x58, 0x24, 0x82, 0x58, 0x20};
+	pos = appendBytes(tx, pos, header, SIZEOF(header));
+	uint8_t inputHash[32] = {0};
+	u4be_write(inputHash, parentIndex);
+	pos = appendBytes(tx, pos, inputHash, SIZEOF(inputHash));
+	const uint8_t endInputs[] = {0x00, 0xff, 0x9f};
+	pos = appendBytes(tx, pos, endInputs, SIZEOF(endInputs));
+
+	for (unsigned i = 0; i < OUTPUTS_PER_PARENT; i++) {
+		tx[pos++] = 0x82;
+		pos = appendBytes(tx, pos, rawAddress, SIZEOF(rawAddress));
+		tx[pos++] = 0x1b;
+		u8be_write(tx + pos, PARENT_OUTPUT_AMOUNT + i);
+		pos += 8;
+	}
+
+	const uint8_t end[] = {0xff, 0xa0};
+	pos = appendBytes(tx, pos, end, SIZEOF(end));
+	return pos;
+}
+
+static size_t writePath(uint8_t* out, uint32_t chain, uint32_t address)
+{
+	const uint32_t path[] = {
+		BIP_44 | HARDENED_BIP32, ADA_COIN_TYPE | HARDENED_BIP32, HARDENED_BIP32, chain, address
+	};
+	out[0] = ARRAY_LEN(path);
+	for (size_t i = 0; i < ARRAY_LEN(path); i++) u4be_write(out + 1 + 4 * i, path[i]);
+	return 1 + 4 * ARRAY_LEN(path);
+}
+
+// Writes the attested UTxO (txHash, outputIndex, amount, HMAC) the app
+// should respond with (see attestUtxo.c)
+static void writeAttestedUtxo(
+        const uint8_t* txHash, uint32_t outputIndex, uint64_t amount,
+        uint8_t* attested
+)
+{
+	os_memmove(attested, txHash, 32);
+	u4be_write(attested + 32, outputIndex);
+	u8be_write(attested + 36, amount);
+	attest_writeHmac(
+	        ATTEST_PURPOSE_BIND_UTXO_AMOUNT,
+	        attested, 32 + 4 + 8,
+	        attested + 44, ATTEST_HMAC_SIZE
+	);
+}
+
+// Sends the tx in chunks of chunkSize to attest its output outputIndex
+static void addAttestUtxo(
+        const uint8_t* tx, size_t txSize, uint32_t outputIndex, uint64_t amount,
+        size_t chunkSize, uint8_t* attested
+)
+{
+	// Hashed in chunks, the tx may exceed BUFFER_SIZE_PARANOIA
+	blake2b_256_context_t hashContext;
+	blake2b_256_init(&hashContext);
+	for (size_t pos = 0; pos < txSize; pos += chunkSize) {
+		blake2b_256_append(&hashContext, tx + pos, (txSize - pos < chunkSize) ? txSize - pos : chunkSize);
+	}
+	uint8_t txHash[32];
+	blake2b_256_finalize(&hashContext, txHash, SIZEOF(txHash));
+	writeAttestedUtxo(txHash, outputIndex, amount, attested);
+
+	uint8_t index[4];
+	u4be_write(index, outputIndex);
+	expectSuccess(addApdu(0x20, 0x01, 0x00, index, SIZEOF(index)), NULL, 0);
+	for (size_t pos = 0; pos < txSize; pos += chunkSize) {
+		size_t size = txSize - pos;
+		if (size > chunkSize) size = chunkSize;
+		step_t* step = addApdu(0x20, 0x02, 0x00, tx + pos, size);
+		if (pos + size == txSize) {
+			expectSuccess(step, attested, ATTESTED_INPUT_SIZE);
+		} else {
+			expectSuccess(step, NULL, 0);
+		}
+	}
+}
+
+// Attests numInputs UTxOs and signs a tx spending them with numOutputs
+// outputs (the last one is a change output if there are at least two).
+// Inputs use numPaths distinct witness paths. Unless the number of unique
+// paths is declared, one witness is requested per input. Declared ones are
+// requested grouped by path as 0, 0, .., 0, 1, .., numPaths - 1, i.e. with
+// repeats of the previous path that are not counted. Interleaved requests
+// 0, 1, .., numPaths - 2, 0 repeat a path which is not the previous one
+// (before the last path is signed), the app has to reject that
+static void generateSignTx(
+        uint32_t numInputs, uint32_t numOutputs,
+        uint32_t numPaths, bool isDeclaredNumWitnesses, bool isInterleaved
+)
+{
+	uint8_t attestedInputs[32][ATTESTED_INPUT_SIZE];
+	if (numInputs < 1 || numInputs > ARRAY_LEN(attestedInputs) || numOutputs < 1) {
+		fprintf(stderr, "bad number of inputs or outputs\n");
+		exit(EXIT_FAILURE);
+	}
+	if (numPaths < 1 || numPaths > numInputs) {
+		fprintf(stderr, "bad number of witness paths\n");
+		exit(EXIT_FAILURE);
+	}
+	if (isInterleaved && (!isDeclaredNumWitnesses || numPaths < 3)) {
+		fprintf(stderr, "interleaved witnesses need declared witnesses and 3+ paths\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (uint32_t i = 0; i < numInputs; i++) {
+		uint8_t tx[1024];
+		size_t txSize = buildParentTx(i / OUTPUTS_PER_PARENT, tx, SIZEOF(tx));
+		uint32_t outputIndex = i % OUTPUTS_PER_PARENT;
+		addAttestUtxo(
+		        tx, txSize, outputIndex, PARENT_OUTPUT_AMOUNT + outputIndex,
+		        ATTEST_CHUNK_SIZE, attestedInputs[i]
+		);
+	}
+
+	uint8_t data[255];
+	u4be_write(data, numInputs);
+	u4be_write(data + 4, numOutputs);
+	u4be_write(data + 8, numPaths);
+	expectSuccess(addApdu(0x21, 0x01, 0x00, data, isDeclaredNumWitnesses ? 12 : 8), NULL, 0);
+
+	for (uint32_t i = 0; i < numInputs; i++) {
+		data[0] = 0x01; // SIGN_TX_INPUT_TYPE_UTXO
+		os_memmove(data + 1, attestedInputs[i], ATTESTED_INPUT_SIZE);
+		expectSuccess(addApdu(0x21, 0x02, 0x00, data, 1 + ATTESTED_INPUT_SIZE), NULL, 0);
+	}
+
+	for (uint32_t i = 0; i < numOutputs; i++) {
+		u8be_write(data, OUTPUT_AMOUNT + i);
+		size_t size = 8;
+		if (i + 1 == numOutputs && numOutputs >= 2) {
+			data[size++] = 0x02; // SIGN_TX_OUTPUT_TYPE_PATH
+			size += writePath(data + size, 1, 0);
+		} else {
+			data[size++] = 0x01; // SIGN_TX_OUTPUT_TYPE_ADDRESS
+			size += parseHexString(RAW_ADDRESS_HEX, data + size, SIZEOF(data) - size);
+		}
+		expectSuccess(addApdu(0x21, 0x03, 0x00, data, size), NULL, 0);
+	}
+
+	// Tx hash is not known in advance
+	expectAnySuccess(addApdu(0x21, 0x04, 0x00, NULL, 0));
+
+	for (uint32_t i = 0; i < numInputs; i++) {
+		uint32_t address = i % numPaths;
+		if (isInterleaved) {
+			address = i % (numPaths - 1);
+		} else if (isDeclaredNumWitnesses) {
+			// Signing ends with the last unique path, repeats go first
+			address = (i < numInputs - numPaths) ? 0 : i - (numInputs - numPaths);
+		}
+		size_t size = writePath(data, 0, address);
+		step_t* step = addApdu(0x21, 0x05, 0x00, data, size);
+		if (isInterleaved && i == numPaths - 1) {
+			// Rejected, this also ends the call
+			u2be_write(step->expected, ERR_INVALID_DATA);
+			step->expectedSize = 2;
+			break;
+		}
+		expectAnySuccess(step);
+	}
+
+	// The last witness has to end the call, i.e. another instruction can start
+	expectAnySuccess(addApdu(0x00, 0x00, 0x00, NULL, 0));
+}
+
+static step_t* addSessionInput(const uint8_t* attestedInput)
+{
+	uint8_t data[1 + ATTESTED_INPUT_SIZE];
+	data[0] = 0x01; // SIGN_TX_INPUT_TYPE_UTXO
+	os_memmove(data + 1, attestedInput, ATTESTED_INPUT_SIZE);
+	return addApdu(0x21, 0x02, 0x00, data, SIZEOF(data));
+}
+
+// Single output and confirm of a session transaction
+static void addSessionTxEnd()
+{
+	uint8_t data[255];
+	u8be_write(data, OUTPUT_AMOUNT);
+	data[8] = 0x01; // SIGN_TX_OUTPUT_TYPE_ADDRESS
+	size_t size = 9 + parseHexString(RAW_ADDRESS_HEX, data + 9, SIZEOF(data) - 9);
+	expectSuccess(addApdu(0x21, 0x03, 0x00, data, size), NULL, 0);
+
+	// Responds with the tx hash
+	expectAnySuccess(addApdu(0x21, 0x04, 0x00, NULL, 0));
+}
+
+// Signing session of two transactions with one input each. First both
+// spend the same input (rejected as it would inflate the total fee),
+// then distinct ones
+static void generateSignSession()
+{
+	uint8_t attestedInputs[2][ATTESTED_INPUT_SIZE];
+	for (uint8_t i = 0; i < ARRAY_LEN(attestedInputs); i++) {
+		uint8_t txHash[32];
+		os_memset(txHash, 0x10 + i, SIZEOF(txHash));
+		writeAttestedUtxo(txHash, i, PARENT_OUTPUT_AMOUNT, attestedInputs[i]);
+	}
+
+	uint8_t counts[8];
+	u4be_write(counts, 1);
+	u4be_write(counts + 4, 1);
+
+	expectSuccess(addApdu(0x21, 0x01, 0x04, counts, SIZEOF(counts)), NULL, 0);
+	expectSuccess(addSessionInput(attestedInputs[0]), NULL, 0);
+	addSessionTxEnd();
+	expectSuccess(addApdu(0x21, 0x0A, 0x00, counts, SIZEOF(counts)), NULL, 0);
+	// Rejected, this also ends the call
+	step_t* reused = addSessionInput(attestedInputs[0]);
+	u2be_write(reused->expected, ERR_INVALID_DATA);
+	reused->expectedSize = 2;
+
+	expectSuccess(addApdu(0x21, 0x01, 0x04, counts, SIZEOF(counts)), NULL, 0);
+	for (uint8_t tx = 0; tx < ARRAY_LEN(attestedInputs); tx++) {
+		if (tx > 0) {
+			expectSuccess(addApdu(0x21, 0x0A, 0x00, counts, SIZEOF(counts)), NULL, 0);
+		}
+		expectSuccess(addSessionInput(attestedInputs[tx]), NULL, 0);
+		addSessionTxEnd();
+	}
+	expectSuccess(addApdu(0x21, 0x0B, 0x00, NULL, 0), NULL, 0);
+
+	uint8_t path[1 + 4 * BIP44_MAX_PATH_LENGTH];
+	size_t pathSize = writePath(path, 0, 0);
+	for (uint8_t tx = 0; tx < ARRAY_LEN(attestedInputs); tx++) {
+		expectAnySuccess(addApdu(0x21, 0x05, tx, path, pathSize));
+	}
+
+	// The last witness has to end the call, i.e. another instruction can start
+	expectAnySuccess(addApdu(0x00, 0x00, 0x00, NULL, 0));
+}
+
+enum {
+	// Longest boxed address signTx accepts in one APDU (longer than
+	// BASE58_MAX_INPUT_SIZE ones are shown as a digest)
+	MAX_BOXED_ADDRESS_SIZE = 200,
+	// Densest CBOR of attestUtxo: Array(2)[0, Tag(24)(Bytes(0))] ...
+	DENSE_INPUT_SIZE = 5,
+	// ... and Array(2)[Array(2)[Tag(24)(Bytes(0)), 0], 0]
+	DENSE_OUTPUT_SIZE = 7,
+	DENSE_TX_INPUTS = 200,
+	DENSE_TX_OUTPUTS = 100,
+};
+
+// Deepest accepted path (BIP44_MAX_PATH_LENGTH) with the longest string
+// form (see bip44_printToStr), unique per address
+static size_t writeDeepPath(uint8_t* out, uint32_t address)
+{
+	const uint32_t MAX_INDEX = HARDENED_BIP32 - 1;
+	uint32_t path[BIP44_MAX_PATH_LENGTH] = {
+		BIP_44 | HARDENED_BIP32, ADA_COIN_TYPE | HARDENED_BIP32, MAX_INDEX | HARDENED_BIP32, 1, MAX_INDEX - address
+	};
+	for (size_t i = BIP44_I_ADDRESS + 1; i < ARRAY_LEN(path); i++) path[i] = MAX_INDEX | HARDENED_BIP32;
+	out[0] = ARRAY_LEN(path);
+	for (size_t i = 0; i < ARRAY_LEN(path); i++) u4be_write(out + 1 + 4 * i, path[i]);
+	return 1 + 4 * ARRAY_LEN(path);
+}
+
+// Boxed address of exactly boxedSize bytes with a long attribute
+// Array(3)[Bytes(28)[root], Map(1)[1: Bytes[padding]], 0]
+static size_t buildBoxedAddress(size_t boxedSize, uint8_t* out)
+{
+	// Boxing adds Array(2), Tag(24), Bytes(size) header and Unsigned(crc32)
+	const size_t rawSize = boxedSize - 10;
+	const size_t paddingSize = rawSize - 36;
+	ASSERT(paddingSize >= 24 && rawSize <= 255);
+
+	uint8_t raw[255];
+	size_t pos = 0;
+	const uint8_t rootHeader[] = {0x83, 0x58, 0x1c};
+	pos = appendBytes(raw, pos, rootHeader, SIZEOF(rootHeader));
+	os_memset(raw + pos, 0x42, 28);
+	pos += 28;
+	const uint8_t attributesHeader[] = {0xa1, 0x01, 0x58, (uint8_t) paddingSize};
+	pos = appendBytes(raw, pos, attributesHeader, SIZEOF(attributesHeader));
+	os_memset(raw + pos, 0xff, paddingSize);
+	pos += paddingSize;
+	raw[pos++] = 0x00;
+	ASSERT(pos == rawSize);
+
+	const uint8_t boxHeader[] = {0x82, 0xd8, 0x18, 0x58, (uint8_t) rawSize};
+	size_t size = appendBytes(out, 0, boxHeader, SIZEOF(boxHeader));
+	size = appendBytes(out, size, raw, rawSize);
+	out[size++] = 0x1a;
+	u4be_write(out + size, crc32(raw, rawSize));
+	size += 4;
+	ASSERT(size == boxedSize);
+	return size;
+}
+
+// Raw address of exactly size bytes sent as SIGN_TX_OUTPUT_TYPE_ADDRESS_CHUNKED,
+// Array(3)[Bytes(28)[root], Map(1)[1: Bytes[padding]], 0] in full APDUs
+static void addChunkedOutput(uint32_t size)
+{
+	static uint8_t raw[BUFFER_SIZE_PARANOIA];
+	const size_t paddingSize = size - 37;
+	ASSERT(size <= SIZEOF(raw) && paddingSize >= 256);
+
+	size_t pos = 0;
+	const uint8_t rootHeader[] = {0x83, 0x58, 0x1c};
+	pos = appendBytes(raw, pos, rootHeader, SIZEOF(rootHeader));
+	os_memset(raw + pos, 0x42, 28);
+	pos += 28;
+	const uint8_t attributesHeader[] = {0xa1, 0x01, 0x59};
+	pos = appendBytes(raw, pos, attributesHeader, SIZEOF(attributesHeader));
+	u2be_write(raw + pos, (uint16_t) paddingSize);
+	pos += 2;
+	os_memset(raw + pos, 0xff, paddingSize);
+	pos += paddingSize;
+	raw[pos++] = 0x00;
+	ASSERT(pos == size);
+
+	uint8_t data[255];
+	u8be_write(data, OUTPUT_AMOUNT);
+	data[8] = 0x03; // SIGN_TX_OUTPUT_TYPE_ADDRESS_CHUNKED
+	u4be_write(data + 9, size);
+	size_t chunkSize = SIZEOF(data) - 13;
+	os_memmove(data + 13, raw, chunkSize);
+	expectSuccess(addApdu(0x21, 0x03, 0x00, data, 13 + chunkSize), NULL, 0);
+
+	for (pos = chunkSize; pos < size; pos += chunkSize) {
+		chunkSize = (size - pos < 255) ? size - pos : 255;
+		expectSuccess(addApdu(0x21, 0x03, 0x01, raw + pos, chunkSize), NULL, 0);
+	}
+}
+
+// Worst cases per APDU: deepest paths, densest CBOR for the attestUtxo
+// parser (parser_keepParsing), largest input batch and longest address
+// shown in base58
+static void generateWcet()
+{
+	uint8_t data[255];
+	size_t size;
+
+	// Key derivation cost grows with the path length
+	size = writeDeepPath(data, 0);
+	expectAnySuccess(addApdu(0x10, 0x00, 0x00, data, size));
+	expectAnySuccess(addApdu(0x11, 0x01, 0x00, data, size));
+	expectAnySuccess(addApdu(0x11, 0x02, 0x00, data, size));
+
+	// Every byte of a full APDU is a token or a parser state transition
+	{
+		static uint8_t tx[2 + DENSE_TX_INPUTS * DENSE_INPUT_SIZE + 2 + DENSE_TX_OUTPUTS * DENSE_OUTPUT_SIZE + 2];
+		const uint8_t input[DENSE_INPUT_SIZE] = {0x82, 0x00, 0xd8, 0x18, 0x40};
+		const uint8_t output[DENSE_OUTPUT_SIZE] = {0x82, 0x82, 0xd8, 0x18, 0x40, 0x00, 0x00};
+		size_t pos = 0;
+		tx[pos++] = 0x83;
+		tx[pos++] = 0x9f;
+		for (unsigned i = 0; i < DENSE_TX_INPUTS; i++) pos = appendBytes(tx, pos, input, SIZEOF(input));
+		tx[pos++] = 0xff;
+		tx[pos++] = 0x9f;
+		for (unsigned i = 0; i < DENSE_TX_OUTPUTS; i++) pos = appendBytes(tx, pos, output, SIZEOF(output));
+		tx[pos++] = 0xff;
+		tx[pos++] = 0xa0;
+		ASSERT(pos == SIZEOF(tx));
+
+		uint8_t attested[ATTESTED_INPUT_SIZE];
+		addAttestUtxo(tx, pos, DENSE_TX_OUTPUTS - 1, 0, 255, attested);
+	}
+
+	// signTx with a single batch of inputs (SIGN_TX_MAX_INPUTS_IN_BATCH in
+	// signTx.c), the longest address shown in base58, the longest boxed and
+	// chunked addresses and the deepest change and witness paths
+	const uint8_t numInputs = 5;
+	const uint8_t numOutputs = 4;
+
+	u4be_write(data, numInputs);
+	u4be_write(data + 4, numOutputs);
+	expectSuccess(addApdu(0x21, 0x01, 0x00, data, 8), NULL, 0);
+
+	data[0] = 0x03; // SIGN_TX_INPUT_TYPE_UTXO_BATCH
+	data[1] = numInputs;
+	size = 2;
+	uint8_t aggregateHmac[ATTEST_HMAC_SIZE] = {0};
+	for (uint8_t i = 0; i < numInputs; i++) {
+		uint8_t txHash[32];
+		os_memset(txHash, i, SIZEOF(txHash));
+		uint8_t attested[ATTESTED_INPUT_SIZE];
+		writeAttestedUtxo(txHash, i, PARENT_OUTPUT_AMOUNT, attested);
+		size = appendBytes(data, size, attested, 32 + 4 + 8);
+		for (size_t k = 0; k < ATTEST_HMAC_SIZE; k++) aggregateHmac[k] ^= attested[44 + k];
+	}
+	size = appendBytes(data, size, aggregateHmac, SIZEOF(aggregateHmac));
+	expectSuccess(addApdu(0x21, 0x02, 0x00, data, size), NULL, 0);
+
+	const size_t addressSizes[] = {BASE58_MAX_INPUT_SIZE, MAX_BOXED_ADDRESS_SIZE};
+	ITERATE(it, addressSizes) {
+		u8be_write(data, OUTPUT_AMOUNT);
+		data[8] = 0x01; // SIGN_TX_OUTPUT_TYPE_ADDRESS
+		size = 9 + buildBoxedAddress(*it, data + 9);
+		expectSuccess(addApdu(0x21, 0x03, 0x00, data, size), NULL, 0);
+	}
+	addChunkedOutput(BUFFER_SIZE_PARANOIA - 1);
+
+	u8be_write(data, OUTPUT_AMOUNT);
+	data[8] = 0x02; // SIGN_TX_OUTPUT_TYPE_PATH
+	size = 9 + writeDeepPath(data + 9, 0);
+	expectSuccess(addApdu(0x21, 0x03, 0x00, data, size), NULL, 0);
+
+	expectAnySuccess(addApdu(0x21, 0x04, 0x00, NULL, 0));
+
+	for (uint8_t i = 0; i < numInputs; i++) {
+		size = writeDeepPath(data, i);
+		expectAnySuccess(addApdu(0x21, 0x05, 0x00, data, size));
+	}
+
+	// Longest trusted address, longer ones cannot be shown and are rejected
+	size = buildBoxedAddress(BASE58_MAX_INPUT_SIZE, data);
+	expectSuccess(addApdu(0x24, 0x00, 0x00, data, size), NULL, 0);
+	size = buildBoxedAddress(BASE58_MAX_INPUT_SIZE + 1, data);
+	step_t* tooLongTrusted = addApdu(0x24, 0x00, 0x00, data, size);
+	u2be_write(tooLongTrusted->expected, ERR_INVALID_DATA);
+	tooLongTrusted->expectedSize = 2;
+
+	// Longer chunked addresses are rejected (and end the call)
+	const uint32_t tooLongSizes[] = {BUFFER_SIZE_PARANOIA, CARDANO_MAX_TX_SIZE + 1};
+	ITERATE(it, tooLongSizes) {
+		u4be_write(data, 1);
+		u4be_write(data + 4, 1);
+		expectSuccess(addApdu(0x21, 0x01, 0x00, data, 8), NULL, 0);
+		data[0] = 0x01; // SIGN_TX_INPUT_TYPE_UTXO
+		{
+			uint8_t txHash[32];
+			os_memset(txHash, 0xff, SIZEOF(txHash));
+			writeAttestedUtxo(txHash, 0, PARENT_OUTPUT_AMOUNT, data + 1);
+		}
+		expectSuccess(addApdu(0x21, 0x02, 0x00, data, 1 + ATTESTED_INPUT_SIZE), NULL, 0);
+		u8be_write(data, OUTPUT_AMOUNT);
+		data[8] = 0x03; // SIGN_TX_OUTPUT_TYPE_ADDRESS_CHUNKED
+		u4be_write(data + 9, *it);
+		step_t* tooLong = addApdu(0x21, 0x03, 0x00, data, 13);
+		u2be_write(tooLong->expected, ERR_INVALID_DATA);
+		tooLong->expectedSize = 2;
+	}
+}
+
+
+// Dispatch (mirrors cardano_main)
+
+static __thread bool hasCrashed;
+
+static void handleException(exception_t e)
+{
+	if (e >= _ERR_AUTORESPOND_START && e < _ERR_AUTORESPOND_END) {
+		io_send_buf(e, NULL, 0);
+		ui_idle();
+	} else {
+		// Device would reset (or hang) here without responding
+		flightRecorder_recordStatus((uint16_t) e);
+		flightRecorder_saveCrash();
+		fprintf(stderr, "app crashed with exception 0x%04x\n", (unsigned) e);
+		hasCrashed = true;
+	}
+}
+
+static void dispatchApdu(const step_t* step)
+{
+	BEGIN_TRY {
+		TRY {
+			ASSERT(appContext->io_state == IO_EXPECT_IO);
+			appContext->io_state = IO_EXPECT_NONE;
+
+			size_t rx = step->apduSize;
+			os_memmove(G_io_apdu_buffer, step->apdu, rx);
+			flightRecorder_recordRequest(G_io_apdu_buffer, rx);
+
+			struct {
+				uint8_t cla;
+				uint8_t ins;
+				uint8_t p1;
+				uint8_t p2;
+				uint8_t lc;
+			}* header = (void*) G_io_apdu_buffer;
+
+			VALIDATE(rx >= SIZEOF(*header), ERR_MALFORMED_REQUEST_HEADER);
+			VALIDATE(rx == header->lc + SIZEOF(*header), ERR_MALFORMED_REQUEST_HEADER);
+			VALIDATE(header->cla == CLA, ERR_BAD_CLA);
+
+			handler_fn_t* handlerFn = lookupHandler(header->ins);
+			VALIDATE(handlerFn != NULL, ERR_UNKNOWN_INS);
+
+			bool isNewCall = false;
+			if (appContext->currentInstruction == -1) {
+				os_memset(&appContext->instructionState, 0, SIZEOF(appContext->instructionState));
+				isNewCall = true;
+				appContext->currentInstruction = header->ins;
+			} else {
+				VALIDATE(header->ins == appContext->currentInstruction, ERR_STILL_IN_CALL);
+			}
+
+			// Note: the response overwrites the header
+			const uint8_t ins = header->ins;
+			const uint8_t p1 = header->p1;
+			const uint32_t startTicks = profiling_getTicks();
+			stackUsage_checkpoint(STACK_USAGE_STEP_HANDLER);
+			flightRecorder_setStage(FLIGHT_STAGE_HANDLER);
+			handlerFn(header->p1, header->p2, G_io_apdu_buffer + SIZEOF(*header), header->lc, isNewCall);
+			flightRecorder_setStage(FLIGHT_STAGE_RETURNED);
+			profiling_recordInstruction(ins, p1, startTicks);
+			stackUsage_checkpoint(STACK_USAGE_STEP_IDLE);
+		}
+		CATCH_OTHER(e) {
+			handleException(e);
+		}
+		FINALLY {
+		}
+	} END_TRY;
+}
+
+static void pressButton(bool isConfirm)
+{
+	BEGIN_TRY {
+		TRY {
+			if (isConfirm) {
+				host_pressConfirm();
+			} else {
+				host_pressReject();
+			}
+		}
+		CATCH_OTHER(e) {
+			// Exceptions in UI callbacks are not turned into responses
+			// (see TRY_CATCH_UI)
+			flightRecorder_recordStatus((uint16_t) e);
+			flightRecorder_saveCrash();
+			fprintf(stderr, "UI callback threw 0x%04x\n", (unsigned) e);
+			hasCrashed = true;
+		}
+		FINALLY {
+		}
+	} END_TRY;
+}
+
+
+// Replay
+
+static uint64_t cpuTimeNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Totals over all instructions (see syscalls.c)
+static void sumSyscalls(syscall_counter_t* out)
+{
+	const syscallStats_t* stats = &appContext->syscallStats;
+	os_memset(out, 0, _SYSCALL_COUNT * SIZEOF(*out));
+	for (uint8_t i = 0; i < stats->numInstructions; i++) {
+		for (size_t id = 0; id < _SYSCALL_COUNT; id++) {
+			out[id].calls += stats->instructions[i].counters[id].calls;
+			out[id].bytes += stats->instructions[i].counters[id].bytes;
+		}
+	}
+}
+
+// Note: counters only shrink if the APDU itself resets them (INS 0xF5)
+static void subtractSyscalls(syscall_counter_t* after, const syscall_counter_t* before)
+{
+	for (size_t id = 0; id < _SYSCALL_COUNT; id++) {
+		if (after[id].calls < before[id].calls || after[id].bytes < before[id].bytes) continue;
+		after[id].calls -= before[id].calls;
+		after[id].bytes -= before[id].bytes;
+	}
+}
+
+// Host CPU time spent in the syscalls so far (see profiling.c)
+static uint64_t syscallSitesNs()
+{
+	uint64_t ticks = 0;
+	ITERATE(it, SYSCALL_SITES) {
+		ticks += appContext->profiling.sites[*it].ticks;
+	}
+	return ticks * 1000000000 / profiling_getTicksPerSecond();
+}
+
+static uint64_t estimateDeviceUs(const syscall_counter_t* syscalls, uint64_t appCpuNs)
+{
+	uint64_t us = appCpuNs * DEVICE_SLOWDOWN / 1000;
+	for (size_t id = 0; id < _SYSCALL_COUNT; id++) {
+		us += (uint64_t) syscalls[id].calls * SYSCALL_COSTS[id].usPerCall;
+		us += (uint64_t) syscalls[id].bytes * SYSCALL_COSTS[id].usPerUnit;
+	}
+	return us;
+}
+
+static stage_stats_t* getStage(uint8_t ins, uint8_t p1)
+{
+	uint16_t key = (uint16_t) ((ins << 8) | p1);
+	for (size_t i = 0; i < numStages; i++) {
+		if (stages[i].key == key) return &stages[i];
+	}
+	ASSERT(numStages < MAX_STAGES);
+	stage_stats_t* stage = &stages[numStages++];
+	os_memset(stage, 0, SIZEOF(*stage));
+	stage->key = key;
+	return stage;
+}
+
+static void stageName(uint16_t key, char* out, size_t outSize)
+{
+	const uint8_t ins = (uint8_t) (key >> 8);
+	const uint8_t p1 = (uint8_t) key;
+
+	static const struct {
+		uint8_t ins;
+		const char* name;
+	} INS_NAMES[] = {
+		{0x00, "getVersion"},
+		{0x02, "flightRecorder"},
+		{0x10, "getExtPubKey"},
+		{0x11, "deriveAddress"},
+		{0x20, "attestUtxo"},
+		{0x21, "signTx"},
+		{0x22, "rotateAttestKey"},
+		{0x23, "getAttestKeyFp"},
+		{0x24, "addTrustedAddress"},
+		{0xF4, "profiling"},
+		{0xF5, "syscalls"},
+		{0xF6, "stack usage"},
+		{0xF7, "trace"},
+	};
+	static const char* SIGN_TX_STAGES[] = {
+		"?", "init", "input", "output", "confirm", "witness", "metadata",
+		"raw tx", "end inputs", "end outputs", "next tx", "finish session",
+	};
+
+	const char* name = NULL;
+	ITERATE(it, INS_NAMES) {
+		if (it->ins == ins) name = it->name;
+	}
+
+	if (name == NULL) {
+		snprintf(out, outSize, "INS %02x P1 %02x", ins, p1);
+	} else if (ins == 0x21 && p1 < ARRAY_LEN(SIGN_TX_STAGES)) {
+		snprintf(out, outSize, "%s %s", name, SIGN_TX_STAGES[p1]);
+	} else if (ins == 0x20) {
+		snprintf(out, outSize, "%s %s", name, p1 == 0x01 ? "init" : "data");
+	} else {
+		snprintf(out, outSize, "%s P1 %02x", name, p1);
+	}
+}
+
+// Returns false if the replay cannot continue
+static bool replayStep(const step_t* step, size_t stepIndex)
+{
+	const host_response_t* response = host_getResponse();
+	const unsigned responseCount = response->count;
+	size_t buttonIndex = 0;
+	unsigned numScreens = 0;
+
+	if (isVerbose) {
+		printf("=> ");
+		printHex(stdout, step->apdu, step->apduSize);
+		printf("\n");
+	}
+
+	syscall_counter_t syscalls[_SYSCALL_COUNT];
+	sumSyscalls(syscalls);
+	const uint32_t droppedSyscalls = appContext->syscallStats.numDroppedCalls;
+	const uint64_t startSyscallNs = syscallSitesNs();
+	uint64_t start = cpuTimeNs();
+
+	dispatchApdu(step);
+
+	// The response may be delayed until the user goes through the screens
+	while (!hasCrashed && response->count == responseCount && appContext->io_state == IO_EXPECT_UI) {
+		const host_screen_t* screen = host_getScreen();
+		if (isVerbose) printf("   [%s] %s\n", screen->header, screen->text);
+
+		bool isConfirm = true;
+		if (screen->type == HOST_SCREEN_PROMPT && buttonIndex < step->numButtons) {
+			isConfirm = step->buttons[buttonIndex++];
+		}
+		pressButton(isConfirm);
+
+		if (++numScreens > MAX_SCREENS_PER_APDU) {
+			fprintf(stderr, "APDU #%u: no response after %u screens\n", (unsigned) stepIndex, numScreens);
+			return false;
+		}
+	}
+
+	uint64_t elapsed = cpuTimeNs() - start;
+	// Note: the profiling counters may have been reset (INS 0xF4)
+	const uint64_t syscallNs = syscallSitesNs();
+	uint64_t appCpuNs = elapsed;
+	if (syscallNs >= startSyscallNs && syscallNs - startSyscallNs <= elapsed) {
+		appCpuNs -= syscallNs - startSyscallNs;
+	}
+	{
+		syscall_counter_t after[_SYSCALL_COUNT];
+		sumSyscalls(after);
+		subtractSyscalls(after, syscalls);
+		os_memmove(syscalls, after, SIZEOF(after));
+	}
+
+	if (hasCrashed) return false;
+	if (response->count != responseCount + 1) {
+		fprintf(stderr, "APDU #%u: expected one response, got %u\n", (unsigned) stepIndex, response->count - responseCount);
+		return false;
+	}
+
+	if (isVerbose) {
+		printf("<= ");
+		printHex(stdout, response->buffer, response->size);
+		printf("\n");
+	}
+
+	stage_stats_t* stage = getStage(step->apdu[1], step->apdu[2]);
+	stage->numApdus++;
+	stage->bytesIn += step->apduSize;
+	stage->bytesOut += response->size;
+	stage->numScreens += numScreens;
+	stage->cpuNs += elapsed;
+	const uint64_t deviceUs = estimateDeviceUs(syscalls, appCpuNs);
+	if (stage->numApdus == 1 || deviceUs > stage->maxDeviceUs) {
+		stage->maxStepIndex = stepIndex;
+		stage->maxAppCpuNs = appCpuNs;
+		stage->maxDeviceUs = deviceUs;
+		os_memmove(stage->maxSyscalls, syscalls, SIZEOF(syscalls));
+	}
+	if (appContext->syscallStats.numDroppedCalls != droppedSyscalls) {
+		stage->hasDroppedSyscalls = true;
+	}
+
+	if (step->expectedSize > 0) {
+		// Bare status word accepts any data
+		bool isOk = (step->expectedSize == 2)
+		            ? (response->size >= 2 && os_memcmp(response->buffer + response->size - 2, step->expected, 2) == 0)
+		            : (response->size == step->expectedSize && os_memcmp(response->buffer, step->expected, step->expectedSize) == 0);
+		if (!isOk) {
+			fprintf(stderr, "APDU #%u: unexpected response ", (unsigned) stepIndex);
+			printHex(stderr, response->buffer, response->size);
+			fprintf(stderr, ", expected ");
+			printHex(stderr, step->expected, step->expectedSize);
+			fprintf(stderr, "\n");
+			return false;
+		}
+	}
+	return true;
+}
+
+// Each worker replays the whole transcript on its own app instance
+typedef struct {
+	pthread_t thread;
+	unsigned repeat;
+	bool isOk;
+	stage_stats_t stages[MAX_STAGES];
+	size_t numStages;
+} worker_t;
+
+static void* runWorker(void* arg)
+{
+	worker_t* worker = arg;
+
+	app_context_t* context = malloc(sizeof(app_context_t));
+	ASSERT(context != NULL);
+	host_startApp(context);
+	// As at the app start (see main.c)
+	appContext->io_state = IO_EXPECT_IO;
+
+	worker->isOk = true;
+	for (unsigned r = 0; r < worker->repeat && worker->isOk; r++) {
+		for (size_t i = 0; i < numSteps && worker->isOk; i++) {
+			worker->isOk = replayStep(&steps[i], i);
+		}
+	}
+
+	os_memmove(worker->stages, stages, SIZEOF(stages));
+	worker->numStages = numStages;
+	free(context);
+	return NULL;
+}
+
+// Sums up stats of all workers (into the stats of this thread)
+static void mergeStats(const worker_t* workers, size_t numWorkers)
+{
+	for (size_t w = 0; w < numWorkers; w++) {
+		for (size_t i = 0; i < workers[w].numStages; i++) {
+			const stage_stats_t* s = &workers[w].stages[i];
+			stage_stats_t* stage = getStage((uint8_t) (s->key >> 8), (uint8_t) s->key);
+			stage->numApdus += s->numApdus;
+			stage->bytesIn += s->bytesIn;
+			stage->bytesOut += s->bytesOut;
+			stage->numScreens += s->numScreens;
+			stage->cpuNs += s->cpuNs;
+			if (s->maxDeviceUs > stage->maxDeviceUs) {
+				stage->maxStepIndex = s->maxStepIndex;
+				stage->maxAppCpuNs = s->maxAppCpuNs;
+				stage->maxDeviceUs = s->maxDeviceUs;
+				os_memmove(stage->maxSyscalls, s->maxSyscalls, SIZEOF(s->maxSyscalls));
+			}
+			stage->hasDroppedSyscalls |= s->hasDroppedSyscalls;
+		}
+	}
+}
+
+static void printReport(unsigned repeat)
+{
+	unsigned numApdus = 0, numScreens = 0;
+	size_t bytesIn = 0, bytesOut = 0;
+	uint64_t cpuNs = 0;
+
+	printf("%-24s %7s %10s %10s %8s %12s %12s\n",
+	       "stage", "apdus", "bytes in", "bytes out", "screens", "cpu [us]", "us/apdu");
+	for (size_t i = 0; i < numStages; i++) {
+		const stage_stats_t* s = &stages[i];
+		char name[40];
+		stageName(s->key, name, SIZEOF(name));
+		printf("%-24s %7u %10u %10u %8u %12.1f %12.1f\n",
+		       name, s->numApdus / repeat, (unsigned) (s->bytesIn / repeat), (unsigned) (s->bytesOut / repeat),
+		       s->numScreens / repeat, s->cpuNs / 1000.0 / repeat, s->cpuNs / 1000.0 / s->numApdus);
+
+		numApdus += s->numApdus;
+		numScreens += s->numScreens;
+		bytesIn += s->bytesIn;
+		bytesOut += s->bytesOut;
+		cpuNs += s->cpuNs;
+	}
+	printf("%-24s %7u %10u %10u %8u %12.1f\n",
+	       "total", numApdus / repeat, (unsigned) (bytesIn / repeat), (unsigned) (bytesOut / repeat),
+	       numScreens / repeat, cpuNs / 1000.0 / repeat);
+	if (repeat > 1) printf("(averages over %u runs)\n", repeat);
+}
+
+// Worst APDU per stage and its estimated device time, returns false
+// if any exceeds the budget
+static bool printWcetReport(unsigned budgetMs)
+{
+	bool isOk = true;
+
+	printf("\n%-24s %6s %10s %11s %12s %11s %7s %5s %7s %5s\n",
+	       "worst apdu", "#", "app [us]", "device [ms]", "hash", "hmac", "derive", "sign", "pubkey", "rng");
+	for (size_t i = 0; i < numStages; i++) {
+		const stage_stats_t* s = &stages[i];
+		const syscall_counter_t* c = s->maxSyscalls;
+		char name[40];
+		stageName(s->key, name, SIZEOF(name));
+
+		char hash[16], hmac[16];
+		snprintf(hash, SIZEOF(hash), "%u/%uB", c[SYSCALL_CX_HASH].calls, c[SYSCALL_CX_HASH].bytes);
+		snprintf(hmac, SIZEOF(hmac), "%u/%uB", c[SYSCALL_CX_HMAC_SHA256].calls, c[SYSCALL_CX_HMAC_SHA256].bytes);
+
+		const bool isOverBudget = s->maxDeviceUs > (uint64_t) budgetMs * 1000;
+		printf("%-24s %6u %10.1f %11.1f %12s %11s %7u %5u %7u %5u%s%s\n",
+		       name, (unsigned) s->maxStepIndex, s->maxAppCpuNs / 1000.0, s->maxDeviceUs / 1000.0,
+		       hash, hmac,
+		       c[SYSCALL_OS_PERSO_DERIVE_NODE_BIP32].calls, c[SYSCALL_CX_EDDSA_SIGN].calls,
+		       c[SYSCALL_CX_EDDSA_GET_PUBLIC_KEY].calls, c[SYSCALL_CX_RNG].calls,
+		       isOverBudget ? "  OVER BUDGET" : "",
+		       s->hasDroppedSyscalls ? "  (syscalls dropped)" : "");
+
+		isOk = isOk && !isOverBudget && !s->hasDroppedSyscalls;
+	}
+	printf("budget %u ms per APDU (BLE command timeout %u ms): %s\n",
+	       budgetMs, BLE_COMMAND_TIMEOUT_MS, isOk ? "ok" : "FAILED");
+	return isOk;
+}
+
+static double wallTimeSeconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Command line names of policy_profile_t
+static const char* PROFILE_NAMES[POLICY_PROFILE_COUNT] = {
+	[POLICY_PROFILE_STRICT] = "strict",
+	[POLICY_PROFILE_BATCH_OPERATOR] = "batch-operator",
+	[POLICY_PROFILE_ATTEST_ONLY] = "attest-only",
+};
+
+static void usage(const char* program)
+{
+	fprintf(stderr,
+	        "usage: %s [options] [--sign-tx INPUTS OUTPUTS] [--wcet] [TRANSCRIPT...]\n"
+	        "  --sign-tx N M  attest N UTxOs and sign a tx with them and M outputs\n"
+	        "  --witness-paths K\n"
+	        "                 sign the inputs of --sign-tx with K distinct paths\n"
+	        "  --declare-witnesses\n"
+	        "                 declare the number of witnesses of --sign-tx\n"
+	        "  --interleave-witnesses\n"
+	        "                 request declared witnesses in input order (rejected)\n"
+	        "  --sign-session sign a session of two transactions (and reject one\n"
+	        "                 spending an input twice)\n"
+	        "  --wcet         add worst case APDUs and check the worst one of each stage\n"
+	        "                 against the budget (estimated device time)\n"
+	        "  --budget-ms B  per APDU budget of --wcet (default %u)\n"
+	        "  --profile P    policy profile (strict, batch-operator, attest-only)\n"
+	        "  --dump         print the transcript instead of replaying it\n"
+	        "  --repeat K     replay K times and report averages\n"
+	        "  --threads T    replay on T app instances in parallel (one per thread)\n"
+	        "  -v             print APDUs, screens and responses\n"
+	        "  -vv            also print app traces\n",
+	        program, DEFAULT_BUDGET_MS);
+	exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv)
+{
+	bool isDump = false;
+	unsigned repeat = 1;
+	unsigned numThreads = 1;
+	const char* transcripts[64];
+	size_t numTranscripts = 0;
+	long signTxInputs = -1, signTxOutputs = -1, signTxPaths = -1;
+	bool isDeclaredNumWitnesses = false;
+	bool isInterleaved = false;
+	bool isWcet = false;
+	bool isSignSession = false;
+	unsigned budgetMs = DEFAULT_BUDGET_MS;
+	policy_profile_t profile = POLICY_PROFILE_STRICT;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--sign-tx") == 0 && i + 2 < argc) {
+			signTxInputs = strtol(argv[++i], NULL, 10);
+			signTxOutputs = strtol(argv[++i], NULL, 10);
+		} else if (strcmp(argv[i], "--witness-paths") == 0 && i + 1 < argc) {
+			signTxPaths = strtol(argv[++i], NULL, 10);
+		} else if (strcmp(argv[i], "--declare-witnesses") == 0) {
+			isDeclaredNumWitnesses = true;
+		} else if (strcmp(argv[i], "--interleave-witnesses") == 0) {
+			isInterleaved = true;
+		} else if (strcmp(argv[i], "--sign-session") == 0) {
+			isSignSession = true;
+		} else if (strcmp(argv[i], "--wcet") == 0) {
+			isWcet = true;
+		} else if (strcmp(argv[i], "--budget-ms") == 0 && i + 1 < argc) {
+			budgetMs = (unsigned) strtoul(argv[++i], NULL, 10);
+			if (budgetMs == 0) usage(argv[0]);
+		} else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+			i++;
+			size_t p = 0;
+			while (p < ARRAY_LEN(PROFILE_NAMES) && strcmp(argv[i], PROFILE_NAMES[p]) != 0) p++;
+			if (p == ARRAY_LEN(PROFILE_NAMES)) usage(argv[0]);
+			profile = (policy_profile_t) p;
+		} else if (strcmp(argv[i], "--dump") == 0) {
+			isDump = true;
+		} else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+			repeat = (unsigned) strtoul(argv[++i], NULL, 10);
+			if (repeat == 0) usage(argv[0]);
+		} else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			numThreads = (unsigned) strtoul(argv[++i], NULL, 10);
+			if (numThreads == 0) usage(argv[0]);
+		} else if (strcmp(argv[i], "-v") == 0) {
+			isVerbose = true;
+		} else if (strcmp(argv[i], "-vv") == 0) {
+			isVerbose = true;
+			host_setVerbose(true);
+		} else if (argv[i][0] == '-' || numTranscripts >= ARRAY_LEN(transcripts)) {
+			usage(argv[0]);
+		} else {
+			transcripts[numTranscripts++] = argv[i];
+		}
+	}
+	if (numTranscripts == 0 && signTxInputs < 0 && !isSignSession && !isWcet) usage(argv[0]);
+
+	host_platform_init();
+	// Note: NVRAM is shared by all app instances (see --threads)
+	securityPolicy_setProfile(profile);
+
+	if (signTxInputs >= 0) {
+		if (signTxPaths < 0) signTxPaths = signTxInputs;
+		generateSignTx(
+		        (uint32_t) signTxInputs, (uint32_t) signTxOutputs,
+		        (uint32_t) signTxPaths, isDeclaredNumWitnesses, isInterleaved
+		);
+	}
+	if (isSignSession) {
+		generateSignSession();
+	}
+	if (isWcet) {
+		generateWcet();
+	}
+	for (size_t i = 0; i < numTranscripts; i++) {
+		loadTranscript(transcripts[i]);
+	}
+
+	if (isDump) {
+		dumpTranscript(stdout);
+		return EXIT_SUCCESS;
+	}
+
+	worker_t* workers = calloc(numThreads, sizeof(worker_t));
+	ASSERT(workers != NULL);
+	double start = wallTimeSeconds();
+	for (unsigned t = 0; t < numThreads; t++) {
+		workers[t].repeat = repeat;
+		if (pthread_create(&workers[t].thread, NULL, runWorker, &workers[t]) != 0) {
+			perror("pthread_create");
+			return EXIT_FAILURE;
+		}
+	}
+	bool isOk = true;
+	for (unsigned t = 0; t < numThreads; t++) {
+		pthread_join(workers[t].thread, NULL);
+		isOk = isOk && workers[t].isOk;
+	}
+	double elapsed = wallTimeSeconds() - start;
+	if (!isOk) return EXIT_FAILURE;
+
+	mergeStats(workers, numThreads);
+	free(workers);
+
+	printReport(repeat * numThreads);
+	if (numThreads > 1) {
+		printf("%u threads: %.1f ms wall time, %.0f APDUs/s\n",
+		       numThreads, elapsed * 1000, numSteps * repeat * numThreads / elapsed);
+	}
+	if (isWcet && !printWcetReport(budgetMs)) return EXIT_FAILURE;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,102 @@
+// Runs unit tests of the app (the same ones as INS 0xF0 on a DEVEL device)
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "host.h"
+#include "platform.h"
+
+#include "stream.h"
+#include "cbor.h"
+#include "cborValidator.h"
+#include "endian.h"
+#include "base58.h"
+#include "hex_utils.h"
+#include "hash.h"
+#include "attestUtxo.h"
+#include "attestKey.h"
+#include "crc32.h"
+#include "txHashBuilder.h"
+#include "txParser.h"
+#include "txInputSet.h"
+#include "textUtils.h"
+#include "keyDerivation.h"
+#include "addressUtils.h"
+#include "hmac.h"
+#include "profiling.h"
+#include "syscalls.h"
+#include "stackUsage.h"
+#include "trace.h"
+#include "flightRecorder.h"
+#include "crypto.h"
+
+typedef struct {
+	const char* name;
+	void (*run)();
+} unit_test_t;
+
+#define TEST(fn) { #fn, fn }
+
+static const unit_test_t TESTS[] = {
+	TEST(run_textUtils_test),
+	TEST(run_txHashBuilder_test),
+	TEST(run_endian_test),
+	TEST(run_hex_test),
+	TEST(run_stream_test),
+	TEST(run_cbor_test),
+	TEST(run_cborValidator_test),
+	TEST(run_base58_test),
+	TEST(run_hash_test),
+	TEST(run_test_attestUtxo),
+	TEST(run_txParser_test),
+	TEST(run_txInputSet_test),
+	TEST(run_attestKey_test),
+	TEST(run_key_derivation_test),
+	TEST(run_address_utils_test),
+	TEST(run_crc32_test),
+	TEST(run_hmac_test),
+	TEST(run_profiling_test),
+	TEST(run_syscalls_test),
+	TEST(run_stackUsage_test),
+	TEST(run_trace_test),
+	TEST(run_flightRecorder_test),
+	// Host only
+	TEST(run_crypto_test),
+};
+
+static bool runTest(const unit_test_t* test)
+{
+	volatile bool isOk = false;
+
+	BEGIN_TRY {
+		TRY {
+			test->run();
+			isOk = true;
+		}
+		CATCH_OTHER(e) {
+			printf("  exception 0x%04x\n", e);
+		}
+		FINALLY {
+		}
+	} END_TRY;
+
+	return isOk;
+}
+
+int main(int argc, char** argv)
+{
+	// -v prints test traces
+	host_setVerbose(argc > 1 && strcmp(argv[1], "-v") == 0);
+	host_platform_init();
+
+	unsigned numFailed = 0;
+	for (size_t i = 0; i < ARRAY_LEN(TESTS); i++) {
+		bool isOk = runTest(&TESTS[i]);
+		printf("%-28s %s\n", TESTS[i].name, isOk ? "ok" : "FAILED");
+		if (!isOk) numFailed++;
+	}
+
+	printf("%u/%u tests passed\n", (unsigned) (ARRAY_LEN(TESTS) - numFailed), (unsigned) ARRAY_LEN(TESTS));
+	return numFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
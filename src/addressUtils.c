@@ -3,6 +3,7 @@
 #include "keyDerivation.h"
 #include "cbor.h"
 #include "cardano.h"
+#include "profiling.h"
 #include "hash.h"
 #include "crc32.h"
 #include "bufView.h"
@@ -129,13 +130,12 @@ static void parseTokenWithValue(read_view_t* view, uint8_t type, uint64_t value)
 }
 
 
-size_t unboxChecksummedAddress(
+size_t unboxChecksummedAddressInPlace(
         const uint8_t* addressBuffer, size_t addressSize,
-        uint8_t* outputBuffer, size_t outputSize
+        const uint8_t** unboxedBufferPtr
 )
 {
 	ASSERT(addressSize < BUFFER_SIZE_PARANOIA);
-	ASSERT(outputSize < BUFFER_SIZE_PARANOIA);
 
 	read_view_t view = make_read_view(addressBuffer, addressBuffer + addressSize);
 
@@ -169,6 +169,20 @@ size_t unboxChecksummedAddress(
 
 	VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
 
+	*unboxedBufferPtr = unboxedBuffer;
+	return unboxedSize;
+}
+
+size_t unboxChecksummedAddress(
+        const uint8_t* addressBuffer, size_t addressSize,
+        uint8_t* outputBuffer, size_t outputSize
+)
+{
+	ASSERT(outputSize < BUFFER_SIZE_PARANOIA);
+
+	const uint8_t* unboxedBuffer;
+	size_t unboxedSize = unboxChecksummedAddressInPlace(addressBuffer, addressSize, &unboxedBuffer);
+
 	VALIDATE(unboxedSize <= outputSize, ERR_DATA_TOO_LARGE);
 	os_memmove(outputBuffer, unboxedBuffer, unboxedSize);
 	return unboxedSize;
@@ -203,15 +217,17 @@ size_t deriveAddress(
         uint8_t* outBuffer, size_t outSize
 )
 {
+	PROFILING_BEGIN();
 	uint8_t rawAddressBuffer[40];
 	size_t rawAddressSize = deriveRawAddress(
 	                                pathSpec,
 	                                rawAddressBuffer, SIZEOF(rawAddressBuffer)
 	                        );
 
-	return cborPackRawAddressWithChecksum(
-	               rawAddressBuffer, rawAddressSize,
-	               outBuffer, outSize
-	       );
-
+	size_t addressSize = cborPackRawAddressWithChecksum(
+	                             rawAddressBuffer, rawAddressSize,
+	                             outBuffer, outSize
+	                     );
+	PROFILING_END(PROFILING_SITE_DERIVE_ADDRESS);
+	return addressSize;
 }
@@ -26,7 +26,13 @@ size_t deriveRawAddress(
 );
 
 // Note: validates boxing
-// TODO(ppershing): should we just return a pointer view?
+// Returns pointer to the unboxed address inside addressBuffer
+size_t unboxChecksummedAddressInPlace(
+        const uint8_t* addressBuffer, size_t addressSize,
+        const uint8_t** unboxedBufferPtr
+);
+
+// Note: validates boxing
 size_t unboxChecksummedAddress(
         const uint8_t* addressBuffer, size_t addressSize,
         uint8_t* outputBuffer, size_t outputSize
@@ -16,8 +16,7 @@ static void pathSpec_init(bip44_path_t* pathSpec, uint32_t* pathArray, uint32_t
 
 static void PRINTF_bip44(const bip44_path_t* pathSpec)
 {
-	char tmp[100];
-	SIZEOF(*pathSpec);
+	char tmp[BIP44_PATH_STRING_SIZE];
 	bip44_printToStr(pathSpec, tmp, SIZEOF(tmp));
 	PRINTF("%s", tmp);
 };
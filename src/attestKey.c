@@ -1,46 +1,69 @@
 #include "common.h"
 #include "attestKey.h"
-#include "hmac.h"
+#include "storage.h"
+#include "state.h"
+#include "uiHelpers.h"
+#include "securityPolicy.h"
+#include "syscalls.h"
 
-static const size_t ATTEST_KEY_SIZE = 32;
+// Personalization of the BLAKE2b MAC. Purpose byte is appended to it
+// so that attestations cannot be replayed across purposes
+static const char ATTEST_PERSONALIZATION[] = "cardano-attest";
 
-typedef struct {
-	uint8_t key[ATTEST_KEY_SIZE];
-} attestKeyData_t;
-
-
-// Global data
-attestKeyData_t attestKeyData;
-
-// Sanity check
-STATIC_ASSERT(sizeof(attestKeyData.key) == ATTEST_KEY_SIZE, "bad ATTEST_KEY_SIZE");
+static bool attest_isKnownPurpose(attest_purpose_t purpose)
+{
+	switch (purpose) {
+	case ATTEST_PURPOSE_BIND_UTXO_AMOUNT:
+	case ATTEST_PURPOSE_KEY_FINGERPRINT:
+		return true;
+	default:
+		return false;
+	}
+}
 
+// Note: Ledger does not expose keyed BLAKE2b so we use
+// prefix-MAC BLAKE2b(key || data). Unlike SHA2, BLAKE2 is not prone
+// to length-extension and prefix-MAC is secure. Compared to HMAC-SHA256
+// this is a single compression for our short messages
 void attest_writeHmac(
         attest_purpose_t purpose,
         const uint8_t* data, uint8_t dataSize,
         uint8_t* hmac, uint8_t hmacSize
 )
 {
-	if (purpose != ATTEST_PURPOSE_BIND_UTXO_AMOUNT) {
-		// Once implemented, purpose *must* become part of the HMAC
-		// as we need to avoid cross-purpose replay attacks
+	if (!attest_isKnownPurpose(purpose)) {
 		THROW(ERR_NOT_IMPLEMENTED);
 	}
-	ASSERT(hmacSize = ATTEST_HMAC_SIZE);
-	// attested HMAC
-	uint8_t tmpBuffer[32];
-	hmac_sha256(
-	        attestKeyData.key, SIZEOF(attestKeyData.key),
-	        data, dataSize,
-	        tmpBuffer, SIZEOF(tmpBuffer)
+	ASSERT(hmacSize == ATTEST_HMAC_SIZE);
+
+	uint8_t personalization[16];
+	STATIC_ASSERT(SIZEOF(ATTEST_PERSONALIZATION) < SIZEOF(personalization), "personalization too long");
+	os_memset(personalization, 0, SIZEOF(personalization));
+	os_memmove(personalization, ATTEST_PERSONALIZATION, strlen(ATTEST_PERSONALIZATION));
+	personalization[SIZEOF(personalization) - 1] = (uint8_t) purpose;
+
+	cx_blake2b_t ctx;
+	// Note: output size is part of BLAKE2b parameter block so there
+	// is no need to truncate a longer digest
+	cx_blake2b_init2(
+	        &ctx, ATTEST_HMAC_SIZE * 8,
+	        NULL, 0,
+	        personalization, SIZEOF(personalization)
 	);
+	cx_hash(&ctx.header, 0, appContext->attestKeyData.key, SIZEOF(appContext->attestKeyData.key), NULL, 0);
+	cx_hash(&ctx.header, CX_LAST, data, dataSize, hmac, hmacSize);
+}
 
-	// sanity check before copying
-	ASSERT(hmacSize <= SIZEOF(tmpBuffer));
-	os_memmove(hmac, tmpBuffer, hmacSize);
+// Constant-time comparison
+static bool attest_isEqualHmac(const uint8_t* hmac1, const uint8_t* hmac2, size_t hmacSize)
+{
+	uint8_t diff = 0;
+	for (size_t i = 0; i < hmacSize; i++) {
+		diff |= hmac1[i] ^ hmac2[i];
+	}
+	return diff == 0;
 }
 
-// Todo: this could be done in a better way
 bool attest_isCorrectHmac(
         attest_purpose_t purpose,
         const uint8_t* data, uint8_t dataSize,
@@ -52,14 +75,187 @@ bool attest_isCorrectHmac(
 	ASSERT(hmacSize == ATTEST_HMAC_SIZE);
 
 	attest_writeHmac(purpose, data, dataSize, tmpBuffer, SIZEOF(tmpBuffer));
-	return os_memcmp(hmac, tmpBuffer, SIZEOF(tmpBuffer)) == 0;
+	return attest_isEqualHmac(hmac, tmpBuffer, SIZEOF(tmpBuffer));
+}
+
+bool attest_isCorrectAggregateHmac(
+        attest_purpose_t purpose,
+        const uint8_t* records, uint8_t recordSize, uint8_t numRecords,
+        uint8_t* hmac, uint8_t hmacSize
+)
+{
+	ASSERT(hmacSize == ATTEST_HMAC_SIZE);
+	ASSERT((size_t) recordSize * numRecords < BUFFER_SIZE_PARANOIA);
+
+	uint8_t aggregate[ATTEST_HMAC_SIZE];
+	os_memset(aggregate, 0, SIZEOF(aggregate));
+
+	for (uint8_t i = 0; i < numRecords; i++) {
+		const uint8_t* record = records + (size_t) i * recordSize;
+
+		// Note: XOR aggregation is secure only for distinct
+		// messages. Identical records would cancel each other out
+		for (uint8_t j = 0; j < i; j++) {
+			if (os_memcmp(record, records + (size_t) j * recordSize, recordSize) == 0) {
+				return false;
+			}
+		}
+
+		uint8_t tmpBuffer[ATTEST_HMAC_SIZE];
+		attest_writeHmac(purpose, record, recordSize, tmpBuffer, SIZEOF(tmpBuffer));
+		for (size_t k = 0; k < SIZEOF(aggregate); k++) {
+			aggregate[k] ^= tmpBuffer[k];
+		}
+	}
+	return attest_isEqualHmac(hmac, aggregate, SIZEOF(aggregate));
 }
 
 
-// Should be called at app startup
+STATIC_ASSERT((int) ATTEST_KEY_SIZE == (int) STORAGE_ATTEST_KEY_SIZE, "bad STORAGE_ATTEST_KEY_SIZE");
+
+// Fingerprint is an attestation of a fixed label under its own purpose.
+// It identifies the key without revealing it and, thanks to domain
+// separation, cannot be used as an attestation of anything else.
+// Must be called whenever the key changes.
+static void attestKey_updateFingerprint()
+{
+	static const char FINGERPRINT_LABEL[] = "attest key fingerprint";
+
+	attest_writeHmac(
+	        ATTEST_PURPOSE_KEY_FINGERPRINT,
+	        (const uint8_t*) FINGERPRINT_LABEL, strlen(FINGERPRINT_LABEL),
+	        appContext->attestKeyData.fingerprint, SIZEOF(appContext->attestKeyData.fingerprint)
+	);
+}
+
+static void attestKey_generate()
+{
+	cx_rng(appContext->attestKeyData.key, ATTEST_KEY_SIZE);
+	attestKey_updateFingerprint();
+}
+
+// Should be called at app startup (after storage_initialize)
 void attestKey_initialize()
 {
-	cx_rng(attestKeyData.key, ATTEST_KEY_SIZE);
+	if (storage_isAttestKeyPersistent()) {
+		storage_readAttestKey(appContext->attestKeyData.key, ATTEST_KEY_SIZE);
+		attestKey_updateFingerprint();
+	} else {
+		attestKey_generate();
+	}
+}
+
+bool attestKey_isPersistent()
+{
+	return storage_isAttestKeyPersistent();
+}
+
+// Note: enabling persistence keeps the current session key
+// so that attestations obtained in this session remain valid.
+// Disabling it wipes the stored key and starts a fresh session key.
+void attestKey_setPersistent(bool isPersistent)
+{
+	if (isPersistent == storage_isAttestKeyPersistent()) return;
+
+	if (isPersistent) {
+		storage_enablePersistentAttestKey(appContext->attestKeyData.key, ATTEST_KEY_SIZE);
+	} else {
+		storage_disablePersistentAttestKey();
+		attestKey_generate();
+	}
+}
+
+// Invalidates all previously issued attestations
+void attestKey_rotate()
+{
+	attestKey_generate();
+	if (storage_isAttestKeyPersistent()) {
+		storage_enablePersistentAttestKey(appContext->attestKeyData.key, ATTEST_KEY_SIZE);
+	}
+}
+
+
+#define ctx (&appContext->instructionState.rotateAttestKeyContext)
+
+// forward declaration
+static void rotateAttestKey_ui_runStep();
+enum {
+	ROTATE_ATTEST_KEY_STEP_CONFIRM = 100,
+	ROTATE_ATTEST_KEY_STEP_RESPOND,
+	ROTATE_ATTEST_KEY_STEP_INVALID,
+};
+
+void rotateAttestKey_handleAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        uint8_t* wireDataBuffer MARK_UNUSED,
+        size_t wireDataSize,
+        bool isNewCall
+)
+{
+	if (isNewCall) {
+		os_memset(ctx, 0, SIZEOF(*ctx));
+	}
+
+	VALIDATE(p1 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_DATA);
+
+	security_policy_t policy = policyForRotateAttestKey();
+	ENSURE_NOT_DENIED(policy);
+
+	switch (policy) {
+#	define  CASE(policy, step) case policy: {ctx->ui_step = step; break;}
+		CASE(POLICY_PROMPT_BEFORE_RESPONSE, ROTATE_ATTEST_KEY_STEP_CONFIRM);
+		CASE(POLICY_ALLOW_WITHOUT_PROMPT,   ROTATE_ATTEST_KEY_STEP_RESPOND);
+#	undef   CASE
+	default:
+		THROW(ERR_NOT_IMPLEMENTED);
+	}
+	rotateAttestKey_ui_runStep();
+}
+
+static void rotateAttestKey_ui_runStep()
+{
+	ui_callback_fn_t* this_fn = rotateAttestKey_ui_runStep;
+
+	UI_STEP_BEGIN(ctx->ui_step);
+
+	UI_STEP(ROTATE_ATTEST_KEY_STEP_CONFIRM) {
+		ui_displayPrompt(
+		        "Rotate attestation",
+		        "key?",
+		        this_fn,
+		        respond_with_user_reject
+		);
+	}
+	UI_STEP(ROTATE_ATTEST_KEY_STEP_RESPOND) {
+		attestKey_rotate();
+
+		io_send_buf(SUCCESS, NULL, 0);
+		ui_idle();
+	}
+	UI_STEP_END(ROTATE_ATTEST_KEY_STEP_INVALID);
+}
+
+void getAttestKeyFingerprint_handleAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        uint8_t* wireDataBuffer MARK_UNUSED,
+        size_t wireDataSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(p1 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_DATA);
+
+	security_policy_t policy = policyForGetAttestKeyFingerprint();
+	ENSURE_NOT_DENIED(policy);
+	ASSERT(policy == POLICY_ALLOW_WITHOUT_PROMPT);
+
+	io_send_buf(SUCCESS, appContext->attestKeyData.fingerprint, SIZEOF(appContext->attestKeyData.fingerprint));
+	ui_idle();
 }
 
 #ifdef DEVEL
@@ -76,7 +272,8 @@ void handleSetAttestKey(
 	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
 	VALIDATE(wireSize == ATTEST_KEY_SIZE, ERR_INVALID_DATA);
 
-	os_memmove(attestKeyData.key, wireBuffer, ATTEST_KEY_SIZE);
+	os_memmove(appContext->attestKeyData.key, wireBuffer, ATTEST_KEY_SIZE);
+	attestKey_updateFingerprint();
 	io_send_buf(SUCCESS, NULL, 0);
 	ui_idle();
 }
@@ -92,7 +289,7 @@ void handleGetAttestKey(
 	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
 	VALIDATE(wireSize == 0, ERR_INVALID_DATA);
 
-	io_send_buf(SUCCESS, attestKeyData.key, ATTEST_KEY_SIZE);
+	io_send_buf(SUCCESS, appContext->attestKeyData.key, ATTEST_KEY_SIZE);
 	ui_idle();
 }
 #endif
@@ -2,26 +2,46 @@
 #define H_CARDANO_APP_ATTEST_KEY
 
 #include "common.h"
+#include "handlers.h"
 
 #ifdef DEVEL
-#include "handlers.h"
 handler_fn_t handleGetAttestKey;
 handler_fn_t handleSetAttestKey;
 #endif
 
+typedef struct {
+	int ui_step;
+} ins_rotate_attest_key_context_t;
+
+handler_fn_t rotateAttestKey_handleAPDU;
+handler_fn_t getAttestKeyFingerprint_handleAPDU;
+
 void attestKey_initialize();
 
+bool attestKey_isPersistent();
+void attestKey_setPersistent(bool isPersistent);
+void attestKey_rotate();
 
-// Note(ppershing): For now we have only one
-// attestation purpose. This code is merely
-// to make sure new potential uses *cannot*
-// be mixed and attestation used in some
-// replay attack
+
+// Note: Purposes make sure different
+// uses *cannot* be mixed and attestation used
+// in some replay attack
 typedef enum {
 	ATTEST_PURPOSE_BIND_UTXO_AMOUNT = 1,
+	ATTEST_PURPOSE_KEY_FINGERPRINT = 2,
 } attest_purpose_t;
 
-static const size_t ATTEST_HMAC_SIZE = 16;
+enum {
+	ATTEST_KEY_SIZE = 32,
+	ATTEST_HMAC_SIZE = 16,
+	ATTEST_KEY_FINGERPRINT_SIZE = 16,
+};
+
+typedef struct {
+	uint8_t key[ATTEST_KEY_SIZE];
+	// Non-secret identifier of the key, see attestKey_updateFingerprint
+	uint8_t fingerprint[ATTEST_KEY_FINGERPRINT_SIZE];
+} attestKeyData_t;
 
 void attest_writeHmac(
         attest_purpose_t purpose,
@@ -35,4 +55,16 @@ bool attest_isCorrectHmac(
         uint8_t* hmac, uint8_t hmacSize
 );
 
+// Verifies a single attestation covering a batch of distinct records.
+// The aggregate is XOR of individual record attestations.
+bool attest_isCorrectAggregateHmac(
+        attest_purpose_t purpose,
+        const uint8_t* records, uint8_t recordSize, uint8_t numRecords,
+        uint8_t* hmac, uint8_t hmacSize
+);
+
+#ifdef DEVEL
+void run_attestKey_test();
+#endif
+
 #endif
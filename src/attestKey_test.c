@@ -0,0 +1,104 @@
+#ifdef DEVEL
+
+#include "attestKey.h"
+#include "state.h"
+#include "storage.h"
+#include "test_utils.h"
+#include "utils.h"
+
+enum {
+	TEST_RECORD_SIZE = 44,
+	TEST_NUM_RECORDS = 3,
+};
+
+static void test_aggregateHmac()
+{
+	PRINTF("test_aggregateHmac\n");
+
+	uint8_t records[TEST_NUM_RECORDS * TEST_RECORD_SIZE];
+	for (size_t i = 0; i < SIZEOF(records); i++) {
+		records[i] = (uint8_t) (i * 7 + 3);
+	}
+
+	uint8_t aggregate[ATTEST_HMAC_SIZE];
+	os_memset(aggregate, 0, SIZEOF(aggregate));
+	for (size_t r = 0; r < TEST_NUM_RECORDS; r++) {
+		uint8_t hmac[ATTEST_HMAC_SIZE];
+		attest_writeHmac(
+		        ATTEST_PURPOSE_BIND_UTXO_AMOUNT,
+		        records + r * TEST_RECORD_SIZE, TEST_RECORD_SIZE,
+		        hmac, SIZEOF(hmac)
+		);
+		EXPECT_EQ(attest_isCorrectHmac(
+		                  ATTEST_PURPOSE_BIND_UTXO_AMOUNT,
+		                  records + r * TEST_RECORD_SIZE, TEST_RECORD_SIZE,
+		                  hmac, SIZEOF(hmac)
+		          ), true);
+		for (size_t i = 0; i < SIZEOF(aggregate); i++) {
+			aggregate[i] ^= hmac[i];
+		}
+	}
+
+	EXPECT_EQ(attest_isCorrectAggregateHmac(
+	                  ATTEST_PURPOSE_BIND_UTXO_AMOUNT,
+	                  records, TEST_RECORD_SIZE, TEST_NUM_RECORDS,
+	                  aggregate, SIZEOF(aggregate)
+	          ), true);
+
+	// Tampered aggregate
+	aggregate[0] ^= 0x01;
+	EXPECT_EQ(attest_isCorrectAggregateHmac(
+	                  ATTEST_PURPOSE_BIND_UTXO_AMOUNT,
+	                  records, TEST_RECORD_SIZE, TEST_NUM_RECORDS,
+	                  aggregate, SIZEOF(aggregate)
+	          ), false);
+	aggregate[0] ^= 0x01;
+
+	// Tampered record
+	records[TEST_RECORD_SIZE + 5] ^= 0x80;
+	EXPECT_EQ(attest_isCorrectAggregateHmac(
+	                  ATTEST_PURPOSE_BIND_UTXO_AMOUNT,
+	                  records, TEST_RECORD_SIZE, TEST_NUM_RECORDS,
+	                  aggregate, SIZEOF(aggregate)
+	          ), false);
+	records[TEST_RECORD_SIZE + 5] ^= 0x80;
+
+	// Duplicate records cancel out in XOR, aggregate of
+	// (A, A) is all zeroes and must not be accepted
+	os_memmove(records + TEST_RECORD_SIZE, records, TEST_RECORD_SIZE);
+	os_memset(aggregate, 0, SIZEOF(aggregate));
+	EXPECT_EQ(attest_isCorrectAggregateHmac(
+	                  ATTEST_PURPOSE_BIND_UTXO_AMOUNT,
+	                  records, TEST_RECORD_SIZE, 2,
+	                  aggregate, SIZEOF(aggregate)
+	          ), false);
+}
+
+static void test_rotatePersistentKey()
+{
+	PRINTF("test_rotatePersistentKey\n");
+
+	const bool wasPersistent = attestKey_isPersistent();
+	attestKey_setPersistent(true);
+
+	uint8_t storedKey[ATTEST_KEY_SIZE];
+	storage_readAttestKey(storedKey, SIZEOF(storedKey));
+	attestKey_rotate();
+	EXPECT_EQ(attestKey_isPersistent(), true);
+
+	uint8_t rotatedKey[ATTEST_KEY_SIZE];
+	storage_readAttestKey(rotatedKey, SIZEOF(rotatedKey));
+	EXPECT_EQ_BYTES(rotatedKey, appContext->attestKeyData.key, ATTEST_KEY_SIZE);
+	const bool isChanged = os_memcmp(rotatedKey, storedKey, ATTEST_KEY_SIZE) != 0;
+	EXPECT_EQ(isChanged, true);
+
+	attestKey_setPersistent(wasPersistent);
+}
+
+void run_attestKey_test()
+{
+	test_aggregateHmac();
+	test_rotatePersistentKey();
+}
+
+#endif
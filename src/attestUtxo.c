@@ -10,11 +10,14 @@
 #include "cardano.h"
 #include "securityPolicy.h"
 #include "uiHelpers.h"
+#include "trace.h"
+
+#define TRACE_MODULE ATTEST_UTXO
 
 static void parser_advanceMainState(attest_utxo_parser_state_t *state);
 
 
-static ins_attest_utxo_context_t* ctx = &(instructionState.attestUtxoContext);
+#define ctx (&appContext->instructionState.attestUtxoContext)
 static const uint16_t ATTEST_INIT_MAGIC = 4547;
 static const uint16_t ATTEST_PARSER_INIT_MAGIC = 4647;
 
@@ -59,7 +62,7 @@ static void parser_advanceInputState(attest_utxo_parser_state_t* state)
 // Sidenote: PARSER_BEGIN && PARSER_END have unmatched braces. This is a intended as
 // it forces reasonable indentation
 #define PARSER_BEGIN switch (state->inputState) { case INPUT_PARSING_NOT_STARTED:
-#define PARSER_END   default: ASSERT(false); }
+#define PARSER_END   break; default: ASSERT(false); }
 #define TRANSITION_TO(NEXT_STATE) state->inputState = NEXT_STATE; break; case NEXT_STATE:
 
 	// Array(2)[
@@ -115,7 +118,7 @@ static void parser_advanceOutputState(attest_utxo_parser_state_t* state)
 
 // Note(ppershing): see note above for parser macros
 #define PARSER_BEGIN switch (state->outputState) { case OUTPUT_PARSING_NOT_STARTED:
-#define PARSER_END   default: ASSERT(false); }
+#define PARSER_END   break; default: ASSERT(false); }
 #define TRANSITION_TO(NEXT_STATE) state->outputState = NEXT_STATE; break; case NEXT_STATE:
 
 	// Array(2)[
@@ -188,7 +191,7 @@ static void parser_advanceMainState(attest_utxo_parser_state_t *state)
 	stream_t* stream = &(state->stream); // shorthand
 // Note(ppershing): see note above for parser macros
 #define PARSER_BEGIN switch (state->mainState) { case MAIN_PARSING_NOT_STARTED:
-#define PARSER_END   default: ASSERT(false); }
+#define PARSER_END   break; default: ASSERT(false); }
 #define TRANSITION_TO(NEXT_STATE) state->mainState = NEXT_STATE; break; case NEXT_STATE:
 #define JUMP(NEXT_STATE) state->mainState = NEXT_STATE; break;
 
@@ -292,10 +295,9 @@ void parser_keepParsing(attest_utxo_parser_state_t* state)
 	ASSERT(state->parserInitializedMagic == ATTEST_PARSER_INIT_MAGIC);
 
 	while(state -> mainState != MAIN_FINISHED) {
-		TRACE();
+		TRACE_EVENT(TRACE_LEVEL_DEBUG, state->mainState, stream_availableBytes(&state->stream));
 		parser_advanceMainState(state);
 	}
-	TRACE();
 }
 
 
@@ -363,9 +365,7 @@ void attestUtxo_handleInitAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireD
 		ctx->initializedMagic = ATTEST_INIT_MAGIC;
 	}
 
-	TRACE("io");
 	io_send_buf(SUCCESS, NULL, 0);
-	TRACE("done");
 	ui_displayBusy();
 };
 
@@ -376,14 +376,11 @@ void attestUtxo_handleDataAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireD
 
 	BEGIN_TRY {
 		TRY {
-			TRACE();
+			TRACE_EVENT(TRACE_LEVEL_INFO, wireDataSize, ctx->parserState.mainState);
 			stream_appendData(&ctx->parserState.stream, wireDataBuffer, wireDataSize);
-			TRACE();
 			blake2b_256_append(&ctx->txHashCtx, wireDataBuffer, wireDataSize);
-			TRACE();
 			parser_keepParsing(&ctx->parserState);
 
-			TRACE();
 			ASSERT(ctx->parserState.mainState == MAIN_FINISHED);
 			// We should not have any data left
 			VALIDATE(stream_availableBytes(&ctx->parserState.stream) == 0, ERR_INVALID_DATA);
@@ -393,14 +390,13 @@ void attestUtxo_handleDataAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireD
 		CATCH(ERR_NOT_ENOUGH_INPUT)
 		{
 			// Respond that we need more data
-			TRACE("io");
+			TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->parserState.mainState, 0);
 			io_send_buf(SUCCESS, NULL, 0);
-			TRACE("done");
 			// Note(ppershing): no ui_idle() as we continue exchange...
 		}
 		CATCH(ERR_UNEXPECTED_TOKEN)
 		{
-			TRACE();
+			TRACE_EVENT(TRACE_LEVEL_INFO, ctx->parserState.mainState, 0);
 			// Convert to ERR_INVALID_DATA
 			THROW(ERR_INVALID_DATA);
 		}
@@ -420,7 +416,7 @@ void attestUTxO_handleAPDU(
         bool isNewCall
 )
 {
-	TRACE("P1: %d", (int) p1);
+	TRACE_EVENT(TRACE_LEVEL_INFO, p1, isNewCall);
 	enum {
 		P1_INIT = 0x01,
 		P1_DATA = 0x02,
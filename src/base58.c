@@ -19,8 +19,9 @@
 
 #include "common.h"
 #include "base58.h"
+#include "profiling.h"
 
-static const uint32_t MAX_BUFFER_SIZE = 124;
+static const uint32_t MAX_BUFFER_SIZE = BASE58_MAX_INPUT_SIZE;
 
 static const char BASE58ALPHABET[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
@@ -37,6 +38,7 @@ size_t encode_base58(
 	ASSERT(inSize <= SIZEOF(tmpBuffer));
 	ASSERT(outMaxSize < BUFFER_SIZE_PARANOIA);
 
+	PROFILING_BEGIN();
 	os_memmove(tmpBuffer, inBuffer, inSize);
 
 	while ((zeroCount < inSize) && (tmpBuffer[zeroCount] == 0)) {
@@ -73,5 +75,6 @@ size_t encode_base58(
 
 	os_memmove(outStr, (buffer + j), outSize);
 	outStr[outSize] = 0;
+	PROFILING_END(PROFILING_SITE_BASE58);
 	return outSize;
 }
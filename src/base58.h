@@ -4,6 +4,10 @@
 #include <stdint.h>
 #include <stddef.h>
 
+enum {
+	BASE58_MAX_INPUT_SIZE = 124,
+};
+
 size_t encode_base58(
         const uint8_t *inBuffer, size_t inSize,
         char *outStr, size_t outMaxSize
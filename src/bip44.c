@@ -37,6 +37,16 @@ bool isHardened(uint32_t value)
 	return value == (value | HARDENED_BIP32);
 }
 
+bool bip44_isEqual(const bip44_path_t* path1, const bip44_path_t* path2)
+{
+	if (path1->length != path2->length) return false;
+	ASSERT(path1->length <= ARRAY_LEN(path1->path));
+	for (size_t i = 0; i < path1->length; i++) {
+		if (path1->path[i] != path2->path[i]) return false;
+	}
+	return true;
+}
+
 bool bip44_hasValidCardanoPrefix(const bip44_path_t* pathSpec)
 {
 #define CHECK(cond) if (!(cond)) return false
@@ -148,7 +158,7 @@ void bip44_printToStr(const bip44_path_t* pathSpec, char* out, size_t outSize)
 
 	WRITE("m");
 
-	ASSERT(pathSpec->length < ARRAY_LEN(pathSpec->path));
+	ASSERT(pathSpec->length <= ARRAY_LEN(pathSpec->path));
 
 	for (size_t i = 0; i < pathSpec->length; i++) {
 		uint32_t value = pathSpec->path[i];
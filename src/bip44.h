@@ -3,7 +3,12 @@
 
 #include "common.h"
 
-static const uint32_t BIP44_MAX_PATH_LENGTH = 10;
+enum {
+	BIP44_MAX_PATH_LENGTH = 10,
+	// "m", "/2147483647'" per item and the terminating null
+	// (plus one byte bip44_printToStr keeps free)
+	BIP44_PATH_STRING_SIZE = 1 + BIP44_MAX_PATH_LENGTH * 12 + 1 + 1,
+};
 
 typedef struct {
 	uint32_t path[BIP44_MAX_PATH_LENGTH];
@@ -48,6 +53,8 @@ bool bip44_containsMoreThanAddress(const bip44_path_t* pathSpec);
 
 bool isHardened(uint32_t value);
 
+bool bip44_isEqual(const bip44_path_t* path1, const bip44_path_t* path2);
+
 void bip44_printToStr(const bip44_path_t*, char* out, size_t outSize);
 
 #endif
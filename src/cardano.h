@@ -22,7 +22,20 @@ enum {
 static const uint64_t LOVELACE_MAX_SUPPLY = __CONCAT4(45, 000, 000, 000) * 1000000;
 static const uint64_t LOVELACE_INVALID =    __CONCAT4(47, 000, 000, 000) * 1000000;
 
+// Note: gcc (host build) does not fold static consts in constant expressions
+#ifdef __clang__
 STATIC_ASSERT(LOVELACE_MAX_SUPPLY < LOVELACE_INVALID, "bad LOVELACE_INVALID");
+#endif
+
+// Protocol parameters, see Byron genesis
+enum {
+	// Maximum size of a signed transaction
+	CARDANO_MAX_TX_SIZE = 4096,
+	// Linear fee: minFee = FEE_CONSTANT + FEE_PER_BYTE * txSize
+	CARDANO_FEE_CONSTANT = 155381,
+	// Note: per-byte coefficient 43.946 expressed in thousandths
+	CARDANO_FEE_PER_BYTE_MILLI = 43946,
+};
 
 
 #endif
@@ -0,0 +1,275 @@
+#include "common.h"
+#include "cborValidator.h"
+#include "cbor.h"
+
+enum {
+	AI_WIDTH_1 = 24,
+	AI_WIDTH_2 = 25,
+	AI_WIDTH_4 = 26,
+	AI_WIDTH_8 = 27,
+
+	// simple values below this must use the short form
+	SIMPLE_VALUE_MIN_W1 = 32,
+};
+
+void cborValidator_init(cbor_validator_t* validator)
+{
+	os_memset(validator, 0, SIZEOF(*validator));
+	validator->state = CBOR_VALIDATOR_EXPECT_HEADER;
+}
+
+bool cborValidator_isFinished(const cbor_validator_t* validator)
+{
+	return validator->state == CBOR_VALIDATOR_FINISHED;
+}
+
+static void cborValidator_push(
+        cbor_validator_t* validator,
+        cbor_validator_frame_type_t type, uint32_t count, uint8_t stringMajorType
+)
+{
+	VALIDATE(validator->depth < CBOR_VALIDATOR_MAX_DEPTH, ERR_INVALID_DATA);
+
+	cbor_validator_frame_t* frame = &validator->stack[validator->depth];
+	frame->type = (uint8_t) type;
+	frame->count = count;
+	frame->stringMajorType = stringMajorType;
+	validator->depth++;
+}
+
+// Called whenever a whole data item was read
+static void cborValidator_completeItem(cbor_validator_t* validator)
+{
+	validator->isAfterTag = false;
+	validator->state = CBOR_VALIDATOR_EXPECT_HEADER;
+
+	while (validator->depth > 0) {
+		cbor_validator_frame_t* frame = &validator->stack[validator->depth - 1];
+		if (frame->type != CBOR_FRAME_DEFINITE) {
+			frame->count++;
+			return;
+		}
+		ASSERT(frame->count > 0);
+		frame->count--;
+		if (frame->count > 0) return;
+		// container complete, it is an item of its parent
+		validator->depth--;
+	}
+	// top-level item complete
+	validator->state = CBOR_VALIDATOR_FINISHED;
+}
+
+static void cborValidator_processBreak(cbor_validator_t* validator)
+{
+	VALIDATE(validator->depth > 0, ERR_INVALID_DATA);
+	VALIDATE(!validator->isAfterTag, ERR_INVALID_DATA);
+
+	cbor_validator_frame_t* frame = &validator->stack[validator->depth - 1];
+	VALIDATE(frame->type != CBOR_FRAME_DEFINITE, ERR_INVALID_DATA);
+	if (frame->type == CBOR_FRAME_INDEF_MAP) {
+		// keys and values must come in pairs
+		VALIDATE(frame->count % 2 == 0, ERR_INVALID_DATA);
+	}
+	validator->depth--;
+	cborValidator_completeItem(validator);
+}
+
+static void cborValidator_processHeader(cbor_validator_t* validator)
+{
+	const uint8_t majorType = validator->header >> 5;
+	const uint8_t ai = validator->header & CBOR_VALUE_MASK;
+	const bool isIndef = (ai == CBOR_INDEF);
+	const uint64_t value = validator->argument;
+
+	if (validator->header == CBOR_TYPE_INDEF_END) {
+		cborValidator_processBreak(validator);
+		return;
+	}
+
+	if (validator->depth > 0) {
+		const cbor_validator_frame_t* frame = &validator->stack[validator->depth - 1];
+		if (frame->type == CBOR_FRAME_INDEF_STRING) {
+			// Only definite chunks of the same type are allowed
+			VALIDATE(majorType == frame->stringMajorType, ERR_INVALID_DATA);
+			VALIDATE(!isIndef, ERR_INVALID_DATA);
+		}
+	}
+
+	switch (majorType) {
+	case CBOR_MT_UNSIGNED:
+	case CBOR_MT_NEGATIVE:
+		cborValidator_completeItem(validator);
+		break;
+
+	case CBOR_MT_BYTES:
+	case CBOR_MT_TEXT:
+		if (isIndef) {
+			cborValidator_push(validator, CBOR_FRAME_INDEF_STRING, 0, majorType);
+			validator->isAfterTag = false;
+		} else if (value == 0) {
+			cborValidator_completeItem(validator);
+		} else {
+			validator->stringBytesLeft = value;
+			validator->state = CBOR_VALIDATOR_IN_STRING;
+		}
+		break;
+
+	case CBOR_MT_ARRAY:
+	case CBOR_MT_MAP: {
+		const bool isMap = (majorType == CBOR_MT_MAP);
+		if (isIndef) {
+			cborValidator_push(
+			        validator,
+			        isMap ? CBOR_FRAME_INDEF_MAP : CBOR_FRAME_INDEF_ARRAY,
+			        0, 0
+			);
+			validator->isAfterTag = false;
+		} else if (value == 0) {
+			cborValidator_completeItem(validator);
+		} else {
+			// Note: such counts could never fit into a transaction anyway
+			VALIDATE(value <= UINT32_MAX / 2, ERR_INVALID_DATA);
+			cborValidator_push(
+			        validator,
+			        CBOR_FRAME_DEFINITE,
+			        (uint32_t) (isMap ? 2 * value : value),
+			        0
+			);
+			validator->isAfterTag = false;
+		}
+		break;
+	}
+
+	case CBOR_MT_TAG:
+		// Tag content follows
+		validator->isAfterTag = true;
+		break;
+
+	case CBOR_MT_PRIMITIVES:
+		if (ai == AI_WIDTH_1) {
+			VALIDATE(value >= SIMPLE_VALUE_MIN_W1, ERR_INVALID_DATA);
+		}
+		// simple values and floats
+		cborValidator_completeItem(validator);
+		break;
+
+	default:
+		ASSERT(false);
+	}
+}
+
+// Returns number of argument bytes following the initial byte
+static uint8_t cborValidator_argumentWidth(uint8_t header)
+{
+	const uint8_t majorType = header >> 5;
+	const uint8_t ai = header & CBOR_VALUE_MASK;
+
+	if (ai < AI_WIDTH_1) return 0;
+
+	switch (ai) {
+	case AI_WIDTH_1:
+		return 1;
+	case AI_WIDTH_2:
+		return 2;
+	case AI_WIDTH_4:
+		return 4;
+	case AI_WIDTH_8:
+		return 8;
+	case CBOR_INDEF:
+		switch (majorType) {
+		case CBOR_MT_BYTES:
+		case CBOR_MT_TEXT:
+		case CBOR_MT_ARRAY:
+		case CBOR_MT_MAP:
+		case CBOR_MT_PRIMITIVES:
+			return 0;
+		default:
+			THROW(ERR_INVALID_DATA);
+		}
+	default:
+		// reserved values 28-30
+		THROW(ERR_INVALID_DATA);
+	}
+}
+
+// Same canonical encoding requirement as in cbor_parseToken
+static void cborValidator_checkCanonical(uint8_t header, uint64_t value)
+{
+	const uint8_t majorType = header >> 5;
+	const uint8_t ai = header & CBOR_VALUE_MASK;
+
+	// Note: floats have fixed widths, simple values are checked separately
+	if (majorType == CBOR_MT_PRIMITIVES) return;
+
+	switch (ai) {
+	case AI_WIDTH_1:
+		VALIDATE(value >= 24, ERR_INVALID_DATA);
+		break;
+	case AI_WIDTH_2:
+		VALIDATE(value >= ((uint64_t) 1 << 8), ERR_INVALID_DATA);
+		break;
+	case AI_WIDTH_4:
+		VALIDATE(value >= ((uint64_t) 1 << 16), ERR_INVALID_DATA);
+		break;
+	case AI_WIDTH_8:
+		VALIDATE(value >= ((uint64_t) 1 << 32), ERR_INVALID_DATA);
+		break;
+	default:
+		break;
+	}
+}
+
+void cborValidator_feed(cbor_validator_t* validator, const uint8_t* buffer, size_t bufferSize)
+{
+	ASSERT(bufferSize < BUFFER_SIZE_PARANOIA);
+
+	const uint8_t* ptr = buffer;
+	const uint8_t* end = buffer + bufferSize;
+
+	while (ptr < end) {
+		switch (validator->state) {
+		case CBOR_VALIDATOR_EXPECT_HEADER: {
+			validator->header = *ptr++;
+			validator->argumentBytesLeft = cborValidator_argumentWidth(validator->header);
+			if (validator->argumentBytesLeft == 0) {
+				const uint8_t ai = validator->header & CBOR_VALUE_MASK;
+				validator->argument = (ai == CBOR_INDEF) ? 0 : ai;
+				cborValidator_processHeader(validator);
+			} else {
+				validator->argument = 0;
+				validator->state = CBOR_VALIDATOR_IN_ARGUMENT;
+			}
+			break;
+		}
+		case CBOR_VALIDATOR_IN_ARGUMENT: {
+			ASSERT(validator->argumentBytesLeft > 0);
+			validator->argument = (validator->argument << 8) | *ptr++;
+			validator->argumentBytesLeft--;
+			if (validator->argumentBytesLeft == 0) {
+				cborValidator_checkCanonical(validator->header, validator->argument);
+				validator->state = CBOR_VALIDATOR_EXPECT_HEADER;
+				cborValidator_processHeader(validator);
+			}
+			break;
+		}
+		case CBOR_VALIDATOR_IN_STRING: {
+			// Skip the payload in bulk
+			size_t available = end - ptr;
+			size_t skip = (validator->stringBytesLeft < available)
+			              ? (size_t) validator->stringBytesLeft
+			              : available;
+			ptr += skip;
+			validator->stringBytesLeft -= skip;
+			if (validator->stringBytesLeft == 0) {
+				cborValidator_completeItem(validator);
+			}
+			break;
+		}
+		case CBOR_VALIDATOR_FINISHED:
+			// Trailing data
+			THROW(ERR_INVALID_DATA);
+		default:
+			ASSERT(false);
+		}
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef H_CARDANO_APP_CBOR_VALIDATOR
+#define H_CARDANO_APP_CBOR_VALIDATOR
+
+#include "common.h"
+
+// Incremental well-formedness check of a single CBOR data item.
+// Data may be fed in arbitrary chunks, the validator keeps only
+// constant-size state (nesting is bounded by CBOR_VALIDATOR_MAX_DEPTH).
+
+enum {
+	CBOR_VALIDATOR_MAX_DEPTH = 16,
+};
+
+typedef enum {
+	CBOR_VALIDATOR_EXPECT_HEADER = 1,
+	CBOR_VALIDATOR_IN_ARGUMENT = 2,
+	CBOR_VALIDATOR_IN_STRING = 3,
+	CBOR_VALIDATOR_FINISHED = 4,
+} cbor_validator_state_t;
+
+typedef enum {
+	CBOR_FRAME_DEFINITE = 1,
+	CBOR_FRAME_INDEF_ARRAY = 2,
+	CBOR_FRAME_INDEF_MAP = 3,
+	CBOR_FRAME_INDEF_STRING = 4,
+} cbor_validator_frame_type_t;
+
+typedef struct {
+	// For definite frames number of items still expected,
+	// for indefinite frames number of items seen so far
+	uint32_t count;
+	uint8_t type;
+	// Major type of the chunks for indefinite strings
+	uint8_t stringMajorType;
+} cbor_validator_frame_t;
+
+typedef struct {
+	cbor_validator_state_t state;
+
+	// Header being parsed
+	uint8_t header;
+	uint8_t argumentBytesLeft;
+	uint64_t argument;
+
+	// String payload still to be skipped
+	uint64_t stringBytesLeft;
+
+	// Tag was read and its content did not start yet
+	bool isAfterTag;
+
+	uint8_t depth;
+	cbor_validator_frame_t stack[CBOR_VALIDATOR_MAX_DEPTH];
+} cbor_validator_t;
+
+void cborValidator_init(cbor_validator_t* validator);
+
+// Throws ERR_INVALID_DATA on malformed data
+// or data following the (finished) top-level item
+void cborValidator_feed(cbor_validator_t* validator, const uint8_t* buffer, size_t bufferSize);
+
+bool cborValidator_isFinished(const cbor_validator_t* validator);
+
+#ifdef DEVEL
+void run_cborValidator_test();
+#endif
+
+#endif
@@ -0,0 +1,119 @@
+#ifdef DEVEL
+
+#include "cborValidator.h"
+#include "hex_utils.h"
+#include "test_utils.h"
+
+// Feeds the data in chunks of given size
+static void feedInChunks(
+        cbor_validator_t* validator,
+        const uint8_t* buffer, size_t bufferSize,
+        size_t chunkSize
+)
+{
+	for (size_t i = 0; i < bufferSize; i += chunkSize) {
+		size_t size = (chunkSize < bufferSize - i) ? chunkSize : bufferSize - i;
+		cborValidator_feed(validator, buffer + i, size);
+	}
+}
+
+static void testcase_valid(const char* hex)
+{
+	PRINTF("testcase_valid %s\n", hex);
+	uint8_t buffer[100];
+	size_t bufferSize = parseHexString(hex, buffer, SIZEOF(buffer));
+
+	const size_t chunkSizes[] = {1, 2, 3, bufferSize};
+	ITERATE(it, chunkSizes) {
+		cbor_validator_t validator;
+		cborValidator_init(&validator);
+		feedInChunks(&validator, buffer, bufferSize, *it);
+		EXPECT_EQ(cborValidator_isFinished(&validator), true);
+	}
+}
+
+static void testcase_invalid(const char* hex)
+{
+	PRINTF("testcase_invalid %s\n", hex);
+	uint8_t buffer[100];
+	size_t bufferSize = parseHexString(hex, buffer, SIZEOF(buffer));
+
+	cbor_validator_t validator;
+	cborValidator_init(&validator);
+	EXPECT_THROWS(cborValidator_feed(&validator, buffer, bufferSize), ERR_INVALID_DATA);
+}
+
+static void testcase_incomplete(const char* hex)
+{
+	PRINTF("testcase_incomplete %s\n", hex);
+	uint8_t buffer[100];
+	size_t bufferSize = parseHexString(hex, buffer, SIZEOF(buffer));
+
+	cbor_validator_t validator;
+	cborValidator_init(&validator);
+	cborValidator_feed(&validator, buffer, bufferSize);
+	EXPECT_EQ(cborValidator_isFinished(&validator), false);
+}
+
+void run_cborValidator_test()
+{
+	// empty map (default tx attributes)
+	testcase_valid("A0");
+	testcase_valid("A10102");
+	testcase_valid("A20143010203029F0102FF");
+	// indefinite map
+	testcase_valid("BF0102FF");
+	// indefinite byte / text strings
+	testcase_valid("5F4100420102FF");
+	testcase_valid("7F6161FF");
+	// tags
+	testcase_valid("D81843A00102");
+	testcase_valid("C1C11A514B67B0");
+	// simple values & floats
+	testcase_valid("F6");
+	testcase_valid("F820");
+	testcase_valid("FB3FF0000000000000");
+	// negative
+	testcase_valid("3818");
+	// nesting
+	testcase_valid("A1018181818100");
+	testcase_valid("81818181818181818181818181818100");
+	// long string
+	testcase_valid("5820000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F");
+
+	// odd number of items in indefinite map
+	testcase_invalid("BF01FF");
+	// break outside of indefinite container
+	testcase_invalid("FF");
+	testcase_invalid("8101FF");
+	// break right after tag
+	testcase_invalid("9FC1FF");
+	// wrong chunk types in indefinite strings
+	testcase_invalid("5F01FF");
+	testcase_invalid("5F6161FF");
+	testcase_invalid("5F5F4100FFFF");
+	// non-canonical lengths
+	testcase_invalid("1817");
+	testcase_invalid("590001");
+	// reserved additional info
+	testcase_invalid("1C");
+	testcase_invalid("FC");
+	// indefinite length integer / tag
+	testcase_invalid("1F");
+	testcase_invalid("DF");
+	// simple value in two-byte form below 32
+	testcase_invalid("F810");
+	// trailing data
+	testcase_invalid("A000");
+	// too deep
+	testcase_invalid("8181818181818181818181818181818181");
+
+	testcase_incomplete("");
+	testcase_incomplete("A101");
+	testcase_incomplete("9F01");
+	testcase_incomplete("4301");
+	testcase_incomplete("19");
+	testcase_incomplete("C1");
+}
+
+#endif
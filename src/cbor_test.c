@@ -9,7 +9,7 @@
 #include "state.h"
 #include "utils.h"
 
-static ins_tests_context_t* ctx = &(instructionState.testsContext);
+#define ctx (&appContext->instructionState.testsContext)
 
 // Test vectors are taken from
 // https://tools.ietf.org/html/rfc7049#appendix-A
@@ -66,6 +66,14 @@ static void test_cbor_peek_token()
 
 }
 
+static void testcase_cbor_parse_noncanonical(const char* hex)
+{
+	PRINTF("test_cbor_parse_noncanonical %s\n", hex);
+	stream_init(& ctx->s);
+	stream_appendFromHexString(& ctx->s, hex);
+	EXPECT_THROWS(cbor_peekToken(& ctx->s), ERR_UNEXPECTED_TOKEN);
+}
+
 // test whether we reject non-canonical serialization
 static void test_cbor_parse_noncanonical()
 {
@@ -86,10 +94,7 @@ static void test_cbor_parse_noncanonical()
 	};
 
 	ITERATE(it, testVectors) {
-		PRINTF("test_cbor_parse_noncanonical %s\n", PTR_PIC(it->hex));
-		stream_init(& ctx->s);
-		stream_appendFromHexString(& ctx->s, PTR_PIC(it->hex));
-		EXPECT_THROWS(cbor_peekToken(& ctx->s), ERR_UNEXPECTED_TOKEN);
+		testcase_cbor_parse_noncanonical(PTR_PIC(it->hex));
 	}
 }
 
@@ -3,13 +3,17 @@
 
 // Code taken from: https://www.hackersdelight.org/hdcodetxt/crc.c.txt option crc32b
 
-uint32_t crc32(const uint8_t* inBuffer, size_t inSize)
+uint32_t crc32_init()
+{
+	return 0xFFFFFFFF;
+}
+
+uint32_t crc32_update(uint32_t crc, const uint8_t* inBuffer, size_t inSize)
 {
 	ASSERT(inSize < BUFFER_SIZE_PARANOIA);
 
-	uint32_t byte, crc, mask;
+	uint32_t byte, mask;
 
-	crc = 0xFFFFFFFF;
 	for(size_t i = 0; i < inSize; i++) {
 		byte = inBuffer[i];
 		crc = crc ^ byte;
@@ -20,5 +24,15 @@ uint32_t crc32(const uint8_t* inBuffer, size_t inSize)
 		}
 	}
 
+	return crc;
+}
+
+uint32_t crc32_finalize(uint32_t crc)
+{
 	return ~crc;
 }
+
+uint32_t crc32(const uint8_t* inBuffer, size_t inSize)
+{
+	return crc32_finalize(crc32_update(crc32_init(), inBuffer, inSize));
+}
@@ -5,5 +5,11 @@
 
 uint32_t crc32(const uint8_t* inBuffer, size_t inSize);
 
+// Incremental computation, crc32(data) is equal to
+// crc32_finalize(crc32_update(crc32_init(), data))
+uint32_t crc32_init();
+uint32_t crc32_update(uint32_t crc, const uint8_t* inBuffer, size_t inSize);
+uint32_t crc32_finalize(uint32_t crc);
+
 void run_crc32_test();
 #endif
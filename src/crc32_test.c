@@ -35,6 +35,13 @@ void run_crc32_test()
 		uint32_t result = crc32(buffer, bufferSize);
 
 		EXPECT_EQ(result, it->expected);
+
+		// byte-by-byte
+		uint32_t crc = crc32_init();
+		for (size_t i = 0; i < bufferSize; i++) {
+			crc = crc32_update(crc, buffer + i, 1);
+		}
+		EXPECT_EQ(crc32_finalize(crc), it->expected);
 	}
 }
 
@@ -10,7 +10,7 @@
 
 static uint16_t RESPONSE_READY_MAGIC = 11223;
 
-static ins_derive_address_context_t* ctx = &(instructionState.deriveAddressContext);
+#define ctx (&appContext->instructionState.deriveAddressContext)
 
 enum {
 	P1_RETURN  = 0x01,
@@ -80,7 +80,7 @@ static void deriveAddress_return_ui_runStep()
 	}
 	UI_STEP(RETURN_UI_STEP_PATH) {
 		// Response
-		char pathStr[100];
+		char pathStr[6 + BIP44_PATH_STRING_SIZE];
 		{
 			const char* prefix = "Path: ";
 			size_t len = strlen(prefix);
@@ -181,7 +181,7 @@ static void deriveAddress_display_ui_runStep()
 	}
 	UI_STEP(DISPLAY_UI_STEP_PATH) {
 		// Response
-		char pathStr[100];
+		char pathStr[BIP44_PATH_STRING_SIZE];
 		bip44_printToStr(&ctx->pathSpec, pathStr, SIZEOF(pathStr));
 		ui_displayPaginatedText(
 		        "Address path",
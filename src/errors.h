@@ -36,8 +36,11 @@ enum {
 	// Pin screen
 	ERR_DEVICE_LOCKED              = 0x6E11,
 
+	// Transaction would exceed maximum transaction size
+	ERR_TX_TOO_LARGE               = 0x6E12,
+
 	// end of errors which trigger automatic response
-	_ERR_AUTORESPOND_END           = 0x6E12,
+	_ERR_AUTORESPOND_END           = 0x6E13,
 
 	// Errors below SHOULD NOT be returned to the client
 	// Instead, leaking these to the main() scope
@@ -0,0 +1,133 @@
+#include "common.h"
+#include "flightRecorder.h"
+#include "state.h"
+#include "storage.h"
+#include "endian.h"
+
+enum {
+	FLIGHT_RECORD_WIRE_SIZE = 9,
+	FLIGHT_RECORDER_WIRE_SIZE = 4 + 1 + FLIGHT_RECORDER_SIZE * FLIGHT_RECORD_WIRE_SIZE,
+};
+
+STATIC_ASSERT((int) FLIGHT_RECORDER_WIRE_SIZE <= (int) STORAGE_CRASH_RECORD_CAPACITY, "bad crash record capacity");
+
+static flight_record_t* flightRecorder_last()
+{
+	flightRecorderState_t* state = &appContext->flightRecorder;
+	if (state->numRequests == 0) return NULL;
+	return &state->records[(state->numRequests - 1) % FLIGHT_RECORDER_SIZE];
+}
+
+void flightRecorder_recordRequest(const uint8_t* apdu, size_t apduSize)
+{
+	flightRecorderState_t* state = &appContext->flightRecorder;
+	flight_record_t* record = &state->records[state->numRequests % FLIGHT_RECORDER_SIZE];
+	state->numRequests++;
+	state->requestTicks = io_getTickerCount();
+
+	os_memset(record, 0, SIZEOF(*record));
+	// Note: unchecked APDU, missing header bytes stay zero
+	// and the payload is never recorded
+	if (apduSize > 1) record->ins = apdu[1];
+	if (apduSize > 2) record->p1 = apdu[2];
+	if (apduSize > 3) record->p2 = apdu[3];
+	if (apduSize > 4) record->lc = apdu[4];
+	record->stage = FLIGHT_STAGE_RECEIVED;
+}
+
+void flightRecorder_setStage(flight_stage_t stage)
+{
+	flight_record_t* record = flightRecorder_last();
+	if (record == NULL) return;
+	record->stage = (uint8_t) stage;
+}
+
+void flightRecorder_recordStatus(uint16_t status)
+{
+	flight_record_t* record = flightRecorder_last();
+	// A single status per request
+	if (record == NULL || record->status != 0) return;
+
+	record->status = status;
+	const uint32_t ticks = io_getTickerCount() - appContext->flightRecorder.requestTicks;
+	record->ticks = (ticks > UINT16_MAX) ? UINT16_MAX : (uint16_t) ticks;
+	if (record->stage == FLIGHT_STAGE_RETURNED) {
+		record->stage = FLIGHT_STAGE_UI;
+	}
+}
+
+// Oldest records first
+static size_t flightRecorder_serialize(uint8_t* out, size_t outSize)
+{
+	ASSERT(outSize >= FLIGHT_RECORDER_WIRE_SIZE);
+	const flightRecorderState_t* state = &appContext->flightRecorder;
+
+	const uint8_t count = (state->numRequests < FLIGHT_RECORDER_SIZE)
+	                      ? (uint8_t) state->numRequests
+	                      : FLIGHT_RECORDER_SIZE;
+	u4be_write(out, state->numRequests);
+	out[4] = count;
+	size_t size = 5;
+	for (uint32_t i = state->numRequests - count; i < state->numRequests; i++) {
+		const flight_record_t* record = &state->records[i % FLIGHT_RECORDER_SIZE];
+		out[size++] = record->ins;
+		out[size++] = record->p1;
+		out[size++] = record->p2;
+		out[size++] = record->lc;
+		out[size++] = record->stage;
+		u2be_write(out + size, record->status);
+		u2be_write(out + size + 2, record->ticks);
+		size += 4;
+	}
+	ASSERT(size <= FLIGHT_RECORDER_WIRE_SIZE);
+	return size;
+}
+
+void flightRecorder_saveCrash()
+{
+	uint8_t buffer[FLIGHT_RECORDER_WIRE_SIZE];
+	const size_t size = flightRecorder_serialize(buffer, SIZEOF(buffer));
+	storage_writeCrashRecord(buffer, size);
+}
+
+enum {
+	P1_GET = 0x01,
+	P1_GET_CRASH = 0x02,
+	P1_CLEAR_CRASH = 0x03,
+};
+
+static const uint8_t P2_UNUSED = 0x00;
+
+void flightRecorder_handleAPDU(
+        uint8_t p1, uint8_t p2,
+        uint8_t* wireBuffer MARK_UNUSED, size_t wireSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireSize == 0, ERR_INVALID_DATA);
+
+	uint8_t response[STORAGE_CRASH_RECORD_CAPACITY];
+	size_t responseSize = 0;
+
+	switch (p1) {
+	case P1_GET:
+		responseSize = flightRecorder_serialize(response, SIZEOF(response));
+		break;
+
+	case P1_GET_CRASH:
+		// Empty if there was no crash
+		responseSize = storage_readCrashRecord(response, SIZEOF(response));
+		break;
+
+	case P1_CLEAR_CRASH:
+		storage_clearCrashRecord();
+		break;
+
+	default:
+		THROW(ERR_INVALID_REQUEST_PARAMETERS);
+	}
+
+	io_send_buf(SUCCESS, response, responseSize);
+	ui_idle();
+}
@@ -0,0 +1,62 @@
+#ifndef H_CARDANO_APP_FLIGHT_RECORDER
+#define H_CARDANO_APP_FLIGHT_RECORDER
+
+#include "common.h"
+#include "handlers.h"
+
+// Headers (no payloads), status words, dispatch stages and elapsed ticks
+// of the last APDUs, kept by the main loop. A crash (an exception that is
+// not sent as a response, e.g. an assertion) saves them to NVRAM.
+// Read through INS 0x02, available in production builds.
+
+enum {
+	FLIGHT_RECORDER_SIZE = 8,
+};
+
+// How far the main loop got with the APDU
+typedef enum {
+	// Rejected before the handler was called (e.g. bad header or
+	// ERR_STILL_IN_CALL)
+	FLIGHT_STAGE_RECEIVED = 1,
+	// The handler threw (or has not returned yet)
+	FLIGHT_STAGE_HANDLER = 2,
+	FLIGHT_STAGE_RETURNED = 3,
+	// Responded from a UI callback after the handler returned
+	FLIGHT_STAGE_UI = 4,
+} flight_stage_t;
+
+typedef struct {
+	uint8_t ins;
+	uint8_t p1;
+	uint8_t p2;
+	uint8_t lc;
+	uint8_t stage;
+	// Status word of the response, ERR_ASSERT etc. for a crash, 0 if
+	// there was none yet
+	uint16_t status;
+	// Ticker events (every 100 ms) from the request to the status
+	uint16_t ticks;
+} flight_record_t;
+
+typedef struct {
+	flight_record_t records[FLIGHT_RECORDER_SIZE];
+	// All APDUs received, the last one is at (numRequests - 1) % SIZE
+	uint32_t numRequests;
+	uint32_t requestTicks;
+} flightRecorderState_t;
+
+// Main loop hooks
+void flightRecorder_recordRequest(const uint8_t* apdu, size_t apduSize);
+void flightRecorder_setStage(flight_stage_t stage);
+// Also called for every response by io_send_buf
+void flightRecorder_recordStatus(uint16_t status);
+// Saves the record to NVRAM
+void flightRecorder_saveCrash();
+
+handler_fn_t flightRecorder_handleAPDU;
+
+#ifdef DEVEL
+void run_flightRecorder_test();
+#endif
+
+#endif
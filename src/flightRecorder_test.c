@@ -0,0 +1,66 @@
+#ifdef DEVEL
+
+#include "common.h"
+#include "flightRecorder.h"
+#include "state.h"
+#include "storage.h"
+#include "test_utils.h"
+
+void run_flightRecorder_test()
+{
+	PRINTF("flightRecorder test\n");
+
+	// Keeps the record of the running instruction
+	const flightRecorderState_t saved = appContext->flightRecorder;
+	const flightRecorderState_t* state = &appContext->flightRecorder;
+	os_memset(&appContext->flightRecorder, 0, SIZEOF(appContext->flightRecorder));
+
+	const uint8_t apdu[] = {0xD7, 0x21, 0x02, 0x00, 0x03, 0xAA, 0xBB, 0xCC};
+	flightRecorder_recordRequest(apdu, SIZEOF(apdu));
+	flightRecorder_setStage(FLIGHT_STAGE_HANDLER);
+	flightRecorder_setStage(FLIGHT_STAGE_RETURNED);
+	flightRecorder_recordStatus(ERR_INVALID_STATE);
+	// Only the first status of a request counts
+	flightRecorder_recordStatus(SUCCESS);
+
+	EXPECT_EQ(state->numRequests, 1);
+	const flight_record_t* record = &state->records[0];
+	EXPECT_EQ(record->ins, 0x21);
+	EXPECT_EQ(record->p1, 0x02);
+	EXPECT_EQ(record->lc, 0x03);
+	EXPECT_EQ(record->stage, FLIGHT_STAGE_UI);
+	EXPECT_EQ(record->status, ERR_INVALID_STATE);
+
+	// Truncated header
+	flightRecorder_recordRequest(apdu, 2);
+	EXPECT_EQ(state->records[1].ins, 0x21);
+	EXPECT_EQ(state->records[1].p1, 0);
+	EXPECT_EQ(state->records[1].stage, FLIGHT_STAGE_RECEIVED);
+
+	// The ring keeps the last requests
+	for (unsigned i = 0; i < FLIGHT_RECORDER_SIZE; i++) {
+		flightRecorder_recordRequest(apdu, SIZEOF(apdu));
+	}
+	EXPECT_EQ(state->numRequests, 2 + FLIGHT_RECORDER_SIZE);
+	EXPECT_EQ(state->records[1].p1, 0x02);
+
+	// Keeps the crash record of a previous run (until the host reads it)
+	uint8_t savedCrash[STORAGE_CRASH_RECORD_CAPACITY];
+	const size_t savedCrashSize = storage_readCrashRecord(savedCrash, SIZEOF(savedCrash));
+
+	// Saved as the response: requests, count and 9 bytes per record
+	uint8_t buffer[STORAGE_CRASH_RECORD_CAPACITY];
+	flightRecorder_saveCrash();
+	EXPECT_EQ(storage_readCrashRecord(buffer, SIZEOF(buffer)), 5 + 9 * FLIGHT_RECORDER_SIZE);
+	EXPECT_EQ(buffer[3], 2 + FLIGHT_RECORDER_SIZE);
+	EXPECT_EQ(buffer[4], FLIGHT_RECORDER_SIZE);
+	storage_clearCrashRecord();
+	EXPECT_EQ(storage_readCrashRecord(buffer, SIZEOF(buffer)), 0);
+
+	if (savedCrashSize > 0) {
+		storage_writeCrashRecord(savedCrash, savedCrashSize);
+	}
+	appContext->flightRecorder = saved;
+}
+
+#endif
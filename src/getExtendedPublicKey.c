@@ -7,7 +7,7 @@
 #include "uiHelpers.h"
 #include "securityPolicy.h"
 
-static ins_get_ext_pubkey_context_t* ctx = &(instructionState.extPubKeyContext);
+#define ctx (&appContext->instructionState.extPubKeyContext)
 
 
 static int16_t RESPONSE_READY_MAGIC = 12345;
@@ -85,7 +85,7 @@ static void getExtendedPublicKey_ui_runStep()
 	}
 	UI_STEP(UI_STEP_DISPLAY_PATH) {
 		// Response
-		char pathStr[100];
+		char pathStr[BIP44_PATH_STRING_SIZE];
 		bip44_printToStr(&ctx->pathSpec, pathStr, SIZEOF(pathStr) );
 
 		ui_displayPaginatedText(
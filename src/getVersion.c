@@ -21,10 +21,13 @@ void getVersion_handleAPDU(
 {
 	// Check that we have format "x.y.z"
 	STATIC_ASSERT(SIZEOF(APPVERSION) == 5 + 1, "bad APPVERSION length");
+	// Note: gcc (host build) does not fold string literal elements
+#ifdef __clang__
 #define ASSERT_IS_DIGIT(d) STATIC_ASSERT(APPVERSION[d] >= '0' && APPVERSION[d] <= '9', "bad digit in APPVERSION")
 	ASSERT_IS_DIGIT(0);
 	ASSERT_IS_DIGIT(2);
 	ASSERT_IS_DIGIT(4);
+#endif
 
 	VALIDATE(p1 == 0, ERR_INVALID_REQUEST_PARAMETERS);
 	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
@@ -44,7 +47,7 @@ void getVersion_handleAPDU(
 
 	#ifdef DEVEL
 	response.flags |= FLAG_DEVEL;
-	#endif
+#endif
 
 	io_send_buf(SUCCESS, (uint8_t *) &response, sizeof(response));
 	ui_idle();
@@ -9,10 +9,16 @@
 #include "runTests.h"
 #include "attestUtxo.h"
 #include "attestKey.h"
+#include "trustedAddress.h"
 #include "state.h"
 #include "errors.h"
 #include "deriveAddress.h"
 #include "signTx.h"
+#include "flightRecorder.h"
+#include "profiling.h"
+#include "syscalls.h"
+#include "stackUsage.h"
+#include "trace.h"
 
 // The APDU protocol uses a single-byte instruction code (INS) to specify
 // which command should be executed. We'll use this code to dispatch on a
@@ -23,6 +29,7 @@ handler_fn_t* lookupHandler(uint8_t ins)
 #	define  CASE(INS, HANDLER) case INS: return HANDLER;
 		// 0x0* -  app status calls
 		CASE(0x00, getVersion_handleAPDU);
+		CASE(0x02, flightRecorder_handleAPDU);
 
 		// 0x1* -  public-key/address related
 		CASE(0x10, getExtendedPublicKey_handleAPDU);
@@ -31,6 +38,9 @@ handler_fn_t* lookupHandler(uint8_t ins)
 		// 0x2* -  signing-transaction related
 		CASE(0x20, attestUTxO_handleAPDU);
 		CASE(0x21, signTx_handleAPDU);
+		CASE(0x22, rotateAttestKey_handleAPDU);
+		CASE(0x23, getAttestKeyFingerprint_handleAPDU);
+		CASE(0x24, addTrustedAddress_handleAPDU);
 
 		#ifdef DEVEL
 		// 0xF* -  debug_mode related
@@ -38,6 +48,10 @@ handler_fn_t* lookupHandler(uint8_t ins)
 		//   0xF1  reserved for INS_SET_HEADLESS_INTERACTION
 		CASE(0xF2, handleGetAttestKey);
 		CASE(0xF3, handleSetAttestKey);
+		CASE(0xF4, profiling_handleAPDU);
+		CASE(0xF5, syscalls_handleAPDU);
+		CASE(0xF6, stackUsage_handleAPDU);
+		CASE(0xF7, trace_handleAPDU);
 		#endif
 #	undef   CASE
 	default:
@@ -2,6 +2,8 @@
 #define H_CARDANO_APP_BLAKE2B
 
 #include "common.h"
+#include "profiling.h"
+#include "syscalls.h"
 
 // This file provides convenience functions for using firmware hashing api
 
@@ -43,6 +45,7 @@ enum {
 	                                      const uint8_t* inBuffer, size_t inSize \
 	                                    ) { \
 		ASSERT(ctx->initialized_magic == HASH_CONTEXT_INITIALIZED_MAGIC); \
+		PROFILING_BEGIN(); \
 		cx_hash( \
 		         & ctx->cx_ctx.header, \
 		         0, /* Do not output the hash, yet */ \
@@ -50,6 +53,7 @@ enum {
 		         inSize, \
 		         NULL, 0 \
 		       ); \
+		PROFILING_END(PROFILING_SITE_HASH); \
 	} \
 	\
 	inline void cipher##_##bits##_finalize( \
@@ -58,6 +62,7 @@ enum {
 	                                      ) { \
 		ASSERT(ctx->initialized_magic == HASH_CONTEXT_INITIALIZED_MAGIC); \
 		ASSERT(outSize == CIPHER##_##bits##_SIZE); \
+		PROFILING_BEGIN(); \
 		cx_hash( \
 		         & ctx->cx_ctx.header, \
 		         CX_LAST, /* Output the hash */ \
@@ -66,6 +71,7 @@ enum {
 		         outBuffer, \
 		         CIPHER##_##bits##_SIZE \
 		       ); \
+		PROFILING_END(PROFILING_SITE_HASH); \
 	} \
 	/* Convenience function to make all in one step */ \
 	inline void cipher##_##bits##_hash( \
@@ -2,6 +2,7 @@
 #include "assert.h"
 #include "utils.h"
 #include <os.h>
+#include "syscalls.h"
 
 void hmac_sha256(
         const uint8_t *keyBuffer, size_t keySize,
@@ -2,8 +2,12 @@
 #include "io.h"
 #include "assert.h"
 #include "errors.h"
+#include "state.h"
+#include "profiling.h"
+#include "trace.h"
+#include "flightRecorder.h"
 
-io_state_t io_state;
+#define TRACE_MODULE IO
 
 #if defined(TARGET_NANOS)
 static timeout_callback_fn_t* timeout_cb;
@@ -19,6 +23,7 @@ void nanos_set_timer(int ms, timeout_callback_fn_t* cb)
 	// before ui_ methods, because it causes Ledger Nano S
 	// to freeze in debug mode
 	// TRACE();
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ms, 0);
 	ASSERT(timeout_cb == NULL);
 	ASSERT(ms >= 0);
 	timeout_cb = cb;
@@ -52,23 +57,49 @@ void CHECK_RESPONSE_SIZE(unsigned int tx)
 void _io_send_G_io_apdu_buffer(uint16_t code, uint16_t tx)
 {
 	CHECK_RESPONSE_SIZE(tx);
+	flightRecorder_recordStatus(code);
 	G_io_apdu_buffer[tx++] = code >> 8;
 	G_io_apdu_buffer[tx++] = code & 0xFF;
 	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
 
 	// From now on we can receive new APDU
-	io_state = IO_EXPECT_IO;
+	appContext->io_state = IO_EXPECT_IO;
 }
 
 void io_send_buf(uint16_t code, uint8_t* buffer, size_t bufferSize)
 {
 	CHECK_RESPONSE_SIZE(bufferSize);
 
+	TRACE_EVENT(TRACE_LEVEL_INFO, code, bufferSize);
 	os_memmove(G_io_apdu_buffer, buffer, bufferSize);
 	_io_send_G_io_apdu_buffer(code, bufferSize);
 }
 
 
+// Note: BOLOS has no clock for apps, the only time source is the ticker
+// event sent by the MCU every 100 ms. Events are processed only while we
+// wait in io_exchange, so ticks advance between APDUs (and while the user
+// reviews) but not inside a single computation.
+static uint32_t tickerEventCount;
+
+uint32_t io_getTickerCount()
+{
+	return tickerEventCount;
+}
+
+#ifdef DEVEL
+// Note: call counts are exact, see the note above for ticks
+uint32_t profiling_getTicks()
+{
+	return tickerEventCount;
+}
+
+uint32_t profiling_getTicksPerSecond()
+{
+	return 10;
+}
+#endif
+
 // Everything below this point is Ledger magic.
 
 // override point, but nothing more to do
@@ -107,8 +138,9 @@ unsigned char io_event(unsigned char channel MARK_UNUSED)
 		break;
 
 	case SEPROXYHAL_TAG_TICKER_EVENT:
+		tickerEventCount++;
 		UX_TICKER_EVENT(G_io_seproxyhal_spi_buffer, {
-			TRACE("timer");
+			TRACE_EVENT(TRACE_LEVEL_DEBUG, 0, 0);
 			HANDLE_UX_TICKER_EVENT(UX_ALLOWED);
 		});
 		break;
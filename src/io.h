@@ -17,6 +17,9 @@ void io_send_buf(uint16_t code, uint8_t* buffer, size_t bufferSize);
 // Asserts that the response fits into response buffer
 void CHECK_RESPONSE_SIZE(unsigned int tx);
 
+// Ticker events received since app start (one every 100 ms)
+uint32_t io_getTickerCount();
+
 // This was added for sanity checking -- our program should always be awaiting on something
 // and it should be exactly the expected handler
 typedef enum {
@@ -28,8 +31,6 @@ typedef enum {
 	IO_EXPECT_NONE = 49,
 } io_state_t;
 
-extern io_state_t io_state;
-
 // Everything below this point is Ledger magic
 
 void io_seproxyhal_display(const bagl_element_t *element);
@@ -12,6 +12,8 @@
 #include "utils.h"
 #include "endian.h"
 #include "cardano.h"
+#include "profiling.h"
+#include "syscalls.h"
 
 void derivePrivateKey(
         const bip44_path_t* pathSpec,
@@ -23,7 +25,7 @@ void derivePrivateKey(
 		THROW(ERR_INVALID_BIP44_PATH);
 	}
 	// Sanity check
-	ASSERT(pathSpec->length < ARRAY_LEN(pathSpec->path));
+	ASSERT(pathSpec->length <= ARRAY_LEN(pathSpec->path));
 
 	uint8_t privateKeyRawBuffer[64];
 
@@ -35,12 +37,14 @@ void derivePrivateKey(
 			STATIC_ASSERT(CX_APILEVEL >= 5, "unsupported api level");
 			STATIC_ASSERT(SIZEOF(privateKey->d) == 64, "bad private key length");
 
+			PROFILING_BEGIN();
 			os_perso_derive_node_bip32(
 			        CX_CURVE_Ed25519,
 			        pathSpec->path,
 			        pathSpec->length,
 			        privateKeyRawBuffer,
 			        chainCode->code);
+			PROFILING_END(PROFILING_SITE_DERIVE_PRIVATE_KEY);
 
 			// We should do cx_ecfp_init_private_key here, but it does not work in SDK < 1.5.4,
 			// should work with the new SDK
@@ -60,6 +64,7 @@ void deriveRawPublicKey(
         cx_ecfp_public_key_t* publicKey
 )
 {
+	PROFILING_BEGIN();
 	// We should do cx_ecfp_generate_pair here, but it does not work in SDK < 1.5.4,
 	// should work with the new SDK
 	cx_eddsa_get_public_key(
@@ -69,6 +74,7 @@ void deriveRawPublicKey(
 	        CX_SHA512,
 	        publicKey,
 	        NULL, 0, NULL, 0);
+	PROFILING_END(PROFILING_SITE_DERIVE_PUBLIC_KEY);
 }
 
 void extractRawPublicKey(
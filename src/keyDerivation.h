@@ -6,9 +6,12 @@
 #include "bip44.h"
 
 
-static const size_t PUBLIC_KEY_SIZE =  32;
-static const size_t CHAIN_CODE_SIZE =  32;
-static const size_t EXTENDED_PUBKEY_SIZE = CHAIN_CODE_SIZE + PUBLIC_KEY_SIZE;
+// Note: enum (unlike static const) can be used for array sizes by any compiler
+enum {
+	PUBLIC_KEY_SIZE = 32,
+	CHAIN_CODE_SIZE = 32,
+	EXTENDED_PUBKEY_SIZE = CHAIN_CODE_SIZE + PUBLIC_KEY_SIZE,
+};
 
 typedef cx_ecfp_256_extended_private_key_t privateKey_t;
 
@@ -21,8 +21,7 @@ static void pathSpec_init(bip44_path_t* pathSpec, uint32_t* pathArray, uint32_t
 
 static void PRINTF_bip44(const bip44_path_t* pathSpec)
 {
-	char tmp[100];
-	SIZEOF(*pathSpec);
+	char tmp[BIP44_PATH_STRING_SIZE];
 	bip44_printToStr(pathSpec, tmp, SIZEOF(tmp));
 	PRINTF("%s", tmp);
 };
@@ -201,6 +200,29 @@ void testChainCodeDerivation()
 #undef TESTCASE
 }
 
+// Deepest accepted path with the longest string form
+void testDeepestPath()
+{
+	PRINTF("testDeepestPath\n");
+
+	bip44_path_t pathSpec;
+	pathSpec.length = BIP44_MAX_PATH_LENGTH;
+	pathSpec.path[0] = HARDENED_BIP32 + 44;
+	pathSpec.path[1] = HARDENED_BIP32 + 1815;
+	for (size_t i = 2; i < BIP44_MAX_PATH_LENGTH; i++) {
+		pathSpec.path[i] = HARDENED_BIP32 + (HARDENED_BIP32 - 1);
+	}
+
+	char pathStr[BIP44_PATH_STRING_SIZE];
+	bip44_printToStr(&pathSpec, pathStr, SIZEOF(pathStr));
+	// "m/44'/1815'" and "/2147483647'" per remaining item
+	EXPECT_EQ(strlen(pathStr), 11 + (BIP44_MAX_PATH_LENGTH - 2) * 12);
+
+	chain_code_t chainCode;
+	privateKey_t privateKey;
+	derivePrivateKey(&pathSpec, &chainCode, &privateKey);
+}
+
 
 void run_key_derivation_test()
 {
@@ -210,6 +232,7 @@ void run_key_derivation_test()
 	testPrivateKeyDerivation();
 	testPublicKeyDerivation();
 	testChainCodeDerivation();
+	testDeepestPath();
 }
 
 #endif
@@ -28,6 +28,8 @@
 
 #include "getVersion.h"
 #include "attestKey.h"
+#include "storage.h"
+#include "trustedAddress.h"
 #include "handlers.h"
 #include "state.h"
 #include "errors.h"
@@ -35,6 +37,9 @@
 #include "assert.h"
 #include "io.h"
 #include "endian.h"
+#include "profiling.h"
+#include "flightRecorder.h"
+#include "stackUsage.h"
 
 // The whole app is designed for a specific api level.
 // In case there is an api change, first *verify* changes
@@ -48,7 +53,7 @@ static const int INS_NONE = -1;
 // menu as its idle screen; you can define your own completely custom screen.
 void ui_idle(void)
 {
-	currentInstruction = INS_NONE;
+	appContext->currentInstruction = INS_NONE;
 	// The first argument is the starting index within menu_main, and the last
 	// argument is a preprocessor; I've never seen an app that uses either
 	// argument.
@@ -81,6 +86,10 @@ static void cardano_main(void)
 	volatile size_t tx = 0;
 	volatile uint8_t flags = 0;
 
+	#ifdef DEVEL
+	stackUsage_init();
+	#endif
+
 	// Exchange APDUs until EXCEPTION_IO_RESET is thrown.
 	for (;;) {
 		// The Ledger SDK implements a form of exception handling. In addition
@@ -100,8 +109,8 @@ static void cardano_main(void)
 				flags = 0;
 
 				// We should be awaiting APDU
-				ASSERT(io_state == IO_EXPECT_IO);
-				io_state = IO_EXPECT_NONE;
+				ASSERT(appContext->io_state == IO_EXPECT_IO);
+				appContext->io_state = IO_EXPECT_NONE;
 
 				// No APDU received; trigger a reset.
 				if (rx == 0)
@@ -109,6 +118,8 @@ static void cardano_main(void)
 					THROW(EXCEPTION_IO_RESET);
 				}
 
+				flightRecorder_recordRequest(G_io_apdu_buffer, rx);
+
 				VALIDATE(device_is_unlocked(), ERR_DEVICE_LOCKED);
 
 				// Note(ppershing): unsafe to access before checks
@@ -138,17 +149,26 @@ static void cardano_main(void)
 				VALIDATE(handlerFn != NULL, ERR_UNKNOWN_INS);
 
 				bool isNewCall = false;
-				if (currentInstruction == INS_NONE)
+				if (appContext->currentInstruction == INS_NONE)
 				{
-					os_memset(&instructionState, 0, SIZEOF(instructionState));
+					os_memset(&appContext->instructionState, 0, SIZEOF(appContext->instructionState));
 					isNewCall = true;
-					currentInstruction = header->ins;
+					appContext->currentInstruction = header->ins;
 				} else
 				{
-					VALIDATE(header->ins == currentInstruction, ERR_STILL_IN_CALL);
+					VALIDATE(header->ins == appContext->currentInstruction, ERR_STILL_IN_CALL);
 				}
 
 
+				#ifdef DEVEL
+				// Note: the response overwrites the header
+				const uint8_t ins = header->ins;
+				const uint8_t p1 = header->p1;
+				const uint32_t startTicks = profiling_getTicks();
+				stackUsage_checkpoint(STACK_USAGE_STEP_HANDLER);
+				#endif
+
+				flightRecorder_setStage(FLIGHT_STAGE_HANDLER);
 				// Note: handlerFn is responsible for calling io_send
 				// either during its call or subsequent UI actions
 				handlerFn(header->p1,
@@ -156,6 +176,12 @@ static void cardano_main(void)
 				          data,
 				          header->lc,
 				          isNewCall);
+				flightRecorder_setStage(FLIGHT_STAGE_RETURNED);
+
+				#ifdef DEVEL
+				profiling_recordInstruction(ins, p1, startTicks);
+				stackUsage_checkpoint(STACK_USAGE_STEP_IDLE);
+				#endif
 				flags = IO_ASYNCH_REPLY;
 			}
 			CATCH(EXCEPTION_IO_RESET)
@@ -165,6 +191,8 @@ static void cardano_main(void)
 			CATCH(ERR_ASSERT)
 			{
 				// Note(ppershing): assertions should not auto-respond
+				flightRecorder_recordStatus(ERR_ASSERT);
+				flightRecorder_saveCrash();
 				#ifdef RESET_ON_CRASH
 				// Reset device
 				io_seproxyhal_se_reset();
@@ -178,6 +206,8 @@ static void cardano_main(void)
 					ui_idle();
 				} else {
 					PRINTF("Uncaught error %x", (unsigned) e);
+					flightRecorder_recordStatus((uint16_t) e);
+					flightRecorder_saveCrash();
 					#ifdef RESET_ON_CRASH
 					// Reset device
 					io_seproxyhal_se_reset();
@@ -237,8 +267,10 @@ __attribute__((section(".boot"))) int main(void)
 				BLE_power(1, "Nano X ADA");
 				#endif
 
+				storage_initialize();
 				attestKey_initialize();
-				io_state = IO_EXPECT_IO;
+				trustedAddress_initialize();
+				appContext->io_state = IO_EXPECT_IO;
 				cardano_main();
 			}
 			CATCH(EXCEPTION_IO_RESET)
@@ -4,7 +4,7 @@
 #include <os_io_seproxyhal.h>
 
 #if defined(TARGET_NANOS)
-extern const ux_menu_entry_t menu_main[4];
+extern const ux_menu_entry_t menu_main[5];
 #elif defined(TARGET_NANOX)
 extern const ux_flow_step_t* const ux_idle_flow [];
 #endif
@@ -5,6 +5,9 @@
 #include "menu.h"
 #include "getVersion.h"
 #include "glyphs.h"
+#include "attestKey.h"
+#include "trustedAddress.h"
+#include "securityPolicy.h"
 
 // Here we define the main menu, using the Ledger-provided menu API. This menu
 // turns out to be fairly unimportant for Nano S apps, since commands are sent
@@ -41,12 +44,102 @@ static const ux_menu_entry_t menu_about[] = {
 	UX_MENU_END,
 };
 
+const ux_menu_entry_t menu_settings[];
+
+static void menu_settings_attestKey_change(unsigned int isPersistent)
+{
+	attestKey_setPersistent(isPersistent);
+	// go back to the settings menu
+	UX_MENU_DISPLAY(0, menu_settings, NULL);
+}
+
+// Persistent attestation key survives app restarts so that
+// the host can cache attestations
+static const ux_menu_entry_t menu_settings_attestKey[] = {
+	{NULL, menu_settings_attestKey_change, 0, NULL, "No", NULL, 0, 0},
+	{NULL, menu_settings_attestKey_change, 1, NULL, "Yes", NULL, 0, 0},
+	UX_MENU_END,
+};
+
+static void menu_settings_attestKey_init(unsigned int ignored MARK_UNUSED)
+{
+	// start on the currently selected option
+	UX_MENU_DISPLAY(attestKey_isPersistent() ? 1 : 0, menu_settings_attestKey, NULL);
+}
+
+static void menu_settings_policyProfile_change(unsigned int profile)
+{
+	securityPolicy_setProfile((policy_profile_t) profile);
+	// go back to the settings menu
+	UX_MENU_DISPLAY(0, menu_settings, NULL);
+}
+
+// Predefined sets of prompts, see securityPolicy.c
+static const ux_menu_entry_t menu_settings_policyProfile[] = {
+	{NULL, menu_settings_policyProfile_change, POLICY_PROFILE_STRICT, NULL, "Strict", NULL, 0, 0},
+	{NULL, menu_settings_policyProfile_change, POLICY_PROFILE_BATCH_OPERATOR, NULL, "Batch operator", NULL, 0, 0},
+	{NULL, menu_settings_policyProfile_change, POLICY_PROFILE_ATTEST_ONLY, NULL, "Attest only", NULL, 0, 0},
+	UX_MENU_END,
+};
+
+static void menu_settings_policyProfile_init(unsigned int ignored MARK_UNUSED)
+{
+	// start on the currently selected option
+	UX_MENU_DISPLAY(securityPolicy_getProfile(), menu_settings_policyProfile, NULL);
+}
+
+static void menu_settings_trustedAddresses_init(unsigned int ignored);
+
+static void menu_settings_trustedAddresses_clear(unsigned int shouldClear)
+{
+	if (shouldClear) {
+		trustedAddress_clearAll();
+	}
+	// go back to the trusted addresses menu
+	menu_settings_trustedAddresses_init(0);
+}
+
+static const ux_menu_entry_t menu_settings_trustedAddresses_confirmClear[] = {
+	{NULL, menu_settings_trustedAddresses_clear, 0, NULL, "No", NULL, 0, 0},
+	{NULL, menu_settings_trustedAddresses_clear, 1, NULL, "Yes", NULL, 0, 0},
+	UX_MENU_END,
+};
+
+static char menuTrustedAddressesCount[20];
+
+// Outputs to trusted addresses are not shown during signing.
+// Addresses are added by the host (with confirmation on the device)
+static const ux_menu_entry_t menu_settings_trustedAddresses[] = {
+	{NULL, NULL, 0, NULL, "Trusted", menuTrustedAddressesCount, 0, 0},
+	{menu_settings_trustedAddresses_confirmClear, NULL, 0, NULL, "Clear all", NULL, 0, 0},
+	{menu_settings, NULL, 1, &C_icon_back, "Back", NULL, 61, 40},
+	UX_MENU_END,
+};
+
+static void menu_settings_trustedAddresses_init(unsigned int ignored MARK_UNUSED)
+{
+	snprintf(
+	        menuTrustedAddressesCount, SIZEOF(menuTrustedAddressesCount),
+	        "%u stored", (unsigned) trustedAddress_getCount()
+	);
+	UX_MENU_DISPLAY(0, menu_settings_trustedAddresses, NULL);
+}
+
+const ux_menu_entry_t menu_settings[] = {
+	{NULL, menu_settings_attestKey_init, 0, NULL, "Persistent", "attest key", 0, 0},
+	{NULL, menu_settings_trustedAddresses_init, 0, NULL, "Trusted", "addresses", 0, 0},
+	{NULL, menu_settings_policyProfile_init, 0, NULL, "Policy", "profile", 0, 0},
+	{menu_main, NULL, 1, &C_icon_back, "Back", NULL, 61, 40},
+	UX_MENU_END,
+};
+
 const ux_menu_entry_t menu_main[] = {
 	#if defined(DEVEL) || defined(HEADLESS)
 	{NULL, NULL, 0, NULL, "Warning:", "DEVEL version!", 0, 0},
 	#else
 	{NULL, NULL, 0, NULL, "Waiting for", "commands...", 0, 0},
 	#endif
+	{menu_settings, NULL, 0, NULL, "Settings", NULL, 0, 0},
 	{menu_about, NULL, 0, NULL, "About", NULL, 0, 0},
 	{NULL, os_sched_exit, 0, &C_icon_dashboard, "Quit app", NULL, 50, 29},
 	UX_MENU_END,
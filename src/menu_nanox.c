@@ -5,6 +5,9 @@
 #include "menu.h"
 #include "getVersion.h"
 #include "glyphs.h"
+#include "attestKey.h"
+#include "trustedAddress.h"
+#include "securityPolicy.h"
 
 // Helper macro for better astyle formatting of UX_FLOW definitions
 #define LINES(...) { __VA_ARGS__ }
@@ -34,6 +37,192 @@ UX_STEP_NOCB(
         )
 );
 
+// Settings
+
+static char settingsAttestKeyText[10];
+static char settingsTrustedAddressesText[20];
+static char settingsPolicyProfileText[20];
+
+static void settings_display();
+
+static void settings_toggleAttestKey()
+{
+	attestKey_setPersistent(!attestKey_isPersistent());
+	settings_display();
+}
+
+UX_STEP_CB(
+        ux_settings_flow_1_step,
+        bn,
+        settings_toggleAttestKey(),
+        LINES(
+                "Persistent attest key",
+                settingsAttestKeyText
+        )
+);
+
+static void settings_clearTrustedAddresses()
+{
+	trustedAddress_clearAll();
+	settings_display();
+}
+
+// Note: ui_displayPrompt cannot be used here as there is no instruction
+// in progress
+UX_STEP_CB(
+        ux_settings_clearTrustedAddresses_flow_1_step,
+        pbb,
+        settings_clearTrustedAddresses(),
+        LINES(
+                &C_icon_validate_14,
+                "Clear trusted",
+                "addresses?"
+        )
+);
+
+UX_STEP_CB(
+        ux_settings_clearTrustedAddresses_flow_2_step,
+        pb,
+        settings_display(),
+        LINES(
+                &C_icon_crossmark,
+                "Cancel"
+        )
+);
+
+UX_FLOW(
+        ux_settings_clearTrustedAddresses_flow,
+        &ux_settings_clearTrustedAddresses_flow_1_step,
+        &ux_settings_clearTrustedAddresses_flow_2_step
+);
+
+static void settings_confirmClearTrustedAddresses()
+{
+	if (trustedAddress_getCount() == 0) return;
+
+	ux_flow_init(0, ux_settings_clearTrustedAddresses_flow, NULL);
+}
+
+static policy_profile_t settingsPendingPolicyProfile;
+static char settingsPendingPolicyProfileText[20];
+
+static void settings_setPendingPolicyProfile()
+{
+	securityPolicy_setProfile(settingsPendingPolicyProfile);
+	settings_display();
+}
+
+UX_STEP_CB(
+        ux_settings_confirmPolicyProfile_flow_1_step,
+        pbb,
+        settings_setPendingPolicyProfile(),
+        LINES(
+                &C_icon_validate_14,
+                "Fewer prompts:",
+                settingsPendingPolicyProfileText
+        )
+);
+
+UX_STEP_CB(
+        ux_settings_confirmPolicyProfile_flow_2_step,
+        pb,
+        settings_display(),
+        LINES(
+                &C_icon_crossmark,
+                "Cancel"
+        )
+);
+
+UX_FLOW(
+        ux_settings_confirmPolicyProfile_flow,
+        &ux_settings_confirmPolicyProfile_flow_1_step,
+        &ux_settings_confirmPolicyProfile_flow_2_step
+);
+
+// Cycles through predefined sets of prompts, see securityPolicy.c.
+// Switching to a profile with fewer prompts has to be confirmed
+static void settings_nextPolicyProfile()
+{
+	policy_profile_t profile = securityPolicy_getProfile();
+	settingsPendingPolicyProfile = (policy_profile_t) ((profile + 1) % POLICY_PROFILE_COUNT);
+
+	if (!securityPolicy_isLessRestrictive(settingsPendingPolicyProfile, profile)) {
+		settings_setPendingPolicyProfile();
+		return;
+	}
+	snprintf(
+	        settingsPendingPolicyProfileText, SIZEOF(settingsPendingPolicyProfileText),
+	        "%s", securityPolicy_getProfileName(settingsPendingPolicyProfile)
+	);
+	ux_flow_init(0, ux_settings_confirmPolicyProfile_flow, NULL);
+}
+
+UX_STEP_CB(
+        ux_settings_flow_policyProfile_step,
+        bn,
+        settings_nextPolicyProfile(),
+        LINES(
+                "Policy profile",
+                settingsPolicyProfileText
+        )
+);
+
+// Outputs to trusted addresses are not shown during signing.
+// Addresses are added by the host (with confirmation on the device)
+UX_STEP_CB(
+        ux_settings_flow_trustedAddresses_step,
+        bn,
+        settings_confirmClearTrustedAddresses(),
+        LINES(
+                "Trusted addresses",
+                settingsTrustedAddressesText
+        )
+);
+
+UX_STEP_CB(
+        ux_settings_flow_2_step,
+        pb,
+        ui_idle(),
+        LINES(
+                &C_icon_back,
+                "Back"
+        )
+);
+
+UX_FLOW(
+        ux_settings_flow,
+        &ux_settings_flow_1_step,
+        &ux_settings_flow_trustedAddresses_step,
+        &ux_settings_flow_policyProfile_step,
+        &ux_settings_flow_2_step
+);
+
+static void settings_display()
+{
+	const char* text = attestKey_isPersistent() ? "Enabled" : "Disabled";
+	ASSERT(strlen(text) < SIZEOF(settingsAttestKeyText));
+	snprintf(settingsAttestKeyText, SIZEOF(settingsAttestKeyText), "%s", text);
+	snprintf(
+	        settingsTrustedAddressesText, SIZEOF(settingsTrustedAddressesText),
+	        "%u stored (clear)", (unsigned) trustedAddress_getCount()
+	);
+	snprintf(
+	        settingsPolicyProfileText, SIZEOF(settingsPolicyProfileText),
+	        "%s", securityPolicy_getProfileName(securityPolicy_getProfile())
+	);
+	ux_flow_init(0, ux_settings_flow, NULL);
+}
+
+UX_STEP_CB(
+        ux_idle_flow_settings_step,
+        pb,
+        settings_display(),
+        LINES(
+                &C_icon_coggle,
+                "Settings"
+        )
+);
+
 UX_STEP_CB(
         ux_idle_flow_3_step,
         pb,
@@ -47,6 +236,7 @@ UX_STEP_CB(
 UX_FLOW(
         ux_idle_flow,
         &ux_idle_flow_1_step,
+        &ux_idle_flow_settings_step,
         &ux_idle_flow_2_step,
         &ux_idle_flow_3_step
 );
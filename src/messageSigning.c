@@ -7,6 +7,8 @@
 #include "endian.h"
 #include "bip44.h"
 #include "keyDerivation.h"
+#include "profiling.h"
+#include "syscalls.h"
 
 void signRawMessage(privateKey_t* privateKey,
                     const uint8_t* messageBuffer, size_t messageSize,
@@ -18,7 +20,8 @@ void signRawMessage(privateKey_t* privateKey,
 
 	// Note(ppershing): this could be done without
 	// temporary copy
-	STATIC_ASSERT(sizeof(int) == sizeof(size_t), "bad sizing");
+	STATIC_ASSERT(sizeof(int) <= sizeof(size_t), "bad sizing");
+	PROFILING_BEGIN();
 	size_t signatureSize =
 	        (size_t) cx_eddsa_sign(
 	                (const struct cx_ecfp_256_private_key_s*) privateKey,
@@ -29,6 +32,7 @@ void signRawMessage(privateKey_t* privateKey,
 	                signature, SIZEOF(signature),
 	                0 /* info */
 	        );
+	PROFILING_END(PROFILING_SITE_SIGN);
 
 	ASSERT(signatureSize == 64);
 	os_memmove(outBuffer, signature, signatureSize);
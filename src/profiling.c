@@ -0,0 +1,113 @@
+#ifdef DEVEL
+
+#include "common.h"
+#include "profiling.h"
+#include "state.h"
+#include "endian.h"
+
+static void profiling_addTicks(profiling_counter_t* counter, uint32_t ticks)
+{
+	counter->count++;
+	counter->ticks += ticks;
+	if (ticks > counter->maxTicks) {
+		counter->maxTicks = ticks;
+	}
+}
+
+void profiling_recordSite(profiling_site_t site, uint32_t startTicks)
+{
+	ASSERT(site < _PROFILING_SITE_COUNT);
+	profilingState_t* state = &appContext->profiling;
+	profiling_addTicks(&state->sites[site], profiling_getTicks() - startTicks);
+}
+
+void profiling_recordInstruction(uint8_t ins, uint8_t p1, uint32_t startTicks)
+{
+	const uint32_t ticks = profiling_getTicks() - startTicks;
+	profilingState_t* state = &appContext->profiling;
+
+	for (uint8_t i = 0; i < state->numInstructions; i++) {
+		if (state->instructions[i].ins == ins && state->instructions[i].p1 == p1) {
+			profiling_addTicks(&state->instructions[i].counter, ticks);
+			return;
+		}
+	}
+
+	if (state->numInstructions >= ARRAY_LEN(state->instructions)) {
+		state->numDroppedCalls++;
+		return;
+	}
+	state->instructions[state->numInstructions].ins = ins;
+	state->instructions[state->numInstructions].p1 = p1;
+	profiling_addTicks(&state->instructions[state->numInstructions].counter, ticks);
+	state->numInstructions++;
+}
+
+void profiling_reset()
+{
+	os_memset(&appContext->profiling, 0, SIZEOF(appContext->profiling));
+}
+
+enum {
+	P1_GET_SITES = 0x01,
+	P1_GET_INSTRUCTIONS = 0x02,
+	P1_RESET = 0x03,
+};
+
+static const uint8_t P2_UNUSED = 0x00;
+
+static size_t profiling_writeCounter(const profiling_counter_t* counter, uint8_t* out)
+{
+	u4be_write(out, counter->count);
+	u4be_write(out + 4, counter->ticks);
+	u4be_write(out + 8, counter->maxTicks);
+	return 12;
+}
+
+void profiling_handleAPDU(
+        uint8_t p1, uint8_t p2,
+        uint8_t* wireBuffer MARK_UNUSED, size_t wireSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireSize == 0, ERR_INVALID_DATA);
+
+	const profilingState_t* state = &appContext->profiling;
+	uint8_t response[4 + PROFILING_MAX_INSTRUCTIONS * (2 + 12)];
+	size_t responseSize = 0;
+
+	switch (p1) {
+	case P1_GET_SITES:
+		u4be_write(response, profiling_getTicksPerSecond());
+		responseSize = 4;
+		STATIC_ASSERT(4 + _PROFILING_SITE_COUNT * 12 <= SIZEOF(response), "bad response size");
+		for (size_t i = 0; i < ARRAY_LEN(state->sites); i++) {
+			responseSize += profiling_writeCounter(&state->sites[i], response + responseSize);
+		}
+		break;
+
+	case P1_GET_INSTRUCTIONS:
+		u4be_write(response, state->numDroppedCalls);
+		responseSize = 4;
+		for (uint8_t i = 0; i < state->numInstructions; i++) {
+			response[responseSize++] = state->instructions[i].ins;
+			response[responseSize++] = state->instructions[i].p1;
+			responseSize += profiling_writeCounter(&state->instructions[i].counter, response + responseSize);
+		}
+		break;
+
+	case P1_RESET:
+		profiling_reset();
+		break;
+
+	default:
+		THROW(ERR_INVALID_REQUEST_PARAMETERS);
+	}
+
+	ASSERT(responseSize <= SIZEOF(response));
+	io_send_buf(SUCCESS, response, responseSize);
+	ui_idle();
+}
+
+#endif
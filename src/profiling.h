@@ -0,0 +1,72 @@
+#ifndef H_CARDANO_APP_PROFILING
+#define H_CARDANO_APP_PROFILING
+
+#include "common.h"
+#include "handlers.h"
+
+// Call counts and elapsed ticks per instruction (INS + P1) and per hot
+// site, DEVEL builds only. Read and reset through INS 0xF4.
+
+typedef enum {
+	PROFILING_SITE_DERIVE_PRIVATE_KEY = 0,
+	PROFILING_SITE_DERIVE_PUBLIC_KEY = 1,
+	PROFILING_SITE_SIGN = 2,
+	PROFILING_SITE_HASH = 3,
+	PROFILING_SITE_BASE58 = 4,
+	PROFILING_SITE_DERIVE_ADDRESS = 5,
+	_PROFILING_SITE_COUNT,
+} profiling_site_t;
+
+enum {
+	// Enough for all signTx stages and a few other instructions
+	PROFILING_MAX_INSTRUCTIONS = 16,
+};
+
+typedef struct {
+	uint32_t count;
+	uint32_t ticks;
+	uint32_t maxTicks;
+} profiling_counter_t;
+
+typedef struct {
+	profiling_counter_t sites[_PROFILING_SITE_COUNT];
+	struct {
+		uint8_t ins;
+		uint8_t p1;
+		profiling_counter_t counter;
+	} instructions[PROFILING_MAX_INSTRUCTIONS];
+	uint8_t numInstructions;
+	// Calls of instructions that did not fit into the table
+	uint32_t numDroppedCalls;
+} profilingState_t;
+
+#ifdef DEVEL
+
+// Provided by the platform (io.c on the device)
+uint32_t profiling_getTicks();
+uint32_t profiling_getTicksPerSecond();
+
+void profiling_recordSite(profiling_site_t site, uint32_t startTicks);
+void profiling_recordInstruction(uint8_t ins, uint8_t p1, uint32_t startTicks);
+void profiling_reset();
+
+handler_fn_t profiling_handleAPDU;
+
+// Usage (at most once per block):
+//   PROFILING_BEGIN();
+//   ... code to measure ...
+//   PROFILING_END(PROFILING_SITE_XYZ);
+// Note: nothing is recorded if the measured code throws
+#define PROFILING_BEGIN() const uint32_t __profilingStartTicks = profiling_getTicks()
+#define PROFILING_END(site) profiling_recordSite(site, __profilingStartTicks)
+
+void run_profiling_test();
+
+#else
+
+#define PROFILING_BEGIN() do {} while(0)
+#define PROFILING_END(site) do {} while(0)
+
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+#ifdef DEVEL
+
+#include "common.h"
+#include "profiling.h"
+#include "state.h"
+#include "test_utils.h"
+
+void run_profiling_test()
+{
+	PRINTF("profiling test\n");
+
+	profiling_reset();
+	const profilingState_t* state = &appContext->profiling;
+
+	const uint32_t now = profiling_getTicks();
+	profiling_recordSite(PROFILING_SITE_HASH, now - 1000);
+	profiling_recordSite(PROFILING_SITE_HASH, now);
+	const profiling_counter_t* hash = &state->sites[PROFILING_SITE_HASH];
+	EXPECT_EQ(hash->count, 2);
+	ASSERT(hash->maxTicks >= 1000);
+	ASSERT(hash->ticks >= hash->maxTicks);
+	EXPECT_EQ(state->sites[PROFILING_SITE_SIGN].count, 0);
+
+	// Same instruction and stage share a counter
+	profiling_recordInstruction(0x21, 0x02, now);
+	profiling_recordInstruction(0x21, 0x02, now);
+	profiling_recordInstruction(0x21, 0x03, now);
+	EXPECT_EQ(state->numInstructions, 2);
+	EXPECT_EQ(state->instructions[0].counter.count, 2);
+	EXPECT_EQ(state->instructions[1].counter.count, 1);
+
+	// Calls beyond the capacity are only counted
+	for (uint8_t p1 = 0x10; p1 < 0x10 + PROFILING_MAX_INSTRUCTIONS; p1++) {
+		profiling_recordInstruction(0x20, p1, now);
+	}
+	EXPECT_EQ(state->numInstructions, PROFILING_MAX_INSTRUCTIONS);
+	EXPECT_EQ(state->numDroppedCalls, 2);
+
+	profiling_reset();
+	EXPECT_EQ(state->numInstructions, 0);
+	EXPECT_EQ(state->sites[PROFILING_SITE_HASH].count, 0);
+}
+
+#endif
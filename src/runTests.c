@@ -5,18 +5,27 @@
 #include "runTests.h"
 #include "stream.h"
 #include "cbor.h"
+#include "cborValidator.h"
 #include "endian.h"
 #include "base58.h"
 #include "test_utils.h"
 #include "hex_utils.h"
 #include "hash.h"
 #include "attestUtxo.h"
+#include "attestKey.h"
 #include "keyDerivation.h"
 #include "addressUtils.h"
 #include "crc32.h"
 #include "hmac.h"
 #include "txHashBuilder.h"
+#include "txParser.h"
+#include "txInputSet.h"
 #include "textUtils.h"
+#include "profiling.h"
+#include "syscalls.h"
+#include "stackUsage.h"
+#include "trace.h"
+#include "flightRecorder.h"
 
 void handleRunTests(
         uint8_t p1 MARK_UNUSED,
@@ -34,13 +43,22 @@ void handleRunTests(
 		run_hex_test();
 		run_stream_test();
 		run_cbor_test();
+		run_cborValidator_test();
 		run_base58_test();
 		run_hash_test();
 		run_test_attestUtxo();
+		run_txParser_test();
+		run_txInputSet_test();
+		run_attestKey_test();
 		run_key_derivation_test();
 		run_address_utils_test();
 		run_crc32_test();
 		run_hmac_test();
+		run_profiling_test();
+		run_syscalls_test();
+		run_stackUsage_test();
+		run_trace_test();
+		run_flightRecorder_test();
 		PRINTF("All tests done\n");
 	} END_ASSERT_NOEXCEPT;
 
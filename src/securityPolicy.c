@@ -1,4 +1,8 @@
 #include "securityPolicy.h"
+#include "cardano.h"
+#include "hash.h"
+#include "trustedAddress.h"
+#include "storage.h"
 
 // Warning: following helper macros assume "pathSpec" in the context
 
@@ -28,11 +32,73 @@ static inline bool is_too_deep(const bip44_path_t* pathSpec)
 	return bip44_containsMoreThanAddress(pathSpec);
 }
 
+policy_profile_t securityPolicy_getProfile()
+{
+	uint8_t profile = storage_getPolicyProfile();
+	// Unknown value (should not happen) falls back to the strictest profile
+	if (profile >= POLICY_PROFILE_COUNT) return POLICY_PROFILE_STRICT;
+	return (policy_profile_t) profile;
+}
+
+void securityPolicy_setProfile(policy_profile_t profile)
+{
+	ASSERT(profile < POLICY_PROFILE_COUNT);
+	if (profile == securityPolicy_getProfile()) return;
+	storage_setPolicyProfile((uint8_t) profile);
+}
+
+const char* securityPolicy_getProfileName(policy_profile_t profile)
+{
+	switch (profile) {
+	case POLICY_PROFILE_STRICT:
+		return "Strict";
+	case POLICY_PROFILE_BATCH_OPERATOR:
+		return "Batch operator";
+	case POLICY_PROFILE_ATTEST_ONLY:
+		return "Attest only";
+	default:
+		ASSERT(false);
+		return NULL;
+	}
+}
+
+// Profiles ordered from the least restrictive one
+static uint8_t securityPolicy_getProfileRank(policy_profile_t profile)
+{
+	switch (profile) {
+	case POLICY_PROFILE_BATCH_OPERATOR:
+		return 0;
+	case POLICY_PROFILE_STRICT:
+		return 1;
+	case POLICY_PROFILE_ATTEST_ONLY:
+		return 2;
+	default:
+		ASSERT(false);
+		return 0;
+	}
+}
+
+bool securityPolicy_isLessRestrictive(policy_profile_t profile, policy_profile_t than)
+{
+	return securityPolicy_getProfileRank(profile) < securityPolicy_getProfileRank(than);
+}
+
+static inline bool is_batch_operator()
+{
+	return securityPolicy_getProfile() == POLICY_PROFILE_BATCH_OPERATOR;
+}
+
+static inline bool is_attest_only()
+{
+	return securityPolicy_getProfile() == POLICY_PROFILE_ATTEST_ONLY;
+}
+
 #define DENY_IF(expr)   if (expr) return POLICY_DENY;
 #define WARN_IF(expr)   if (expr) return POLICY_PROMPT_WARN_UNUSUAL;
 #define PROMPT_IF(expr) if (expr) return POLICY_PROMPT_BEFORE_RESPONSE;
 #define ALLOW_IF(expr)  if (expr) return POLICY_ALLOW_WITHOUT_PROMPT;
 #define SHOW_IF(expr)   if (expr) return POLICY_SHOW_BEFORE_RESPONSE;
+#define AGGREGATE_IF(expr) if (expr) return POLICY_SHOW_AGGREGATED;
 
 // Get extended public key and return it to the host
 security_policy_t policyForGetExtendedPublicKey(const bip44_path_t* pathSpec)
@@ -55,6 +121,9 @@ security_policy_t policyForReturnDeriveAddress(const bip44_path_t* pathSpec)
 	WARN_IF(!has_reasonable_account_and_address(pathSpec))
 	WARN_IF(is_too_deep(pathSpec));
 
+	// Host could derive the address from the (already exported) account public key
+	ALLOW_IF(is_batch_operator());
+
 	PROMPT_IF(true);
 }
 
@@ -77,11 +146,40 @@ security_policy_t policyForAttestUtxo()
 	ALLOW_IF(true);
 }
 
+// Replace attestation key (invalidates host-cached attestations)
+security_policy_t policyForRotateAttestKey()
+{
+	// Rotation is harmless security-wise but should not happen behind user's back
+	PROMPT_IF(true);
+}
+
+// Return fingerprint of the attestation key
+security_policy_t policyForGetAttestKeyFingerprint()
+{
+	// Fingerprint does not reveal the key
+	ALLOW_IF(true);
+}
+
+
+// Add address to the trusted addresses registry
+security_policy_t policyForAddTrustedAddress()
+{
+	// Trusted addresses are only used when signing
+	DENY_IF(is_attest_only());
+
+	// Outputs to the address will not be shown anymore
+	PROMPT_IF(true);
+}
+
 
 // Initiate transaction signing
 security_policy_t policyForSignTxInit()
 {
-	// Could be switched to POLICY_ALLOW_WITHOUT_PROMPT to skip initial "new transaction" question
+	DENY_IF(is_attest_only());
+
+	// The user reviews the transaction anyway, skip initial "new transaction" question
+	ALLOW_IF(is_batch_operator());
+
 	PROMPT_IF(true);
 }
 
@@ -94,10 +192,24 @@ security_policy_t policyForSignTxInput()
 
 // For each transaction (third-party) address output
 security_policy_t policyForSignTxOutputAddress(
-        const uint8_t* rawAddressBuffer MARK_UNUSED, size_t rawAddressSize MARK_UNUSED
+        const uint8_t* rawAddressBuffer, size_t rawAddressSize
+)
+{
+	uint8_t digest[BLAKE2B_224_SIZE];
+	blake2b_224_hash(rawAddressBuffer, rawAddressSize, digest, SIZEOF(digest));
+
+	return policyForSignTxOutputAddressDigest(digest, SIZEOF(digest));
+}
+
+// For each transaction (third-party) address output streamed in chunks
+security_policy_t policyForSignTxOutputAddressDigest(
+        const uint8_t* digestBuffer, size_t digestSize
 )
 {
-	// We always show third-party output addresses
+	// User already approved the address on the device
+	ALLOW_IF(trustedAddress_contains(digestBuffer, digestSize));
+
+	// We show other third-party output addresses (as a digest if too long)
 	SHOW_IF(true);
 }
 
@@ -115,9 +227,54 @@ security_policy_t policyForSignTxOutputPath(const bip44_path_t* pathSpec)
 	ALLOW_IF(true);
 }
 
+// Host asks to review outputs as a summary at the end
+security_policy_t policyForSignTxAggregateReview()
+{
+	// Only for high-volume signing the user opted into on the device
+	DENY_IF(!is_batch_operator());
+
+	PROMPT_IF(true);
+}
+
+// For each third-party output (with already computed policy) in aggregate review
+security_policy_t policyForSignTxOutputAggregated(
+        security_policy_t outputPolicy,
+        const uint8_t* addressDigestBuffer, size_t addressDigestSize
+)
+{
+	// Outputs to addresses the user approved before are not shown anyway,
+	// these are summarized. Any other address is still shown
+	AGGREGATE_IF(
+	        outputPolicy == POLICY_ALLOW_WITHOUT_PROMPT &&
+	        trustedAddress_contains(addressDigestBuffer, addressDigestSize)
+	);
+
+	return outputPolicy;
+}
+
+// For transaction attributes/metadata
+security_policy_t policyForSignTxMetadata(size_t metadataSize MARK_UNUSED)
+{
+	// Metadata of batch payouts is produced by the operator itself
+	ALLOW_IF(is_batch_operator());
+
+	// We cannot display metadata content but let the user know it is there
+	SHOW_IF(true);
+}
+
+static inline uint64_t cardano_minFee(size_t signedTxSize)
+{
+	// Note: round up so that we never accept fee below the network minimum
+	return CARDANO_FEE_CONSTANT +
+	       ((uint64_t) signedTxSize * CARDANO_FEE_PER_BYTE_MILLI + 999) / 1000;
+}
+
 // For transaction fee
-security_policy_t policyForSignTxFee(uint64_t fee MARK_UNUSED)
+security_policy_t policyForSignTxFee(uint64_t fee, size_t signedTxSize)
 {
+	// Network would reject such transaction anyway
+	DENY_IF(fee < cardano_minFee(signedTxSize));
+
 	SHOW_IF(true);
 }
 
@@ -126,6 +283,9 @@ security_policy_t policyForSignTxFee(uint64_t fee MARK_UNUSED)
 // and Ledger *does not* check whether they correspond to previously declared UTxOs
 security_policy_t policyForSignTxWitness(const bip44_path_t* pathSpec)
 {
+	// Note: signing cannot even start, this is just a safety net
+	DENY_IF(is_attest_only());
+
 	DENY_IF(!has_cardano_prefix_and_any_account(pathSpec));
 	DENY_IF(!has_valid_change_and_any_address(pathSpec));
 
@@ -9,20 +9,49 @@ typedef enum {
 	POLICY_PROMPT_BEFORE_RESPONSE = 3,
 	POLICY_PROMPT_WARN_UNUSUAL = 4,
 	POLICY_SHOW_BEFORE_RESPONSE = 5, // Show on display but do not ask for explicit confirmation
+	POLICY_SHOW_AGGREGATED = 6, // Show as part of a summary later
 } security_policy_t;
 
+// Predefined sets of policies selectable by the user
+typedef enum {
+	// Default, every action is reviewed
+	POLICY_PROFILE_STRICT = 0,
+	// Fewer prompts for high-volume signing
+	POLICY_PROFILE_BATCH_OPERATOR = 1,
+	// Signing is disabled, device only attests and exports public data
+	POLICY_PROFILE_ATTEST_ONLY = 2,
+	POLICY_PROFILE_COUNT = 3,
+} policy_profile_t;
+
+policy_profile_t securityPolicy_getProfile();
+void securityPolicy_setProfile(policy_profile_t profile);
+const char* securityPolicy_getProfileName(policy_profile_t profile);
+// Whether switching from one profile to the other removes any prompt
+// (the user should confirm such switch)
+bool securityPolicy_isLessRestrictive(policy_profile_t profile, policy_profile_t than);
+
 security_policy_t policyForGetExtendedPublicKey(const bip44_path_t* pathSpec);
 
 security_policy_t policyForShowDeriveAddress(const bip44_path_t* pathSpec);
 security_policy_t policyForReturnDeriveAddress(const bip44_path_t* pathSpec);
 
 security_policy_t policyForAttestUtxo();
+security_policy_t policyForRotateAttestKey();
+security_policy_t policyForGetAttestKeyFingerprint();
+security_policy_t policyForAddTrustedAddress();
 
 security_policy_t policyForSignTxInit();
 security_policy_t policyForSignTxInput();
 security_policy_t policyForSignTxOutputAddress(const uint8_t* rawAddressBuffer, size_t rawAddressSize);
+security_policy_t policyForSignTxOutputAddressDigest(const uint8_t* digestBuffer, size_t digestSize);
 security_policy_t policyForSignTxOutputPath(const bip44_path_t* pathSpec);
-security_policy_t policyForSignTxFee(uint64_t fee );
+security_policy_t policyForSignTxAggregateReview();
+security_policy_t policyForSignTxOutputAggregated(
+        security_policy_t outputPolicy,
+        const uint8_t* addressDigestBuffer, size_t addressDigestSize
+);
+security_policy_t policyForSignTxMetadata(size_t metadataSize);
+security_policy_t policyForSignTxFee(uint64_t fee, size_t signedTxSize);
 security_policy_t policyForSignTxWitness(const bip44_path_t* pathSpec);
 
 static inline void ENSURE_NOT_DENIED(security_policy_t policy)
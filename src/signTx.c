@@ -16,28 +16,117 @@
 #include "messageSigning.h"
 #include "bip44.h"
 #include "bufView.h"
+#include "txParser.h"
+#include "trace.h"
+#include "trustedAddress.h"
+#include "storage.h"
+
+#define TRACE_MODULE SIGN_TX
+
+// Init P2 flags
+enum {
+	SIGN_TX_INIT_P2_RAW_TX = 0x01,
+	// Counts of inputs/outputs are not sent in advance,
+	// the host ends inputs/outputs explicitly instead
+	SIGN_TX_INIT_P2_UNSPECIFIED_COUNTS = 0x02,
+	// Several transactions are signed after a single review
+	SIGN_TX_INIT_P2_SESSION = 0x04,
+	// Outputs are reviewed as a summary before confirm
+	SIGN_TX_INIT_P2_AGGREGATE_REVIEW = 0x08,
+};
 
 enum {
 	SIGN_TX_INPUT_TYPE_UTXO = 1,
 	/* Not supported for now but maybe in the future...
 	SIGN_TX_INPUT_TYPE_TXHASH = 2,
 	*/
+	SIGN_TX_INPUT_TYPE_UTXO_BATCH = 3,
 };
 
+enum {
+	SIGN_TX_MAX_INPUTS_IN_BATCH = 5,
+};
+
+// Attested UTxO as produced by attestUtxo
+typedef struct {
+	uint8_t txHash[32];
+	uint8_t index[4];
+	uint8_t amount[8];
+} sign_tx_utxo_t;
+
 enum {
 	SIGN_TX_OUTPUT_TYPE_ADDRESS = 1,
 	SIGN_TX_OUTPUT_TYPE_PATH = 2,
+	SIGN_TX_OUTPUT_TYPE_ADDRESS_CHUNKED = 3,
+};
+
+enum {
+	SIGN_TX_OUTPUT_P2_NEW = 0x00,
+	SIGN_TX_OUTPUT_P2_CONTINUATION = 0x01,
 };
 
 
 
-static ins_sign_tx_context_t* ctx = &(instructionState.signTxContext);
+#define ctx (&appContext->instructionState.signTxContext)
 
 static inline void CHECK_STAGE(sign_tx_stage_t expected)
 {
 	VALIDATE(ctx->stage == expected, ERR_INVALID_STATE);
 }
 
+// Inputs/outputs which can be added in the current stage
+static uint16_t signTx_getInputsLimit()
+{
+	return ctx->hasUnspecifiedCounts ? SIGN_MAX_INPUTS - 1 : ctx->numInputs;
+}
+
+static uint16_t signTx_getOutputsLimit()
+{
+	return ctx->hasUnspecifiedCounts ? SIGN_MAX_OUTPUTS - 1 : ctx->numOutputs;
+}
+
+enum {
+	// Array(2)[
+	//    Unsigned[0],
+	//    Tag(24):Bytes(133)[Array(2)[Bytes(64)[xpub], Bytes(64)[signature]]]
+	// ]
+	SIGN_TX_WITNESS_SERIALIZED_SIZE = 1 + 1 + 2 + 2 + 133,
+};
+
+// Lower bound on the size of the signed transaction
+// Array(2)[tx body, Array(numInputs)[witnesses]]
+// Note: the witness list has one entry per input even if we sign
+// fewer (unique) paths, the host repeats witnesses of shared paths.
+// Before the body is complete this is a lower bound as the body
+// (and with unspecified counts the number of inputs) can only grow
+static size_t signTx_getSignedTxSizeLowerBound()
+{
+	const uint16_t numInputs = ctx->hasUnspecifiedCounts ? ctx->currentInput : ctx->numInputs;
+	uint8_t tmp[10];
+	size_t witnessesHeaderSize = cbor_writeToken(CBOR_TYPE_ARRAY, numInputs, tmp, SIZEOF(tmp));
+
+	return 1 +
+	       txHashBuilder_getSerializedSize(&ctx->txHashBuilder) +
+	       witnessesHeaderSize +
+	       (size_t) numInputs * SIGN_TX_WITNESS_SERIALIZED_SIZE;
+}
+
+// Fail as soon as we know the network would reject the transaction
+static void signTx_checkTxSize()
+{
+	size_t size = signTx_getSignedTxSizeLowerBound();
+	TRACE_EVENT(TRACE_LEVEL_INFO, size, 0);
+	VALIDATE(size <= CARDANO_MAX_TX_SIZE, ERR_TX_TOO_LARGE);
+}
+
+// Note: overwrites the transaction body state (see signTx.h)
+static void signTx_beginWitnesses()
+{
+	ctx->stage = SIGN_STAGE_WITNESSES;
+	os_memset(ctx->currentWitnessData, 0, SIZEOF(ctx->currentWitnessData));
+	os_memset(&ctx->witnessPaths, 0, SIZEOF(ctx->witnessPaths));
+}
+
 static void signTx_handleInit_ui_runStep();
 
 enum {
@@ -46,14 +135,27 @@ enum {
 	HANDLE_INIT_STEP_INVALID,
 } ;
 
-static void signTx_handleInitAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+// Sets up a new transaction, either on its own or the next one in a session
+static void signTx_initTransaction(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
 {
-	TRACE();
-
-	CHECK_STAGE(SIGN_STAGE_NONE);
-	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(
+	        (p2 & ~(SIGN_TX_INIT_P2_RAW_TX | SIGN_TX_INIT_P2_UNSPECIFIED_COUNTS | SIGN_TX_INIT_P2_AGGREGATE_REVIEW)) == 0,
+	        ERR_INVALID_REQUEST_PARAMETERS
+	);
+	// Session has its own aggregate review of all transactions
+	VALIDATE(
+	        !((p2 & SIGN_TX_INIT_P2_AGGREGATE_REVIEW) && ctx->session.isActive),
+	        ERR_INVALID_REQUEST_PARAMETERS
+	);
 
-	txHashBuilder_init(&ctx->txHashBuilder);
+	ctx->isRawTx = (p2 & SIGN_TX_INIT_P2_RAW_TX) != 0;
+	ctx->hasUnspecifiedCounts = (p2 & SIGN_TX_INIT_P2_UNSPECIFIED_COUNTS) != 0;
+	if (ctx->isRawTx) {
+		// Body is hashed exactly as we receive it
+		txHashBuilder_initRaw(&ctx->txHashBuilder);
+	} else {
+		txHashBuilder_init(&ctx->txHashBuilder);
+	}
 
 	ctx->currentInput = 0;
 	ctx->currentOutput = 0;
@@ -62,37 +164,84 @@ static void signTx_handleInitAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wi
 	ctx->sumAmountInputs = 0;
 	ctx->sumAmountOutputs = 0;
 
+	// Leftovers of the previous transaction in a session
+	os_memset(&ctx->metadata, 0, SIZEOF(ctx->metadata));
+	os_memset(&ctx->chunkedAddress, 0, SIZEOF(ctx->chunkedAddress));
+	os_memset(&ctx->rawTx, 0, SIZEOF(ctx->rawTx));
+	os_memset(&ctx->aggregate, 0, SIZEOF(ctx->aggregate));
 
-	struct {
-		uint8_t numInputs[4];
-		uint8_t numOutputs[4];
-	}* wireHeader = (void*) wireDataBuffer;
+	ctx->aggregate.isEnabled = (p2 & SIGN_TX_INIT_P2_AGGREGATE_REVIEW) != 0;
 
-	VALIDATE(SIZEOF(*wireHeader) == wireDataSize, ERR_INVALID_DATA);
-
-	ASSERT_TYPE(ctx->numInputs, uint16_t);
-	ctx->numInputs    = (uint16_t) u4be_read(wireHeader->numInputs);
-	ctx->numOutputs   = (uint16_t) u4be_read(wireHeader->numOutputs);
-
-	VALIDATE(ctx->numInputs < SIGN_MAX_INPUTS, ERR_INVALID_DATA);
-	VALIDATE(ctx->numOutputs < SIGN_MAX_OUTPUTS, ERR_INVALID_DATA);
+	// Counts of inputs and outputs (unless unspecified)
+	// followed by optional number of witnesses
+	const size_t countsSize = ctx->hasUnspecifiedCounts ? 0 : 4 + 4;
+	VALIDATE(wireDataSize == countsSize || wireDataSize == countsSize + 4, ERR_INVALID_DATA);
+	read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
 
-	// Note(ppershing): current code design assumes at least one input
-	// and at least one output. If this has to be relaxed, stage switching
-	// logic needs to be re-visited
-	VALIDATE(ctx->numInputs > 0, ERR_INVALID_DATA);
-	VALIDATE(ctx->numOutputs > 0, ERR_INVALID_DATA);
+	if (ctx->hasUnspecifiedCounts) {
+		// Counts are set once the host ends inputs/outputs
+		ctx->numInputs = 0;
+		ctx->numOutputs = 0;
+	} else {
+		ASSERT_TYPE(ctx->numInputs, uint16_t);
+		ctx->numInputs    = (uint16_t) parse_u4be(&view);
+		ctx->numOutputs   = (uint16_t) parse_u4be(&view);
+
+		VALIDATE(ctx->numInputs < SIGN_MAX_INPUTS, ERR_INVALID_DATA);
+		VALIDATE(ctx->numOutputs < SIGN_MAX_OUTPUTS, ERR_INVALID_DATA);
+
+		// Note(ppershing): current code design assumes at least one input
+		// and at least one output. If this has to be relaxed, stage switching
+		// logic needs to be re-visited
+		VALIDATE(ctx->numInputs > 0, ERR_INVALID_DATA);
+		VALIDATE(ctx->numOutputs > 0, ERR_INVALID_DATA);
+	}
 
-	// Note(ppershing): right now we assume that we want to sign whole transaction
-	ctx->numWitnesses = ctx->numInputs;
+	// Optional number of witnesses (one per unique path)
+	ctx->hasDeclaredNumWitnesses = view_remainingSize(&view) > 0;
+	if (ctx->hasDeclaredNumWitnesses) {
+		uint32_t numWitnesses = parse_u4be(&view);
+		VALIDATE(numWitnesses > 0, ERR_INVALID_DATA);
+		VALIDATE(numWitnesses <= SIGN_TX_MAX_WITNESS_PATHS, ERR_INVALID_DATA);
+		ctx->numWitnesses = (uint16_t) numWitnesses;
+	} else {
+		// Note(ppershing): right now we assume that we want to sign whole transaction
+		// Note: with unspecified counts this grows with every input
+		ctx->numWitnesses = ctx->numInputs;
+	}
+	VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
 
 	// Note(ppershing): do not allow more witnesses than inputs. This
 	// tries to lessen potential pubkey privacy leaks because
 	// in WITNESS stage we do not verify whether the witness belongs
 	// to a given utxo.
-	VALIDATE(ctx->numWitnesses <= ctx->numInputs, ERR_INVALID_DATA);
+	// Note: with unspecified counts this is checked at the end of inputs
+	if (!ctx->hasUnspecifiedCounts) {
+		VALIDATE(ctx->numWitnesses <= ctx->numInputs, ERR_INVALID_DATA);
+	}
+
+	signTx_checkTxSize();
+}
+
+static void signTx_handleInitAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
+
+	CHECK_STAGE(SIGN_STAGE_NONE);
+
+	ctx->session.isActive = (p2 & SIGN_TX_INIT_P2_SESSION) != 0;
+	ctx->session.numTxs = 0;
+	ctx->session.sumFees = 0;
+	// Note: an input spent in two transactions of a session would inflate the total fee
+	txInputSet_init(&ctx->inputSet);
+
+	signTx_initTransaction(p2 & ~SIGN_TX_INIT_P2_SESSION, wireDataBuffer, wireDataSize);
+
+	security_policy_t policy = ctx->aggregate.isEnabled ?
+	                           policyForSignTxAggregateReview() :
+	                           policyForSignTxInit();
+	ENSURE_NOT_DENIED(policy);
 
-	security_policy_t policy = policyForSignTxInit();
 	switch (policy) {
 #	define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
 		CASE(POLICY_PROMPT_BEFORE_RESPONSE, HANDLE_INIT_STEP_CONFIRM);
@@ -107,15 +256,22 @@ static void signTx_handleInitAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wi
 // Simple for now
 static void signTx_handleInit_ui_runStep()
 {
-	TRACE("Step %d", ctx->ui_step);
+	TRACE_EVENT(TRACE_LEVEL_INFO, ctx->ui_step, 0);
 	ui_callback_fn_t* this_fn = signTx_handleInit_ui_runStep;
 	int nextStep = HANDLE_INIT_STEP_INVALID;
 
+	UI_STEP_CHECKPOINT(ctx->ui_step);
 	switch(ctx->ui_step) {
 	case HANDLE_INIT_STEP_CONFIRM: {
+		const char* text = "transaction?";
+		if (ctx->session.isActive) {
+			text = "signing session?";
+		} else if (ctx->aggregate.isEnabled) {
+			text = "summarized tx?";
+		}
 		ui_displayPrompt(
 		        "Start new",
-		        "transaction?",
+		        text,
 		        this_fn,
 		        respond_with_user_reject
 		);
@@ -123,9 +279,11 @@ static void signTx_handleInit_ui_runStep()
 		break;
 	}
 	case HANDLE_INIT_STEP_RESPOND: {
-		TRACE();
+		TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
 		// advance state to inputs
-		txHashBuilder_enterInputs(&ctx->txHashBuilder);
+		if (!ctx->isRawTx) {
+			txHashBuilder_enterInputs(&ctx->txHashBuilder);
+		}
 		ctx->stage = SIGN_STAGE_INPUTS;
 
 		// respond
@@ -150,16 +308,74 @@ static void amountSum_incrementBy(uint64_t* sumPtr, uint64_t amount)
 
 static void signTx_handleInput_ui_runStep();
 
+static void signTx_finishInputs()
+{
+	ASSERT(ctx->currentInput == ctx->numInputs);
+	if (ctx->isRawTx) {
+		txParser_init(&ctx->rawTx.parser);
+		ctx->stage = SIGN_STAGE_RAW_TX;
+	} else {
+		txHashBuilder_enterOutputs(&ctx->txHashBuilder);
+		ctx->stage = SIGN_STAGE_OUTPUTS;
+	}
+}
+
 enum {
 	HANDLE_INPUT_STEP_RESPOND = 200,
 	HANDLE_INPUT_STEP_INVALID,
 };
 
+// In raw mode we cannot keep all attested inputs around. Instead
+// we chain digest = H(digest || txHash || index) over attested inputs
+// and over inputs of the transaction body and compare the results.
+// Note: this requires both to come in the same order
+static void signTx_chainInputDigest(uint8_t* digest, const uint8_t* txHash, uint32_t index)
+{
+	uint8_t indexBuffer[4];
+	u4be_write(indexBuffer, index);
+
+	blake2b_256_context_t hashCtx;
+	blake2b_256_init(&hashCtx);
+	blake2b_256_append(&hashCtx, digest, BLAKE2B_256_SIZE);
+	blake2b_256_append(&hashCtx, txHash, 32);
+	blake2b_256_append(&hashCtx, indexBuffer, SIZEOF(indexBuffer));
+	blake2b_256_finalize(&hashCtx, digest, BLAKE2B_256_SIZE);
+}
+
+static void signTx_addAttestedInput(const sign_tx_utxo_t* utxo)
+{
+	uint32_t parsedIndex = u4be_read(utxo->index);
+	uint64_t parsedAmount = u8be_read(utxo->amount);
+
+	// Spending the same utxo twice (also within a session) would inflate the displayed fee
+	VALIDATE(
+	        txInputSet_tryAdd(&ctx->inputSet, utxo->txHash, SIZEOF(utxo->txHash), parsedIndex),
+	        ERR_INVALID_DATA
+	);
+
+	TRACE_EVENT(TRACE_LEVEL_INFO, parsedAmount >> 32, parsedAmount);
+	amountSum_incrementBy(&ctx->sumAmountInputs, parsedAmount);
+
+	if (ctx->isRawTx) {
+		signTx_chainInputDigest(ctx->rawTx.attestedInputsDigest, utxo->txHash, parsedIndex);
+	} else {
+		TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
+		txHashBuilder_addUtxoInput(&ctx->txHashBuilder, utxo->txHash, SIZEOF(utxo->txHash), parsedIndex);
+	}
+	ctx->currentInput++;
+
+	if (ctx->hasUnspecifiedCounts && !ctx->hasDeclaredNumWitnesses) {
+		// We will sign all inputs we got so far
+		ctx->numWitnesses = ctx->currentInput;
+	}
+	signTx_checkTxSize();
+}
+
 static void signTx_handleInputAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
 {
-	TRACE();
-	ASSERT(ctx->currentInput < ctx->numInputs);
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
 	CHECK_STAGE(SIGN_STAGE_INPUTS);
+	VALIDATE(ctx->currentInput < signTx_getInputsLimit(), ERR_INVALID_DATA);
 
 	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
 	VALIDATE(wireDataSize >= 1, ERR_INVALID_DATA);
@@ -168,11 +384,7 @@ static void signTx_handleInputAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t w
 	if (inputType == SIGN_TX_INPUT_TYPE_UTXO) {
 
 		struct {
-			struct {
-				uint8_t txHash[32];
-				uint8_t index[4];
-				uint8_t amount[8];
-			} data;
+			sign_tx_utxo_t data;
 			uint8_t hmac[16];
 		}* wireUtxo = (void*) wireDataBuffer + 1;
 
@@ -186,17 +398,36 @@ static void signTx_handleInputAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t w
 			THROW(ERR_INVALID_DATA);
 		}
 
-		uint8_t* txHashBuffer = wireUtxo->data.txHash;
-		size_t txHashSize = SIZEOF(wireUtxo->data.txHash);
-		uint32_t parsedIndex = u4be_read(wireUtxo->data.index);
-		uint64_t parsedAmount = u8be_read(wireUtxo->data.amount);
+		signTx_addAttestedInput(&wireUtxo->data);
+	} else if (inputType == SIGN_TX_INPUT_TYPE_UTXO_BATCH) {
 
-		// Note(ppershing): Ledger doesn't have uint64_t printing, this is better than nothing
-		TRACE("Input amount %u.%06u", (unsigned) (parsedAmount / 1000000), (unsigned) (parsedAmount % 1000000));
-		amountSum_incrementBy(&ctx->sumAmountInputs, parsedAmount);
+		struct {
+			uint8_t count;
+			sign_tx_utxo_t data[SIGN_TX_MAX_INPUTS_IN_BATCH];
+		}* wireBatch = (void*) wireDataBuffer + 1;
+
+		VALIDATE(wireDataSize >= 2, ERR_INVALID_DATA);
+		uint8_t count = wireBatch->count;
+		VALIDATE(count >= 1, ERR_INVALID_DATA);
+		VALIDATE(count <= SIGN_TX_MAX_INPUTS_IN_BATCH, ERR_INVALID_DATA);
+		VALIDATE(ctx->currentInput + count <= signTx_getInputsLimit(), ERR_INVALID_DATA);
+
+		// Aggregate attestation follows the last utxo
+		const size_t utxosSize = count * SIZEOF(wireBatch->data[0]);
+		VALIDATE(wireDataSize == 2 + utxosSize + ATTEST_HMAC_SIZE, ERR_INVALID_DATA);
+		uint8_t* aggregateHmac = wireDataBuffer + 2 + utxosSize;
+
+		if (!attest_isCorrectAggregateHmac(
+		            ATTEST_PURPOSE_BIND_UTXO_AMOUNT,
+		            (uint8_t*) wireBatch->data, SIZEOF(wireBatch->data[0]), count,
+		            aggregateHmac, ATTEST_HMAC_SIZE
+		    )) {
+			THROW(ERR_INVALID_DATA);
+		}
 
-		TRACE("Adding input to tx hash");
-		txHashBuilder_addUtxoInput(&ctx->txHashBuilder, txHashBuffer, txHashSize, parsedIndex);
+		for (uint8_t i = 0; i < count; i++) {
+			signTx_addAttestedInput(&wireBatch->data[i]);
+		}
 	} else {
 		// Unknown type
 		THROW(ERR_INVALID_DATA);
@@ -219,11 +450,13 @@ static void signTx_handleInput_ui_runStep()
 	UI_STEP_BEGIN(ctx->ui_step);
 
 	UI_STEP(HANDLE_INPUT_STEP_RESPOND) {
-		// Advance state to next input
-		ctx->currentInput++;
-		if (ctx->currentInput == ctx->numInputs) {
-			txHashBuilder_enterOutputs(&ctx->txHashBuilder);
-			ctx->stage = SIGN_STAGE_OUTPUTS;
+		// Advance state to outputs once all inputs are in
+		// Note: with unspecified counts the host ends inputs explicitly
+		if (!ctx->hasUnspecifiedCounts) {
+			ASSERT(ctx->currentInput <= ctx->numInputs);
+			if (ctx->currentInput == ctx->numInputs) {
+				signTx_finishInputs();
+			}
 		}
 
 		// respond
@@ -235,6 +468,7 @@ static void signTx_handleInput_ui_runStep()
 
 
 static void signTx_handleOutput_ui_runStep(); // forward declaration
+static void signTx_rawTx_resumeParsing(); // forward declaration
 
 enum {
 	HANDLE_OUTPUT_STEP_DISPLAY_AMOUNT = 300,
@@ -243,42 +477,237 @@ enum {
 	HANDLE_OUTPUT_STEP_INVALID,
 };
 
+static void signTx_handleOutput_runPolicy(security_policy_t policy)
+{
+#	define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
+#	define  DEFAULT(ERR) default: { THROW(ERR); }
+	switch (policy) {
+		CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_OUTPUT_STEP_DISPLAY_AMOUNT);
+		// Already added to the summary
+		CASE(POLICY_SHOW_AGGREGATED,      HANDLE_OUTPUT_STEP_RESPOND);
+		CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_OUTPUT_STEP_RESPOND);
+		DEFAULT(ERR_NOT_IMPLEMENTED)
+	}
+#	undef   CASE
+#	undef   DEFAULT
+
+	signTx_handleOutput_ui_runStep();
+}
+
+// Returns true if the address was not seen before
+// Note: only outputs to trusted addresses are summarized, so we
+// can tell them apart by their index in the registry
+static bool signTx_aggregate_addAddress(const uint8_t* addressDigest, size_t addressDigestSize)
+{
+	STATIC_ASSERT(STORAGE_TRUSTED_ADDRESSES_CAPACITY <= 8 * SIZEOF(ctx->aggregate.addressMask), "addressMask too small");
+
+	uint8_t index = 0;
+	bool isTrusted = trustedAddress_find(addressDigest, addressDigestSize, &index);
+	ASSERT(isTrusted);
+	ASSERT(index < STORAGE_TRUSTED_ADDRESSES_CAPACITY);
+
+	const uint16_t bit = (uint16_t) (1u << index);
+	if (ctx->aggregate.addressMask & bit) return false;
+	ctx->aggregate.addressMask |= bit;
+	return true;
+}
+
+// Adds the current output to the summary shown before confirm
+static void signTx_aggregate_addOutput(const uint8_t* addressDigest, size_t addressDigestSize)
+{
+	ASSERT(ctx->aggregate.isEnabled);
+	ASSERT(addressDigestSize == BLAKE2B_224_SIZE);
+
+	ctx->aggregate.numOutputs++;
+	amountSum_incrementBy(&ctx->aggregate.sumAmount, ctx->currentAmount);
+	if (signTx_aggregate_addAddress(addressDigest, addressDigestSize)) {
+		ctx->aggregate.numAddresses++;
+	}
+}
+
+// Outputs to trusted addresses go to the summary
+static security_policy_t signTx_aggregate_applyPolicy(
+        security_policy_t policy,
+        const uint8_t* addressDigest, size_t addressDigestSize
+)
+{
+	if (!ctx->aggregate.isEnabled) return policy;
+
+	policy = policyForSignTxOutputAggregated(policy, addressDigest, addressDigestSize);
+	if (policy == POLICY_SHOW_AGGREGATED) {
+		signTx_aggregate_addOutput(addressDigest, addressDigestSize);
+	}
+	return policy;
+}
+
+static security_policy_t signTx_aggregate_applyPolicyForRawAddress(
+        security_policy_t policy,
+        const uint8_t* rawAddress, size_t rawAddressSize
+)
+{
+	if (!ctx->aggregate.isEnabled) return policy;
+
+	uint8_t addressDigest[BLAKE2B_224_SIZE];
+	blake2b_224_hash(rawAddress, rawAddressSize, addressDigest, SIZEOF(addressDigest));
+	return signTx_aggregate_applyPolicy(policy, addressDigest, SIZEOF(addressDigest));
+}
+
+enum {
+	// Array(3)[Bytes(28)[address root], ...
+	CHUNKED_ADDRESS_PREFIX_SIZE = 1 + 2 + 28,
+	// ... Map[attributes], Unsigned[address type]]
+	CHUNKED_ADDRESS_MIN_SIZE = CHUNKED_ADDRESS_PREFIX_SIZE + 1 + 1,
+};
+
+// Checks structure of the raw address
+// Array(3)[Bytes(28)[root], Map[attributes], Unsigned[CARDANO_ADDRESS_TYPE_PUBKEY]]
+// without ever having the whole address in memory
+static void signTx_checkAddressChunk(const uint8_t* chunk, size_t chunkSize)
+{
+	static const uint8_t expectedPrefix[] = {CBOR_TYPE_ARRAY | 3, CBOR_TYPE_BYTES | 24, 28};
+	const size_t attributesEnd = ctx->chunkedAddress.size - 1;
+
+	for (size_t i = 0; i < chunkSize; ) {
+		const size_t offset = ctx->chunkedAddress.received + i;
+
+		if (offset < SIZEOF(expectedPrefix)) {
+			VALIDATE(chunk[i] == expectedPrefix[offset], ERR_INVALID_DATA);
+			i++;
+		} else if (offset < CHUNKED_ADDRESS_PREFIX_SIZE) {
+			// address root, skip
+			const size_t rootEnd = CHUNKED_ADDRESS_PREFIX_SIZE;
+			i += (chunkSize - i < rootEnd - offset) ? chunkSize - i : rootEnd - offset;
+		} else if (offset < attributesEnd) {
+			if (offset == CHUNKED_ADDRESS_PREFIX_SIZE) {
+				VALIDATE((chunk[i] & CBOR_TYPE_MASK) == CBOR_TYPE_MAP, ERR_INVALID_DATA);
+			}
+			size_t size = (chunkSize - i < attributesEnd - offset) ? chunkSize - i : attributesEnd - offset;
+			cborValidator_feed(&ctx->chunkedAddress.attributesValidator, chunk + i, size);
+			i += size;
+		} else {
+			ASSERT(offset == attributesEnd);
+			VALIDATE(cborValidator_isFinished(&ctx->chunkedAddress.attributesValidator), ERR_INVALID_DATA);
+			VALIDATE(chunk[i] == CARDANO_ADDRESS_TYPE_PUBKEY, ERR_INVALID_DATA);
+			i++;
+		}
+	}
+}
+
+static void signTx_addAddressChunk(const uint8_t* chunk, size_t chunkSize)
+{
+	ASSERT(ctx->chunkedAddress.isInProgress);
+	ASSERT(chunkSize < BUFFER_SIZE_PARANOIA);
+	VALIDATE(chunkSize <= ctx->chunkedAddress.size - ctx->chunkedAddress.received, ERR_INVALID_DATA);
+
+	signTx_checkAddressChunk(chunk, chunkSize);
+
+	txHashBuilder_addOutputAddressChunk(&ctx->txHashBuilder, chunk, chunkSize);
+	blake2b_224_append(&ctx->chunkedAddress.digest, chunk, chunkSize);
+	ctx->chunkedAddress.received += chunkSize;
+	signTx_checkTxSize();
+
+	if (ctx->chunkedAddress.received < ctx->chunkedAddress.size) {
+		// wait for more chunks
+		io_send_buf(SUCCESS, NULL, 0);
+		ui_displayBusy(); // needs to happen after I/O
+		return;
+	}
+
+	txHashBuilder_endOutput(&ctx->txHashBuilder, ctx->currentAmount);
+	ctx->chunkedAddress.isInProgress = false;
+
+	ctx->currentAddress.isDigest = true;
+	blake2b_224_finalize(
+	        &ctx->chunkedAddress.digest,
+	        ctx->currentAddress.digest, SIZEOF(ctx->currentAddress.digest)
+	);
+
+	security_policy_t policy = policyForSignTxOutputAddressDigest(
+	                                   ctx->currentAddress.digest, SIZEOF(ctx->currentAddress.digest)
+	                           );
+	TRACE_EVENT(TRACE_LEVEL_INFO, policy, 0);
+	ENSURE_NOT_DENIED(policy);
+
+	policy = signTx_aggregate_applyPolicy(
+	                 policy,
+	                 ctx->currentAddress.digest, SIZEOF(ctx->currentAddress.digest)
+	         );
+
+	signTx_handleOutput_runPolicy(policy);
+}
+
+static void signTx_handleOutputContinuationAPDU(uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	VALIDATE(ctx->chunkedAddress.isInProgress, ERR_INVALID_STATE);
+	VALIDATE(wireDataSize > 0, ERR_INVALID_DATA);
+
+	signTx_addAddressChunk(wireDataBuffer, wireDataSize);
+}
+
+// Boxed addresses too long for base58 are shown as the digest of the
+// raw address, same as chunked outputs
+static void signTx_useDigestIfTooLong(const uint8_t* rawAddress, size_t rawAddressSize)
+{
+	if (ctx->currentAddress.size <= BASE58_MAX_INPUT_SIZE) return;
+
+	ctx->currentAddress.isDigest = true;
+	blake2b_224_hash(
+	        rawAddress, rawAddressSize,
+	        ctx->currentAddress.digest, SIZEOF(ctx->currentAddress.digest)
+	);
+}
+
 static void signTx_handleOutputAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
 {
-	TRACE();
-	ASSERT(ctx->currentOutput < ctx->numOutputs);
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
 	CHECK_STAGE(SIGN_STAGE_OUTPUTS);
 	ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 
-	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	if (p2 == SIGN_TX_OUTPUT_P2_CONTINUATION) {
+		signTx_handleOutputContinuationAPDU(wireDataBuffer, wireDataSize);
+		return;
+	}
+	VALIDATE(p2 == SIGN_TX_OUTPUT_P2_NEW, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(!ctx->chunkedAddress.isInProgress, ERR_INVALID_STATE);
+	VALIDATE(ctx->currentOutput < signTx_getOutputsLimit(), ERR_INVALID_DATA);
 
 	read_view_t view = make_read_view(wireDataBuffer, wireDataBuffer + wireDataSize);
 
 	// Read data preamble
 	uint64_t amount = parse_u8be(&view);
 	uint8_t outputType = parse_u1be(&view);
-	TRACE("Amount: %u.%06u", (unsigned) (amount / 1000000), (unsigned)(amount % 1000000));
+	TRACE_EVENT(TRACE_LEVEL_INFO, amount >> 32, amount);
 
 	amountSum_incrementBy(&ctx->sumAmountOutputs, amount);
 	ctx->currentAmount = amount;
+	ctx->currentAddress.isDigest = false;
 
-	uint8_t rawAddressBuffer[200];
+	const uint8_t* rawAddressBuffer = NULL;
 	size_t rawAddressSize = 0;
 
 	security_policy_t policy;
 
-	TRACE("Output type %d", (int) outputType);
+	TRACE_EVENT(TRACE_LEVEL_INFO, outputType, 0);
 	switch(outputType) {
 	case SIGN_TX_OUTPUT_TYPE_ADDRESS: {
 		// Rest of input is all address
-		rawAddressSize = unboxChecksummedAddress(
-		                         VIEW_REMAINING_TO_TUPLE_BUF_SIZE(&view),
-		                         rawAddressBuffer, SIZEOF(rawAddressBuffer)
+		size_t boxedAddressSize = view_remainingSize(&view);
+		// Note: ERR_DATA_TOO_LARGE is internal, i.e. would reset the device
+		VALIDATE(boxedAddressSize <= SIZEOF(ctx->currentAddress.buffer), ERR_INVALID_DATA);
+		os_memmove(ctx->currentAddress.buffer, view.ptr, boxedAddressSize);
+		ctx->currentAddress.size = boxedAddressSize;
+
+		// Note: unboxing in place saves us a temporary buffer
+		rawAddressSize = unboxChecksummedAddressInPlace(
+		                         ctx->currentAddress.buffer, ctx->currentAddress.size,
+		                         &rawAddressBuffer
 		                 );
 
 		policy =  policyForSignTxOutputAddress(rawAddressBuffer, rawAddressSize);
-		TRACE("Policy: %d", (int) policy);
+		TRACE_EVENT(TRACE_LEVEL_INFO, policy, 0);
 		ENSURE_NOT_DENIED(policy);
+
+		signTx_useDigestIfTooLong(rawAddressBuffer, rawAddressSize);
 		break;
 	}
 	case SIGN_TX_OUTPUT_TYPE_PATH: {
@@ -288,18 +717,52 @@ static void signTx_handleOutputAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t
 		VALIDATE(view_remainingSize(&view) == 0, ERR_INVALID_DATA);
 
 		policy = policyForSignTxOutputPath(&ctx->currentPath);
-		TRACE("Policy: %d", (int) policy);
+		TRACE_EVENT(TRACE_LEVEL_INFO, policy, 0);
 		ENSURE_NOT_DENIED(policy);
+
+		// Note: our own addresses have no attributes so they are short
+		uint8_t derivedAddressBuffer[64];
 		rawAddressSize = deriveRawAddress(
 		                         &ctx->currentPath,
-		                         rawAddressBuffer, SIZEOF(rawAddressBuffer)
+		                         derivedAddressBuffer, SIZEOF(derivedAddressBuffer)
 		                 );
+		ctx->currentAddress.size = cborPackRawAddressWithChecksum(
+		                                   derivedAddressBuffer, rawAddressSize,
+		                                   ctx->currentAddress.buffer,
+		                                   SIZEOF(ctx->currentAddress.buffer)
+		                           );
+		// Point to the raw address inside the boxed one
+		size_t unboxedSize = unboxChecksummedAddressInPlace(
+		                             ctx->currentAddress.buffer, ctx->currentAddress.size,
+		                             &rawAddressBuffer
+		                     );
+		ASSERT(unboxedSize == rawAddressSize);
 		break;
 	}
+	case SIGN_TX_OUTPUT_TYPE_ADDRESS_CHUNKED: {
+		uint32_t size = parse_u4be(&view);
+		VALIDATE(size >= CHUNKED_ADDRESS_MIN_SIZE, ERR_INVALID_DATA);
+		// Limit of txHashBuilder_beginOutput, below what fits into the transaction
+		STATIC_ASSERT(BUFFER_SIZE_PARANOIA <= CARDANO_MAX_TX_SIZE, "bad chunked address limit");
+		VALIDATE(size < BUFFER_SIZE_PARANOIA, ERR_INVALID_DATA);
+
+		ctx->chunkedAddress.isInProgress = true;
+		ctx->chunkedAddress.size = size;
+		ctx->chunkedAddress.received = 0;
+		cborValidator_init(&ctx->chunkedAddress.attributesValidator);
+		blake2b_224_init(&ctx->chunkedAddress.digest);
+
+		txHashBuilder_beginOutput(&ctx->txHashBuilder, size);
+
+		// Rest of input is the first chunk
+		signTx_addAddressChunk(VIEW_REMAINING_TO_TUPLE_BUF_SIZE(&view));
+		return;
+	}
 	default:
 		THROW(ERR_INVALID_DATA);
 	};
 
+	ASSERT(rawAddressBuffer != NULL);
 	ASSERT(rawAddressSize > 0);
 	ASSERT(rawAddressSize < BUFFER_SIZE_PARANOIA);
 
@@ -309,31 +772,22 @@ static void signTx_handleOutputAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t
 	        rawAddressSize,
 	        amount
 	);
+	signTx_checkTxSize();
 
-	ctx->currentAddress.size = cborPackRawAddressWithChecksum(
-	                                   rawAddressBuffer, rawAddressSize,
-	                                   ctx->currentAddress.buffer,
-	                                   SIZEOF(ctx->currentAddress.buffer)
-	                           );
-
-#	define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
-#	define  DEFAULT(ERR) default: { THROW(ERR); }
-	switch (policy) {
-		CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_OUTPUT_STEP_DISPLAY_AMOUNT);
-		CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_OUTPUT_STEP_RESPOND);
-		DEFAULT(ERR_NOT_IMPLEMENTED)
+	// Note: change outputs are not part of the summary
+	if (outputType == SIGN_TX_OUTPUT_TYPE_ADDRESS) {
+		policy = signTx_aggregate_applyPolicyForRawAddress(policy, rawAddressBuffer, rawAddressSize);
 	}
-#	undef   CASE
-#	undef   DEFAULT
 
-	signTx_handleOutput_ui_runStep();
+	signTx_handleOutput_runPolicy(policy);
 }
 
 
 static void signTx_handleOutput_ui_runStep()
 {
-	TRACE("step %d", ctx->ui_step);
+	TRACE_EVENT(TRACE_LEVEL_INFO, ctx->ui_step, 0);
 	ui_callback_fn_t* this_fn = signTx_handleOutput_ui_runStep;
+	bool shouldResumeRawTx = false;
 
 	UI_STEP_BEGIN(ctx->ui_step);
 
@@ -347,52 +801,502 @@ static void signTx_handleOutput_ui_runStep()
 		);
 	}
 	UI_STEP(HANDLE_OUTPUT_STEP_DISPLAY_ADDRESS) {
-		char address58Str[200];
-		ASSERT(ctx->currentAddress.size <= SIZEOF(ctx->currentAddress.buffer));
-		encode_base58(
-		        ctx->currentAddress.buffer,
-		        ctx->currentAddress.size,
-		        address58Str,
-		        SIZEOF(address58Str)
-		);
-
-		ui_displayPaginatedText(
-		        "To address",
-		        address58Str,
-		        this_fn
-		);
+		if (ctx->currentAddress.isDigest) {
+			// Address is too long to be kept, show its digest instead
+			char digestStr[2 * BLAKE2B_224_SIZE + 1];
+			snprintf(
+			        digestStr, SIZEOF(digestStr), "%.*h",
+			        (int) SIZEOF(ctx->currentAddress.digest), ctx->currentAddress.digest
+			);
+			ui_displayPaginatedText(
+			        "To address hash",
+			        digestStr,
+			        this_fn
+			);
+		} else {
+			char address58Str[200];
+			ASSERT(ctx->currentAddress.size <= SIZEOF(ctx->currentAddress.buffer));
+			encode_base58(
+			        ctx->currentAddress.buffer,
+			        ctx->currentAddress.size,
+			        address58Str,
+			        SIZEOF(address58Str)
+			);
+
+			ui_displayPaginatedText(
+			        "To address",
+			        address58Str,
+			        this_fn
+			);
+		}
 	}
 	UI_STEP(HANDLE_OUTPUT_STEP_RESPOND) {
 		// Advance state to next output
 		ctx->currentOutput++;
-		// Transition to outputs
-		if (ctx->currentOutput == ctx->numOutputs) {
-			txHashBuilder_enterMetadata(&ctx->txHashBuilder);
-			ctx->stage = SIGN_STAGE_CONFIRM;
+		if (ctx->isRawTx) {
+			// Rest of the received data still has to be parsed
+			shouldResumeRawTx = true;
+		} else {
+			// Transition to (optional) metadata
+			// Note: with unspecified counts the host ends outputs explicitly
+			if (!ctx->hasUnspecifiedCounts && ctx->currentOutput == ctx->numOutputs) {
+				ctx->stage = SIGN_STAGE_METADATA;
+			}
+
+			// respond
+			io_send_buf(SUCCESS, NULL, 0);
+			ui_displayBusy();
 		}
+	}
+	UI_STEP_END(HANDLE_OUTPUT_STEP_INVALID);
+
+	// Note: this has to be done only after UI_STEP_END
+	// as parsing might display the next output
+	if (shouldResumeRawTx) {
+		signTx_rawTx_resumeParsing();
+	}
+}
+
+
+// Transaction attributes/metadata are streamed in chunks directly
+// into the tx hash. We only keep constant-size validator state
+// and never buffer the whole metadata.
+static void signTx_handleMetadataAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
+	CHECK_STAGE(SIGN_STAGE_METADATA);
+	ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+
+	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize > 0, ERR_INVALID_DATA);
+
+	if (!ctx->metadata.isPresent) {
+		// Attributes must be a map
+		VALIDATE((wireDataBuffer[0] & CBOR_TYPE_MASK) == CBOR_TYPE_MAP, ERR_INVALID_DATA);
+
+		txHashBuilder_enterMetadataChunks(&ctx->txHashBuilder);
+		cborValidator_init(&ctx->metadataValidator);
+		ctx->metadata.isPresent = true;
+		ctx->metadata.size = 0;
+	}
+
+	// Note: validate before hashing so that the hash never sees malformed data
+	cborValidator_feed(&ctx->metadataValidator, wireDataBuffer, wireDataSize);
+	txHashBuilder_addMetadataChunk(&ctx->txHashBuilder, wireDataBuffer, wireDataSize);
+	ctx->metadata.size += wireDataSize;
+	signTx_checkTxSize();
+
+	if (cborValidator_isFinished(&ctx->metadataValidator)) {
+		txHashBuilder_finishMetadataChunks(&ctx->txHashBuilder);
+		ctx->stage = SIGN_STAGE_CONFIRM;
+	}
+
+	io_send_buf(SUCCESS, NULL, 0);
+	ui_displayBusy(); // needs to happen after I/O
+}
+
+
+// Explicit end of inputs/outputs when counts were not given at init
+static void signTx_handleEndOfInputsAPDU(uint8_t p2, uint8_t* wireDataBuffer MARK_UNUSED, size_t wireDataSize)
+{
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
+	CHECK_STAGE(SIGN_STAGE_INPUTS);
+	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(ctx->hasUnspecifiedCounts, ERR_INVALID_STATE);
+	// Note: at least one input is assumed by the rest of the code
+	VALIDATE(ctx->currentInput > 0, ERR_INVALID_DATA);
+
+	ctx->numInputs = ctx->currentInput;
+	// see signTx_handleInitAPDU
+	VALIDATE(ctx->numWitnesses <= ctx->numInputs, ERR_INVALID_DATA);
+	signTx_finishInputs();
+
+	io_send_buf(SUCCESS, NULL, 0);
+	ui_displayBusy(); // needs to happen after I/O
+}
+
+static void signTx_handleEndOfOutputsAPDU(uint8_t p2, uint8_t* wireDataBuffer MARK_UNUSED, size_t wireDataSize)
+{
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
+	CHECK_STAGE(SIGN_STAGE_OUTPUTS);
+	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(ctx->hasUnspecifiedCounts, ERR_INVALID_STATE);
+	VALIDATE(!ctx->chunkedAddress.isInProgress, ERR_INVALID_STATE);
+	VALIDATE(ctx->currentOutput > 0, ERR_INVALID_DATA);
+
+	ctx->numOutputs = ctx->currentOutput;
+	ctx->stage = SIGN_STAGE_METADATA;
+
+	io_send_buf(SUCCESS, NULL, 0);
+	ui_displayBusy(); // needs to happen after I/O
+}
+
+
+static void signTx_handleNextTxAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
+	CHECK_STAGE(SIGN_STAGE_SESSION);
+	ASSERT(ctx->session.isActive);
+	VALIDATE(ctx->session.numTxs < SIGN_TX_SESSION_MAX_TXS, ERR_INVALID_DATA);
+
+	signTx_initTransaction(p2, wireDataBuffer, wireDataSize);
+
+	// Note: user already agreed to the session
+	ctx->ui_step = HANDLE_INIT_STEP_RESPOND;
+	signTx_handleInit_ui_runStep();
+}
+
+static void signTx_handleFinishSession_ui_runStep();
+enum {
+	HANDLE_FINISH_SESSION_STEP_DISPLAY_COUNT = 700,
+	HANDLE_FINISH_SESSION_STEP_DISPLAY_FEE,
+	HANDLE_FINISH_SESSION_STEP_FINAL_CONFIRM,
+	HANDLE_FINISH_SESSION_STEP_RESPOND,
+	HANDLE_FINISH_SESSION_STEP_INVALID,
+};
+
+static void signTx_handleFinishSessionAPDU(uint8_t p2, uint8_t* wireDataBuffer MARK_UNUSED, size_t wireDataSize)
+{
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
+	CHECK_STAGE(SIGN_STAGE_SESSION);
+	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	ASSERT(ctx->session.isActive);
+	ASSERT(ctx->session.numTxs > 0);
+
+	// Witnesses of all transactions
+	ctx->numWitnesses = 0;
+	for (size_t i = 0; i < ctx->session.numTxs; i++) {
+		ctx->numWitnesses += ctx->session.txs[i].numWitnesses;
+	}
+	ctx->currentWitness = 0;
+
+	ctx->ui_step = HANDLE_FINISH_SESSION_STEP_DISPLAY_COUNT;
+	signTx_handleFinishSession_ui_runStep();
+}
+
+static void signTx_handleFinishSession_ui_runStep()
+{
+	TRACE_EVENT(TRACE_LEVEL_INFO, ctx->ui_step, 0);
+	ui_callback_fn_t* this_fn = signTx_handleFinishSession_ui_runStep;
+
+	UI_STEP_BEGIN(ctx->ui_step);
+
+	UI_STEP(HANDLE_FINISH_SESSION_STEP_DISPLAY_COUNT) {
+		char countStr[30];
+		snprintf(countStr, SIZEOF(countStr), "%u transactions", (unsigned) ctx->session.numTxs);
+		ui_displayPaginatedText(
+		        "Signing session",
+		        countStr,
+		        this_fn
+		);
+	}
+	UI_STEP(HANDLE_FINISH_SESSION_STEP_DISPLAY_FEE) {
+		char adaAmount[50];
+		str_formatAdaAmount(adaAmount, SIZEOF(adaAmount), ctx->session.sumFees);
+		ui_displayPaginatedText(
+		        "Total fee",
+		        adaAmount,
+		        this_fn
+		);
+	}
+	UI_STEP(HANDLE_FINISH_SESSION_STEP_FINAL_CONFIRM) {
+		ui_displayPrompt(
+		        "Confirm all",
+		        "transactions?",
+		        this_fn,
+		        respond_with_user_reject
+		);
+	}
+	UI_STEP(HANDLE_FINISH_SESSION_STEP_RESPOND) {
+		// switch stage
+		signTx_beginWitnesses();
 
 		// respond
 		io_send_buf(SUCCESS, NULL, 0);
 		ui_displayBusy();
 	}
-	UI_STEP_END(HANDLE_OUTPUT_STEP_INVALID);
+	UI_STEP_END(HANDLE_FINISH_SESSION_STEP_INVALID);
 }
 
 
+static void signTx_rawTx_addInput()
+{
+	const tx_parser_state_t* parser = &ctx->rawTx.parser;
+	// Note: all attested inputs are in at this point
+	VALIDATE(parser->numInputs <= ctx->numInputs, ERR_INVALID_DATA);
+
+	signTx_chainInputDigest(ctx->rawTx.parsedInputsDigest, parser->input.txHash, parser->input.index);
+}
+
+// Returns true if the output does not need user interaction
+static bool signTx_rawTx_addOutput()
+{
+	const tx_parser_state_t* parser = &ctx->rawTx.parser;
+	VALIDATE(parser->numOutputs <= signTx_getOutputsLimit(), ERR_INVALID_DATA);
+
+	uint64_t amount = parser->output.amount;
+	TRACE_EVENT(TRACE_LEVEL_INFO, amount >> 32, amount);
+	amountSum_incrementBy(&ctx->sumAmountOutputs, amount);
+	ctx->currentAmount = amount;
+
+	ctx->currentAddress.isDigest = false;
+	ctx->currentAddress.size = cborPackRawAddressWithChecksum(
+	                                   parser->output.rawAddress, parser->output.rawAddressSize,
+	                                   ctx->currentAddress.buffer, SIZEOF(ctx->currentAddress.buffer)
+	                           );
+	signTx_useDigestIfTooLong(parser->output.rawAddress, parser->output.rawAddressSize);
+
+	security_policy_t policy = policyForSignTxOutputAddress(
+	                                   parser->output.rawAddress, parser->output.rawAddressSize
+	                           );
+	TRACE_EVENT(TRACE_LEVEL_INFO, policy, 0);
+	ENSURE_NOT_DENIED(policy);
+
+	policy = signTx_aggregate_applyPolicyForRawAddress(
+	                 policy,
+	                 parser->output.rawAddress, parser->output.rawAddressSize
+	         );
+
+	if (policy == POLICY_ALLOW_WITHOUT_PROMPT || policy == POLICY_SHOW_AGGREGATED) {
+		// Note: avoid going through UI steps as they would resume parsing recursively
+		ctx->currentOutput++;
+		return true;
+	}
+	signTx_handleOutput_runPolicy(policy);
+	return false;
+}
+
+static void signTx_rawTx_finish()
+{
+	const tx_parser_state_t* parser = &ctx->rawTx.parser;
+
+	// We should not have any data left
+	VALIDATE(stream_availableBytes(&parser->stream) == 0, ERR_INVALID_DATA);
+	VALIDATE(parser->numInputs == ctx->numInputs, ERR_INVALID_DATA);
+	if (ctx->hasUnspecifiedCounts) {
+		VALIDATE(parser->numOutputs > 0, ERR_INVALID_DATA);
+		ctx->numOutputs = parser->numOutputs;
+	}
+	VALIDATE(parser->numOutputs == ctx->numOutputs, ERR_INVALID_DATA);
+	ASSERT(ctx->currentOutput == ctx->numOutputs);
+	VALIDATE(
+	        os_memcmp(
+	                ctx->rawTx.attestedInputsDigest,
+	                ctx->rawTx.parsedInputsDigest,
+	                SIZEOF(ctx->rawTx.parsedInputsDigest)
+	        ) == 0,
+	        ERR_INVALID_DATA
+	);
+
+	// Anything but an empty map is displayed as metadata
+	ctx->metadata.isPresent = parser->attributes.size > 1;
+	ctx->metadata.size = parser->attributes.size;
+
+	ctx->stage = SIGN_STAGE_CONFIRM;
+}
+
+// Parses as much of the received data as possible. Stops
+// when an output has to be shown to the user
+static void signTx_rawTx_keepParsing()
+{
+	BEGIN_TRY {
+		TRY {
+			bool shouldContinue = true;
+			while (shouldContinue) {
+				tx_parser_event_t event = txParser_keepParsing(&ctx->rawTx.parser);
+				switch (event) {
+				case TX_PARSER_EVENT_INPUT:
+					signTx_rawTx_addInput();
+					break;
+				case TX_PARSER_EVENT_OUTPUT:
+					shouldContinue = signTx_rawTx_addOutput();
+					break;
+				case TX_PARSER_EVENT_FINISHED:
+					signTx_rawTx_finish();
+					io_send_buf(SUCCESS, NULL, 0);
+					ui_displayBusy(); // needs to happen after I/O
+					shouldContinue = false;
+					break;
+				default:
+					ASSERT(false);
+				}
+			}
+		}
+		CATCH(ERR_NOT_ENOUGH_INPUT)
+		{
+			// Respond that we need more data
+			io_send_buf(SUCCESS, NULL, 0);
+			ui_displayBusy(); // needs to happen after I/O
+		}
+		CATCH(ERR_UNEXPECTED_TOKEN)
+		{
+			// Convert to ERR_INVALID_DATA
+			THROW(ERR_INVALID_DATA);
+		}
+		FINALLY {
+		}
+	} END_TRY;
+}
+
+// Called from UI callback where errors are not turned
+// into responses by the main loop
+static void signTx_rawTx_resumeParsing()
+{
+	BEGIN_TRY {
+		TRY {
+			signTx_rawTx_keepParsing();
+		}
+		CATCH_OTHER(e)
+		{
+			if (e >= _ERR_AUTORESPOND_START && e < _ERR_AUTORESPOND_END) {
+				io_send_buf(e, NULL, 0);
+				ui_idle();
+			} else {
+				THROW(e);
+			}
+		}
+		FINALLY {
+		}
+	} END_TRY;
+}
+
+// Serialized transaction body streamed in chunks. We hash exactly
+// the bytes we receive and parse them only to learn what is signed
+static void signTx_handleRawTxAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
+	CHECK_STAGE(SIGN_STAGE_RAW_TX);
+	ASSERT(ctx->isRawTx);
+	ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+
+	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize > 0, ERR_INVALID_DATA);
+
+	stream_t* stream = &ctx->rawTx.parser.stream;
+	VALIDATE(wireDataSize <= stream_unusedBytes(stream), ERR_INVALID_DATA);
+	stream_appendData(stream, wireDataBuffer, wireDataSize);
+
+	txHashBuilder_appendRaw(&ctx->txHashBuilder, wireDataBuffer, wireDataSize);
+	signTx_checkTxSize();
+
+	signTx_rawTx_keepParsing();
+}
+
+
+static void signTx_displayMetadataSize(ui_callback_fn_t* callback)
+{
+	char sizeStr[30];
+	snprintf(sizeStr, SIZEOF(sizeStr), "%u bytes", (unsigned) ctx->metadata.size);
+	ui_displayPaginatedText(
+	        "Tx metadata",
+	        sizeStr,
+	        callback
+	);
+}
+
+static void signTx_handleSessionTx_ui_runStep();
+enum {
+	HANDLE_SESSION_TX_STEP_DISPLAY_METADATA = 600,
+	HANDLE_SESSION_TX_STEP_RESPOND,
+	HANDLE_SESSION_TX_STEP_INVALID,
+};
+
+// Within a session the fee and confirmation are reviewed once for
+// all transactions, here we just remember the transaction
+static void signTx_addTxToSession()
+{
+	ASSERT(ctx->session.isActive);
+	ASSERT(ctx->session.numTxs < SIGN_TX_SESSION_MAX_TXS);
+
+	sign_tx_session_entry_t* entry = &ctx->session.txs[ctx->session.numTxs];
+	os_memmove(entry->txHash, ctx->txHash, SIZEOF(entry->txHash));
+	entry->numWitnesses = ctx->numWitnesses;
+	entry->currentWitness = 0;
+	entry->hasDeclaredNumWitnesses = ctx->hasDeclaredNumWitnesses;
+	if (entry->hasDeclaredNumWitnesses) {
+		// Paths of all transactions share the table
+		size_t numPaths = 0;
+		for (size_t i = 0; i <= ctx->session.numTxs; i++) {
+			if (ctx->session.txs[i].hasDeclaredNumWitnesses) {
+				numPaths += ctx->session.txs[i].numWitnesses;
+			}
+		}
+		VALIDATE(numPaths <= SIGN_TX_MAX_WITNESS_PATHS, ERR_INVALID_DATA);
+	}
+
+	amountSum_incrementBy(&ctx->session.sumFees, ctx->currentAmount);
+	ctx->session.numTxs++;
+
+	ctx->ui_step = HANDLE_SESSION_TX_STEP_RESPOND;
+	if (ctx->metadata.isPresent) {
+		security_policy_t metadataPolicy = policyForSignTxMetadata(ctx->metadata.size);
+		ENSURE_NOT_DENIED(metadataPolicy);
+
+#		define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
+#		define  DEFAULT(ERR) default: { THROW(ERR); }
+		switch (metadataPolicy) {
+			CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_SESSION_TX_STEP_DISPLAY_METADATA);
+			CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_SESSION_TX_STEP_RESPOND);
+			DEFAULT(ERR_NOT_IMPLEMENTED);
+		}
+#		undef   CASE
+#		undef   DEFAULT
+	}
+	signTx_handleSessionTx_ui_runStep();
+}
+
+static void signTx_handleSessionTx_ui_runStep()
+{
+	TRACE_EVENT(TRACE_LEVEL_INFO, ctx->ui_step, 0);
+	ui_callback_fn_t* this_fn = signTx_handleSessionTx_ui_runStep;
+
+	UI_STEP_BEGIN(ctx->ui_step);
+
+	UI_STEP(HANDLE_SESSION_TX_STEP_DISPLAY_METADATA) {
+		signTx_displayMetadataSize(this_fn);
+	}
+	UI_STEP(HANDLE_SESSION_TX_STEP_RESPOND) {
+		// wait for the next transaction
+		ctx->stage = SIGN_STAGE_SESSION;
+
+		io_send_buf(SUCCESS, ctx->txHash, SIZEOF(ctx->txHash));
+		ui_displayBusy();
+	}
+	UI_STEP_END(HANDLE_SESSION_TX_STEP_INVALID);
+}
+
 static void signTx_handleConfirm_ui_runStep();
+static void signTx_handleAggregateReview_ui_runStep();
 enum {
-	HANDLE_CONFIRM_STEP_DISPLAY_FEE = 400,
+	HANDLE_CONFIRM_STEP_DISPLAY_METADATA = 400,
+	HANDLE_CONFIRM_STEP_DISPLAY_FEE,
 	HANDLE_CONFIRM_STEP_FINAL_CONFIRM,
 	HANDLE_CONFIRM_STEP_RESPOND,
 	HANDLE_CONFIRM_STEP_INVALID,
 };
 
+enum {
+	HANDLE_AGGREGATE_STEP_DISPLAY_COUNTS = 800,
+	HANDLE_AGGREGATE_STEP_DISPLAY_AMOUNT,
+	HANDLE_AGGREGATE_STEP_DONE,
+	HANDLE_AGGREGATE_STEP_INVALID,
+};
+
 static void signTx_handleConfirmAPDU(uint8_t p2, uint8_t* dataBuffer MARK_UNUSED, size_t dataSize)
 {
-	TRACE();
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
 	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
 	VALIDATE(dataSize == 0, ERR_INVALID_REQUEST_PARAMETERS);
 
+	if (ctx->stage == SIGN_STAGE_METADATA) {
+		// Either no metadata (empty attributes) or incomplete metadata
+		VALIDATE(!ctx->metadata.isPresent, ERR_INVALID_STATE);
+		txHashBuilder_enterMetadata(&ctx->txHashBuilder);
+		ctx->stage = SIGN_STAGE_CONFIRM;
+	}
 	CHECK_STAGE(SIGN_STAGE_CONFIRM);
 	VALIDATE(ctx->sumAmountInputs > ctx->sumAmountOutputs, ERR_INVALID_DATA);
 
@@ -403,7 +1307,17 @@ static void signTx_handleConfirmAPDU(uint8_t p2, uint8_t* dataBuffer MARK_UNUSED
 
 	ctx->currentAmount = ctx->sumAmountInputs - ctx->sumAmountOutputs;
 
-	security_policy_t policy = policyForSignTxFee(ctx->currentAmount);
+	// Body and inputs are complete, the size assumes a witness per input
+	signTx_checkTxSize();
+	size_t signedTxSize = signTx_getSignedTxSizeLowerBound();
+
+	security_policy_t policy = policyForSignTxFee(ctx->currentAmount, signedTxSize);
+	ENSURE_NOT_DENIED(policy);
+
+	if (ctx->session.isActive) {
+		signTx_addTxToSession();
+		return;
+	}
 
 #	define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
 #	define  DEFAULT(ERR) default: { THROW(ERR); }
@@ -411,20 +1325,42 @@ static void signTx_handleConfirmAPDU(uint8_t p2, uint8_t* dataBuffer MARK_UNUSED
 		CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_CONFIRM_STEP_DISPLAY_FEE);
 		DEFAULT(ERR_NOT_IMPLEMENTED);
 	}
+
+	if (ctx->metadata.isPresent) {
+		security_policy_t metadataPolicy = policyForSignTxMetadata(ctx->metadata.size);
+		ENSURE_NOT_DENIED(metadataPolicy);
+		switch (metadataPolicy) {
+			CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_CONFIRM_STEP_DISPLAY_METADATA);
+			// Note: fee is displayed anyway
+			CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_CONFIRM_STEP_DISPLAY_FEE);
+			DEFAULT(ERR_NOT_IMPLEMENTED);
+		}
+	}
 #	undef   CASE
 #	undef   DEFAULT
 
+	if (ctx->aggregate.isEnabled && ctx->aggregate.numOutputs > 0) {
+		// Summary of outputs goes first, then the usual confirm steps
+		ctx->aggregate.confirmStep = ctx->ui_step;
+		ctx->ui_step = HANDLE_AGGREGATE_STEP_DISPLAY_COUNTS;
+		signTx_handleAggregateReview_ui_runStep();
+		return;
+	}
+
 	signTx_handleConfirm_ui_runStep();
 }
 
 
 static void signTx_handleConfirm_ui_runStep()
 {
-	TRACE("step %d", ctx->ui_step);
+	TRACE_EVENT(TRACE_LEVEL_INFO, ctx->ui_step, 0);
 	ui_callback_fn_t* this_fn = signTx_handleConfirm_ui_runStep;
 
 	UI_STEP_BEGIN(ctx->ui_step);
 
+	UI_STEP(HANDLE_CONFIRM_STEP_DISPLAY_METADATA) {
+		signTx_displayMetadataSize(this_fn);
+	}
 	UI_STEP(HANDLE_CONFIRM_STEP_DISPLAY_FEE) {
 		char adaAmount[50];
 		str_formatAdaAmount(adaAmount, SIZEOF(adaAmount), ctx->currentAmount);
@@ -444,7 +1380,7 @@ static void signTx_handleConfirm_ui_runStep()
 	}
 	UI_STEP(HANDLE_CONFIRM_STEP_RESPOND) {
 		// switch stage
-		ctx->stage = SIGN_STAGE_WITNESSES;
+		signTx_beginWitnesses();
 
 		// respond
 		io_send_buf(SUCCESS, ctx->txHash, SIZEOF(ctx->txHash));
@@ -453,6 +1389,51 @@ static void signTx_handleConfirm_ui_runStep()
 	UI_STEP_END(HANDLE_CONFIRM_STEP_INVALID);
 }
 
+// Outputs to trusted addresses
+static void signTx_handleAggregateReview_ui_runStep()
+{
+	TRACE_EVENT(TRACE_LEVEL_INFO, ctx->ui_step, 0);
+	ui_callback_fn_t* this_fn = signTx_handleAggregateReview_ui_runStep;
+	bool shouldContinueConfirm = false;
+
+	UI_STEP_BEGIN(ctx->ui_step);
+
+	UI_STEP(HANDLE_AGGREGATE_STEP_DISPLAY_COUNTS) {
+		char countsStr[50];
+		snprintf(
+		        countsStr, SIZEOF(countsStr), "%u to %u address%s",
+		        (unsigned) ctx->aggregate.numOutputs,
+		        (unsigned) ctx->aggregate.numAddresses,
+		        ctx->aggregate.numAddresses == 1 ? "" : "es"
+		);
+		ui_displayPaginatedText(
+		        "Trusted outputs",
+		        countsStr,
+		        this_fn
+		);
+	}
+	UI_STEP(HANDLE_AGGREGATE_STEP_DISPLAY_AMOUNT) {
+		char adaAmountStr[50];
+		str_formatAdaAmount(adaAmountStr, SIZEOF(adaAmountStr), ctx->aggregate.sumAmount);
+		ui_displayPaginatedText(
+		        "Send ADA in total",
+		        adaAmountStr,
+		        this_fn
+		);
+	}
+	UI_STEP(HANDLE_AGGREGATE_STEP_DONE) {
+		shouldContinueConfirm = true;
+	}
+	UI_STEP_END(HANDLE_AGGREGATE_STEP_INVALID);
+
+	// Note: this has to be done only after UI_STEP_END
+	// as confirm steps share ctx->ui_step
+	if (shouldContinueConfirm) {
+		ctx->ui_step = ctx->aggregate.confirmStep;
+		signTx_handleConfirm_ui_runStep();
+	}
+}
+
 static void signTx_handleWitness_ui_runStep();
 enum {
 	HANDLE_WITNESS_STEP_WARNING = 500,
@@ -462,26 +1443,106 @@ enum {
 	HANDLE_WITNESS_STEP_INVALID,
 };
 
+static bool signTx_hasDeclaredNumWitnesses(uint8_t txIndex)
+{
+	if (ctx->session.isActive) {
+		ASSERT(txIndex < ctx->session.numTxs);
+		return ctx->session.txs[txIndex].hasDeclaredNumWitnesses;
+	}
+	return ctx->hasDeclaredNumWitnesses;
+}
+
+// Note: transactions of a session share the table, so the digest
+// covers the transaction index too
+static void signTx_writeWitnessPathDigest(
+        uint8_t txIndex, const bip44_path_t* path,
+        uint8_t* out, size_t outSize
+)
+{
+	ASSERT(outSize == SIGN_TX_WITNESS_PATH_DIGEST_SIZE);
+	ASSERT(path->length <= ARRAY_LEN(path->path));
+
+	uint8_t buffer[1 + 1 + 4 * BIP44_MAX_PATH_LENGTH];
+	size_t size = 0;
+	buffer[size++] = txIndex;
+	buffer[size++] = (uint8_t) path->length;
+	for (size_t i = 0; i < path->length; i++) {
+		u4be_write(buffer + size, path->path[i]);
+		size += 4;
+	}
+
+	uint8_t digest[BLAKE2B_224_SIZE];
+	blake2b_224_hash(buffer, size, digest, SIZEOF(digest));
+	os_memmove(out, digest, outSize);
+}
+
+static bool signTx_isSignedWitnessPath(const uint8_t* digest)
+{
+	for (size_t i = 0; i < ctx->witnessPaths.count; i++) {
+		if (os_memcmp(ctx->witnessPaths.digests[i], digest, SIGN_TX_WITNESS_PATH_DIGEST_SIZE) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
 static void signTx_handleWitnessAPDU(uint8_t p2, uint8_t* dataBuffer, size_t dataSize)
 {
-	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	CHECK_STAGE(SIGN_STAGE_WITNESSES);
 	ASSERT(ctx->currentWitness < ctx->numWitnesses);
 
+	// Within a session P2 is the index of the transaction
+	const uint8_t txIndex = p2;
+	if (ctx->session.isActive) {
+		VALIDATE(txIndex < ctx->session.numTxs, ERR_INVALID_REQUEST_PARAMETERS);
+		const sign_tx_session_entry_t* entry = &ctx->session.txs[txIndex];
+		VALIDATE(entry->currentWitness < entry->numWitnesses, ERR_INVALID_DATA);
+	} else {
+		VALIDATE(txIndex == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	}
 
-	size_t parsedSize = bip44_parseFromWire(&ctx->currentPath, dataBuffer, dataSize);
+	bip44_path_t path;
+	size_t parsedSize = bip44_parseFromWire(&path, dataBuffer, dataSize);
 	VALIDATE(parsedSize == dataSize, ERR_INVALID_DATA);
 
+	// With a declared number of witnesses, these are counted per unique
+	// path (e.g. several inputs of the same address), otherwise per request
+	if (signTx_hasDeclaredNumWitnesses(txIndex)) {
+		signTx_writeWitnessPathDigest(
+		        txIndex, &path,
+		        ctx->witnessPaths.currentDigest, SIZEOF(ctx->witnessPaths.currentDigest)
+		);
+
+		if (signTx_isSignedWitnessPath(ctx->witnessPaths.currentDigest)) {
+			// Each path is signed once and we keep only the last witness,
+			// i.e. the host has to group requests of the same path
+			VALIDATE(txIndex == ctx->session.currentTx, ERR_INVALID_DATA);
+			VALIDATE(bip44_isEqual(&path, &ctx->currentPath), ERR_INVALID_DATA);
+
+			// Same path as the previous witness, respond without signing again
+			TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
+			io_send_buf(SUCCESS, ctx->currentWitnessData, SIZEOF(ctx->currentWitnessData));
+			ui_displayBusy(); // needs to happen after I/O
+			return;
+		}
+	}
+	ctx->currentPath = path;
+	ctx->session.currentTx = txIndex;
+	if (ctx->session.isActive) {
+		os_memmove(ctx->txHash, ctx->session.txs[txIndex].txHash, SIZEOF(ctx->txHash));
+	}
+
 	security_policy_t policy = policyForSignTxWitness(&ctx->currentPath);
 	ENSURE_NOT_DENIED(policy);
 
-	TRACE("getTxWitness");
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
 	getTxWitness(
 	        &ctx->currentPath,
 	        ctx->txHash, SIZEOF(ctx->txHash),
 	        ctx->currentWitnessData, SIZEOF(ctx->currentWitnessData)
 	);
 
-	TRACE("policy %d", (int) policy);
+	TRACE_EVENT(TRACE_LEVEL_INFO, policy, 0);
 
 #	define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
 #	define  DEFAULT(ERR) default: { THROW(ERR); }
@@ -498,7 +1559,7 @@ static void signTx_handleWitnessAPDU(uint8_t p2, uint8_t* dataBuffer, size_t dat
 
 static void signTx_handleWitness_ui_runStep()
 {
-	TRACE("step %d", ctx->ui_step);
+	TRACE_EVENT(TRACE_LEVEL_INFO, ctx->ui_step, 0);
 	ui_callback_fn_t* this_fn = signTx_handleWitness_ui_runStep;
 
 	UI_STEP_BEGIN(ctx->ui_step);
@@ -511,7 +1572,7 @@ static void signTx_handleWitness_ui_runStep()
 		);
 	}
 	UI_STEP(HANDLE_WITNESS_STEP_DISPLAY) {
-		char pathStr[100];
+		char pathStr[BIP44_PATH_STRING_SIZE];
 		bip44_printToStr(&ctx->currentPath, pathStr, SIZEOF(pathStr));
 		ui_displayPaginatedText(
 		        "Witness path",
@@ -528,12 +1589,22 @@ static void signTx_handleWitness_ui_runStep()
 		);
 	}
 	UI_STEP(HANDLE_WITNESS_STEP_RESPOND) {
-		TRACE("io_send_buf");
+		TRACE_EVENT(TRACE_LEVEL_DEBUG, ctx->stage, 0);
 
 		io_send_buf(SUCCESS, ctx->currentWitnessData, SIZEOF(ctx->currentWitnessData));
 		ui_displayBusy(); // needs to happen after I/O
 
+		if (signTx_hasDeclaredNumWitnesses(ctx->session.currentTx)) {
+			ASSERT(ctx->witnessPaths.count < SIGN_TX_MAX_WITNESS_PATHS);
+			os_memmove(
+			        ctx->witnessPaths.digests[ctx->witnessPaths.count++],
+			        ctx->witnessPaths.currentDigest, SIGN_TX_WITNESS_PATH_DIGEST_SIZE
+			);
+		}
 		ctx->currentWitness++;
+		if (ctx->session.isActive) {
+			ctx->session.txs[ctx->session.currentTx].currentWitness++;
+		}
 		if (ctx->currentWitness == ctx->numWitnesses) {
 			ctx->stage = SIGN_STAGE_NONE;
 			// We are finished
@@ -557,6 +1628,12 @@ static subhandler_fn_t* lookup_subhandler(uint8_t p1)
 		CASE(0x03, signTx_handleOutputAPDU);
 		CASE(0x04, signTx_handleConfirmAPDU);
 		CASE(0x05, signTx_handleWitnessAPDU);
+		CASE(0x06, signTx_handleMetadataAPDU);
+		CASE(0x07, signTx_handleRawTxAPDU);
+		CASE(0x08, signTx_handleEndOfInputsAPDU);
+		CASE(0x09, signTx_handleEndOfOutputsAPDU);
+		CASE(0x0A, signTx_handleNextTxAPDU);
+		CASE(0x0B, signTx_handleFinishSessionAPDU);
 		DEFAULT(NULL)
 #	undef   CASE
 #	undef   DEFAULT
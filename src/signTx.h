@@ -6,6 +6,9 @@
 #include "handlers.h"
 #include "txHashBuilder.h"
 #include "bip44.h"
+#include "cborValidator.h"
+#include "txParser.h"
+#include "txInputSet.h"
 
 typedef enum {
 	SIGN_STAGE_NONE = 0,
@@ -13,15 +16,38 @@ typedef enum {
 	SIGN_STAGE_OUTPUTS = 25,
 	SIGN_STAGE_CONFIRM = 26,
 	SIGN_STAGE_WITNESSES = 27,
+	SIGN_STAGE_METADATA = 28,
+	SIGN_STAGE_RAW_TX = 29,
+	// Between transactions of a session
+	SIGN_STAGE_SESSION = 30,
 } sign_tx_stage_t;
 
 enum {
 	SIGN_MAX_INPUTS = 1000,
 	SIGN_MAX_OUTPUTS = 1000,
+	SIGN_TX_SESSION_MAX_TXS = 8,
+	// Unique witness paths of a transaction (or session) with a declared
+	// number of witnesses, more witnesses would not fit into the tx anyway
+	SIGN_TX_MAX_WITNESS_PATHS = 32,
+	SIGN_TX_WITNESS_PATH_DIGEST_SIZE = 8,
 };
 
+// Transaction already confirmed within a session
+typedef struct {
+	uint8_t txHash[32];
+	uint16_t numWitnesses;
+	uint16_t currentWitness;
+	bool hasDeclaredNumWitnesses;
+} sign_tx_session_entry_t;
+
 typedef struct {
 	sign_tx_stage_t stage;
+	// Transaction body is streamed as serialized cbor
+	bool isRawTx;
+	// Inputs/outputs are ended by the host instead of being counted
+	bool hasUnspecifiedCounts;
+	// Witnesses are counted per unique path instead of per input
+	bool hasDeclaredNumWitnesses;
 	uint16_t numInputs;
 	uint16_t numOutputs;
 	uint16_t numWitnesses;
@@ -32,15 +58,85 @@ typedef struct {
 
 	uint64_t sumAmountInputs;
 	uint64_t sumAmountOutputs;
-	tx_hash_builder_t txHashBuilder;
 	uint8_t txHash[32];
-	uint8_t currentWitnessData[64];
 	uint64_t currentAmount;
 	struct {
-		uint8_t buffer[200];
+		bool isPresent;
 		size_t size;
-	} currentAddress;
+	} metadata;
 	bip44_path_t currentPath;
+	// Several transactions reviewed by the user at once
+	struct {
+		bool isActive;
+		uint8_t numTxs;
+		sign_tx_session_entry_t txs[SIGN_TX_SESSION_MAX_TXS];
+		uint64_t sumFees;
+		// Transaction of the last witness
+		uint8_t currentTx;
+	} session;
+	// Note: the body is complete (and the user confirmed it) before
+	// the first witness, so the states of the two can overlap
+	union {
+		// Transaction body (until the final confirm)
+		struct {
+			tx_hash_builder_t txHashBuilder;
+			// Inputs seen so far (in all transactions of a session),
+			// used to reject duplicates
+			tx_input_set_t inputSet;
+			struct {
+				// Boxed address (for outputs sent in one APDU)
+				uint8_t buffer[200];
+				size_t size;
+				// Digest of the raw address (for chunked outputs)
+				bool isDigest;
+				uint8_t digest[BLAKE2B_224_SIZE];
+			} currentAddress;
+			// Note: chunked outputs and metadata are not used in raw mode
+			// and metadata follows the last output, so these can overlap
+			union {
+				// Output address being streamed in chunks
+				struct {
+					bool isInProgress;
+					uint32_t size;
+					uint32_t received;
+					cbor_validator_t attributesValidator;
+					blake2b_224_context_t digest;
+				} chunkedAddress;
+				// Metadata being streamed in chunks
+				cbor_validator_t metadataValidator;
+				// Serialized transaction body
+				struct {
+					tx_parser_state_t parser;
+					// Chained digests of attested inputs and of inputs
+					// found in the transaction body, these have to match
+					uint8_t attestedInputsDigest[BLAKE2B_256_SIZE];
+					uint8_t parsedInputsDigest[BLAKE2B_256_SIZE];
+				} rawTx;
+			};
+			// Outputs to trusted addresses summarized for a review before confirm
+			struct {
+				bool isEnabled;
+				uint16_t numOutputs;
+				uint64_t sumAmount;
+				// Distinct addresses, bit i is set for the i-th trusted address
+				uint16_t numAddresses;
+				uint16_t addressMask;
+				// Confirm step to continue with after the summary
+				int confirmStep;
+			} aggregate;
+		};
+		// Witnesses (of all transactions of a session)
+		struct {
+			uint8_t currentWitnessData[64];
+			// Paths signed so far (with a declared number of witnesses)
+			struct {
+				uint8_t digests[SIGN_TX_MAX_WITNESS_PATHS][SIGN_TX_WITNESS_PATH_DIGEST_SIZE];
+				uint8_t count;
+				// Witness being signed
+				uint8_t currentDigest[SIGN_TX_WITNESS_PATH_DIGEST_SIZE];
+			} witnessPaths;
+		};
+	};
 	int ui_step;
 } ins_sign_tx_context_t;
 
@@ -0,0 +1,164 @@
+#ifdef DEVEL
+
+#include "common.h"
+#include "stackUsage.h"
+#include "state.h"
+#include "endian.h"
+
+static const uint8_t STACK_PAINT = 0xA5;
+
+// Not painted below the current frame, covers the frame of the painting
+// function (and the red zone on hosts)
+enum {
+	STACK_USAGE_MARGIN = 256,
+};
+
+#ifdef HAVE_BOLOS_APP_STACK_CANARY
+// Defined by the SDK link script, the stack grows down to it
+extern unsigned int app_stack_canary;
+#else
+enum {
+	// Host builds (see host/) paint a fixed part of the thread stack
+	STACK_USAGE_HOST_SIZE = 16 * 1024,
+};
+#endif
+
+static __attribute__((noinline)) uint8_t* stackUsage_currentFrame()
+{
+	return __builtin_frame_address(0);
+}
+
+static __attribute__((noinline)) void stackUsage_paint()
+{
+	const stackUsageState_t* state = &appContext->stackUsage;
+	volatile uint8_t* end = stackUsage_currentFrame() - STACK_USAGE_MARGIN;
+	for (volatile uint8_t* p = state->limit; p < end; p++) {
+		*p = STACK_PAINT;
+	}
+}
+
+// Lowest byte that is not painted
+static uint16_t stackUsage_measure()
+{
+	const stackUsageState_t* state = &appContext->stackUsage;
+	const volatile uint8_t* p = state->limit;
+	while (p < state->top && *p == STACK_PAINT) {
+		p++;
+	}
+	return (uint16_t) (state->top - p);
+}
+
+void stackUsage_init()
+{
+	stackUsageState_t* state = &appContext->stackUsage;
+	state->top = stackUsage_currentFrame();
+	#ifdef HAVE_BOLOS_APP_STACK_CANARY
+	state->limit = (uint8_t*) (&app_stack_canary + 1);
+	#else
+	state->limit = state->top - STACK_USAGE_HOST_SIZE;
+	#endif
+	ASSERT(state->limit < state->top);
+	ASSERT(state->top - state->limit <= UINT16_MAX);
+
+	state->current.ins = STACK_USAGE_INS_NONE;
+	state->current.uiStep = STACK_USAGE_STEP_IDLE;
+	stackUsage_paint();
+}
+
+static void stackUsage_record(const stack_usage_entry_t* segment)
+{
+	stackUsageState_t* state = &appContext->stackUsage;
+	if (segment->peak > state->peak) {
+		state->peak = segment->peak;
+	}
+
+	for (uint8_t i = 0; i < state->numEntries; i++) {
+		stack_usage_entry_t* entry = &state->entries[i];
+		if (entry->ins == segment->ins && entry->uiStep == segment->uiStep) {
+			if (segment->peak > entry->peak) {
+				entry->peak = segment->peak;
+			}
+			return;
+		}
+	}
+
+	if (state->numEntries >= ARRAY_LEN(state->entries)) {
+		state->numDroppedCheckpoints++;
+		return;
+	}
+	state->entries[state->numEntries++] = *segment;
+}
+
+void stackUsage_checkpoint(uint16_t uiStep)
+{
+	stackUsageState_t* state = &appContext->stackUsage;
+	// Not initialized yet
+	if (state->top == NULL) return;
+
+	state->current.peak = stackUsage_measure();
+	stackUsage_record(&state->current);
+
+	state->current.ins = (appContext->currentInstruction < 0)
+	                     ? STACK_USAGE_INS_NONE
+	                     : (uint8_t) appContext->currentInstruction;
+	state->current.uiStep = uiStep;
+	stackUsage_paint();
+}
+
+void stackUsage_reset()
+{
+	stackUsageState_t* state = &appContext->stackUsage;
+	os_memset(state->entries, 0, SIZEOF(state->entries));
+	state->numEntries = 0;
+	state->peak = 0;
+	state->numDroppedCheckpoints = 0;
+}
+
+enum {
+	P1_GET = 0x01,
+	P1_RESET = 0x02,
+};
+
+static const uint8_t P2_UNUSED = 0x00;
+
+void stackUsage_handleAPDU(
+        uint8_t p1, uint8_t p2,
+        uint8_t* wireBuffer MARK_UNUSED, size_t wireSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireSize == 0, ERR_INVALID_DATA);
+
+	const stackUsageState_t* state = &appContext->stackUsage;
+	uint8_t response[2 + 2 + 4 + STACK_USAGE_MAX_ENTRIES * 5];
+	size_t responseSize = 0;
+
+	switch (p1) {
+	case P1_GET:
+		u2be_write(response, (uint16_t) (state->top - state->limit));
+		u2be_write(response + 2, state->peak);
+		u4be_write(response + 4, state->numDroppedCheckpoints);
+		responseSize = 8;
+		for (uint8_t i = 0; i < state->numEntries; i++) {
+			response[responseSize] = state->entries[i].ins;
+			u2be_write(response + responseSize + 1, state->entries[i].uiStep);
+			u2be_write(response + responseSize + 3, state->entries[i].peak);
+			responseSize += 5;
+		}
+		break;
+
+	case P1_RESET:
+		stackUsage_reset();
+		break;
+
+	default:
+		THROW(ERR_INVALID_REQUEST_PARAMETERS);
+	}
+
+	ASSERT(responseSize <= SIZEOF(response));
+	io_send_buf(SUCCESS, response, responseSize);
+	ui_idle();
+}
+
+#endif
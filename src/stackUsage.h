@@ -0,0 +1,64 @@
+#ifndef H_CARDANO_APP_STACK_USAGE
+#define H_CARDANO_APP_STACK_USAGE
+
+#include "common.h"
+#include "handlers.h"
+
+// Peak stack depth per instruction and UI step, DEVEL builds only.
+// Read and reset through INS 0xF6.
+//
+// The free stack is painted with a pattern at app start and again at each
+// checkpoint (handler call and return, start of a UI step). The lowest
+// overwritten byte found at the next checkpoint gives the peak depth of
+// the code that ran in between.
+
+enum {
+	// Code of the handler outside of UI steps
+	STACK_USAGE_STEP_HANDLER = 0x0000,
+	// Waiting for I/O after the handler returned (incl. display events
+	// and button callbacks before they reach a UI step)
+	STACK_USAGE_STEP_IDLE = 0xFFFF,
+
+	STACK_USAGE_INS_NONE = 0xFF,
+
+	// Enough for the UI steps of a signTx flow and a few other instructions
+	STACK_USAGE_MAX_ENTRIES = 24,
+};
+
+typedef struct {
+	uint8_t ins;
+	uint16_t uiStep;
+	// Bytes below the stack top at app start
+	uint16_t peak;
+} stack_usage_entry_t;
+
+typedef struct {
+	uint8_t* top;
+	uint8_t* limit;
+	// Started at the last checkpoint
+	stack_usage_entry_t current;
+	stack_usage_entry_t entries[STACK_USAGE_MAX_ENTRIES];
+	uint8_t numEntries;
+	uint16_t peak;
+	// Checkpoints of (ins, uiStep) pairs that did not fit into the table
+	uint32_t numDroppedCheckpoints;
+} stackUsageState_t;
+
+#ifdef DEVEL
+
+// Paints the free stack below the caller which becomes the stack top
+void stackUsage_init();
+
+// Records the peak of the code run since the last checkpoint and starts
+// measuring the given UI step of the current instruction
+void stackUsage_checkpoint(uint16_t uiStep);
+
+void stackUsage_reset();
+
+handler_fn_t stackUsage_handleAPDU;
+
+void run_stackUsage_test();
+
+#endif
+
+#endif
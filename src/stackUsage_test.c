@@ -0,0 +1,66 @@
+#ifdef DEVEL
+
+#include "common.h"
+#include "stackUsage.h"
+#include "state.h"
+#include "test_utils.h"
+
+enum {
+	TEST_STEP = 0x1234,
+	TEST_BUFFER_SIZE = 512,
+};
+
+static __attribute__((noinline)) void useStack()
+{
+	volatile uint8_t buffer[TEST_BUFFER_SIZE];
+	for (size_t i = 0; i < SIZEOF(buffer); i++) {
+		buffer[i] = (uint8_t) i;
+	}
+}
+
+static const stack_usage_entry_t* findEntry(uint16_t uiStep)
+{
+	const stackUsageState_t* state = &appContext->stackUsage;
+	for (uint8_t i = 0; i < state->numEntries; i++) {
+		if (state->entries[i].uiStep == uiStep) {
+			return &state->entries[i];
+		}
+	}
+	return NULL;
+}
+
+void run_stackUsage_test()
+{
+	PRINTF("stackUsage test\n");
+
+	const stackUsageState_t* state = &appContext->stackUsage;
+	if (state->top == NULL) {
+		stackUsage_init();
+	}
+	stackUsage_reset();
+
+	stackUsage_checkpoint(TEST_STEP);
+	useStack();
+	stackUsage_checkpoint(TEST_STEP + 1);
+	stackUsage_checkpoint(TEST_STEP + 2);
+
+	const stack_usage_entry_t* deep = findEntry(TEST_STEP);
+	const stack_usage_entry_t* shallow = findEntry(TEST_STEP + 1);
+	ASSERT(deep != NULL && shallow != NULL);
+	// The buffer is below the frame of this function
+	const uint8_t* frame = __builtin_frame_address(0);
+	ASSERT(deep->peak >= (state->top - frame) + TEST_BUFFER_SIZE);
+	ASSERT(deep->peak > shallow->peak);
+	ASSERT(state->peak >= deep->peak);
+
+	// Repeated checkpoints keep the maximum
+	stackUsage_checkpoint(TEST_STEP);
+	stackUsage_checkpoint(TEST_STEP + 1);
+	EXPECT_EQ(findEntry(TEST_STEP)->peak, deep->peak);
+
+	stackUsage_reset();
+	EXPECT_EQ(state->numEntries, 0);
+	EXPECT_EQ(state->peak, 0);
+}
+
+#endif
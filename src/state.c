@@ -1,4 +1,14 @@
 #include "state.h"
 
-instructionState_t instructionState;
-int currentInstruction;
+app_context_t appContextInstance;
+
+// Nano S leaves about 4 KB of RAM for the app globals, the SDK and the
+// stack. Sizes below are of the device (32-bit) layout
+#if defined(TARGET_NANOS) && !defined(APP_CONTEXT_THREAD_LOCAL) && !defined(DEVEL)
+STATIC_ASSERT(SIZEOF(instructionState_t) <= 1792, "instruction state too large for Nano S");
+STATIC_ASSERT(SIZEOF(app_context_t) <= 2304, "app context too large for Nano S");
+#endif
+
+#ifdef APP_CONTEXT_THREAD_LOCAL
+__thread app_context_t* appContext = &appContextInstance;
+#endif
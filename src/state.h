@@ -7,6 +7,15 @@
 #include "deriveAddress.h"
 #include "signTx.h"
 #include "attestUtxo.h"
+#include "attestKey.h"
+#include "trustedAddress.h"
+#include "flightRecorder.h"
+#include "uiHelpers.h"
+#include "io.h"
+#include "profiling.h"
+#include "syscalls.h"
+#include "stackUsage.h"
+#include "trace.h"
 
 typedef struct {
 	stream_t s;
@@ -19,11 +28,41 @@ typedef union {
 	ins_derive_address_context_t deriveAddressContext;
 	ins_sign_tx_context_t signTxContext;
 	ins_attest_utxo_context_t attestUtxoContext;
+	ins_rotate_attest_key_context_t rotateAttestKeyContext;
+	ins_add_trusted_address_context_t addTrustedAddressContext;
 } instructionState_t;
 
-// Note(instructions are uint8_t but we have a special INS_NONE value
-extern int currentInstruction;
+// All RAM state of a running app. Persistent state lives in NVRAM
+// (see storage.h), the rest of the globals belongs to the SDK.
+typedef struct {
+	// Note(instructions are uint8_t but we have a special INS_NONE value
+	int currentInstruction;
+	instructionState_t instructionState;
+	io_state_t io_state;
+	displayState_t displayState;
+	attestKeyData_t attestKeyData;
+	trustedAddressFilter_t trustedAddressFilter;
+	flightRecorderState_t flightRecorder;
+	#ifdef DEVEL
+	profilingState_t profiling;
+	syscallStats_t syscallStats;
+	stackUsageState_t stackUsage;
+	traceState_t trace;
+	#endif
+} app_context_t;
+
+// Note: handler and UI callbacks take no context argument
+// (the SDK calls the latter), so everything reaches the state through
+// appContext. On the device it is a constant address of the single
+// instance (which also keeps the static UI element tables valid).
+// The host build defines APP_CONTEXT_THREAD_LOCAL to run one instance
+// per thread, each thread has to point appContext to its own instance.
+#ifdef APP_CONTEXT_THREAD_LOCAL
+extern __thread app_context_t* appContext;
+#else
+#define appContext (&appContextInstance)
+#endif
 
-extern instructionState_t instructionState;
+extern app_context_t appContextInstance;
 
 #endif
@@ -0,0 +1,138 @@
+#include "common.h"
+#include "storage.h"
+
+static const uint32_t STORAGE_MAGIC = 0xADA00004;
+
+// Note: NVRAM variables must be const (they live in flash)
+// and must be accessed through N_storage (PIC + volatile)
+const storage_t N_storage_real;
+#define N_storage (*(volatile storage_t*) PIC(&N_storage_real))
+
+// Note: the flag is cleared while the key is written (also when a
+// persistent key is replaced) so that an interrupted write cannot leave
+// a partially written key enabled
+static void storage_writeAttestKey(uint8_t isPersistent, const uint8_t* key)
+{
+	if (N_storage.attestKey.isPersistent != 0) {
+		const uint8_t notPersistent = 0;
+		nvm_write((void*) &N_storage.attestKey.isPersistent, (void*) &notPersistent, SIZEOF(notPersistent));
+	}
+	nvm_write((void*) N_storage.attestKey.key, (void*) key, STORAGE_ATTEST_KEY_SIZE);
+	if (isPersistent) {
+		nvm_write((void*) &N_storage.attestKey.isPersistent, (void*) &isPersistent, SIZEOF(isPersistent));
+	}
+}
+
+void storage_initialize()
+{
+	if (N_storage.magic == STORAGE_MAGIC) return;
+
+	storage_t defaults;
+	os_memset(&defaults, 0, SIZEOF(defaults));
+	defaults.magic = STORAGE_MAGIC;
+	nvm_write((void*) &N_storage, (void*) &defaults, SIZEOF(defaults));
+}
+
+bool storage_isAttestKeyPersistent()
+{
+	ASSERT(N_storage.magic == STORAGE_MAGIC);
+	return N_storage.attestKey.isPersistent == 1;
+}
+
+void storage_readAttestKey(uint8_t* key, size_t keySize)
+{
+	ASSERT(keySize == STORAGE_ATTEST_KEY_SIZE);
+	ASSERT(storage_isAttestKeyPersistent());
+	os_memmove(key, (const void*) N_storage.attestKey.key, STORAGE_ATTEST_KEY_SIZE);
+}
+
+void storage_enablePersistentAttestKey(const uint8_t* key, size_t keySize)
+{
+	ASSERT(keySize == STORAGE_ATTEST_KEY_SIZE);
+	storage_writeAttestKey(1, key);
+}
+
+void storage_disablePersistentAttestKey()
+{
+	uint8_t zeroKey[STORAGE_ATTEST_KEY_SIZE];
+	os_memset(zeroKey, 0, SIZEOF(zeroKey));
+	storage_writeAttestKey(0, zeroKey);
+}
+
+uint8_t storage_getTrustedAddressCount()
+{
+	ASSERT(N_storage.magic == STORAGE_MAGIC);
+	uint8_t count = N_storage.trustedAddresses.count;
+	ASSERT(count <= STORAGE_TRUSTED_ADDRESSES_CAPACITY);
+	return count;
+}
+
+void storage_readTrustedAddress(uint8_t index, uint8_t* digest, size_t digestSize)
+{
+	ASSERT(digestSize == STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE);
+	ASSERT(index < storage_getTrustedAddressCount());
+	os_memmove(digest, (const void*) N_storage.trustedAddresses.digests[index], STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE);
+}
+
+// Note: the count is increased only after the digest is written
+// so that an interrupted write cannot trust a garbage entry
+void storage_addTrustedAddress(const uint8_t* digest, size_t digestSize)
+{
+	ASSERT(digestSize == STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE);
+	uint8_t count = storage_getTrustedAddressCount();
+	ASSERT(count < STORAGE_TRUSTED_ADDRESSES_CAPACITY);
+
+	nvm_write((void*) N_storage.trustedAddresses.digests[count], (void*) digest, STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE);
+	count++;
+	nvm_write((void*) &N_storage.trustedAddresses.count, (void*) &count, SIZEOF(count));
+}
+
+void storage_clearTrustedAddresses()
+{
+	uint8_t count = 0;
+	nvm_write((void*) &N_storage.trustedAddresses.count, (void*) &count, SIZEOF(count));
+
+	uint8_t zeroDigest[STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE];
+	os_memset(zeroDigest, 0, SIZEOF(zeroDigest));
+	for (uint8_t i = 0; i < STORAGE_TRUSTED_ADDRESSES_CAPACITY; i++) {
+		nvm_write((void*) N_storage.trustedAddresses.digests[i], (void*) zeroDigest, SIZEOF(zeroDigest));
+	}
+}
+
+uint8_t storage_getPolicyProfile()
+{
+	ASSERT(N_storage.magic == STORAGE_MAGIC);
+	return N_storage.policyProfile;
+}
+
+void storage_setPolicyProfile(uint8_t profile)
+{
+	nvm_write((void*) &N_storage.policyProfile, (void*) &profile, SIZEOF(profile));
+}
+
+size_t storage_readCrashRecord(uint8_t* buffer, size_t bufferSize)
+{
+	ASSERT(N_storage.magic == STORAGE_MAGIC);
+	const size_t size = N_storage.crashRecord.size;
+	ASSERT(size <= STORAGE_CRASH_RECORD_CAPACITY);
+	ASSERT(size <= bufferSize);
+	os_memmove(buffer, (const void*) N_storage.crashRecord.data, size);
+	return size;
+}
+
+// Note: the size is written only after the data
+// so that an interrupted write cannot expose a garbage record
+void storage_writeCrashRecord(const uint8_t* record, size_t recordSize)
+{
+	ASSERT(recordSize > 0 && recordSize <= STORAGE_CRASH_RECORD_CAPACITY);
+	storage_clearCrashRecord();
+	nvm_write((void*) N_storage.crashRecord.data, (void*) record, recordSize);
+	uint8_t size = (uint8_t) recordSize;
+	nvm_write((void*) &N_storage.crashRecord.size, (void*) &size, SIZEOF(size));
+}
+
+void storage_clearCrashRecord()
+{
+	uint8_t size = 0;
+	nvm_write((void*) &N_storage.crashRecord.size, (void*) &size, SIZEOF(size));
+}
@@ -0,0 +1,63 @@
+#ifndef H_CARDANO_APP_STORAGE
+#define H_CARDANO_APP_STORAGE
+
+#include "common.h"
+
+enum {
+	STORAGE_ATTEST_KEY_SIZE = 32,
+	STORAGE_TRUSTED_ADDRESSES_CAPACITY = 16,
+	// blake2b_224 of the raw address
+	STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE = 28,
+	// Serialized flight record (see flightRecorder.h)
+	STORAGE_CRASH_RECORD_CAPACITY = 80,
+};
+
+// Layout of the app data persisted in NVRAM.
+// Note: bump STORAGE_MAGIC whenever the layout changes
+// so that stale data from an older version gets reset
+typedef struct {
+	uint32_t magic;
+	struct {
+		uint8_t isPersistent;
+		uint8_t key[STORAGE_ATTEST_KEY_SIZE];
+	} attestKey;
+	// Addresses approved by the user as outputs not needing review
+	struct {
+		uint8_t count;
+		uint8_t digests[STORAGE_TRUSTED_ADDRESSES_CAPACITY][STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE];
+	} trustedAddresses;
+	// Active policy_profile_t
+	uint8_t policyProfile;
+	// Flight record saved when the app crashed last time
+	struct {
+		uint8_t size;
+		uint8_t data[STORAGE_CRASH_RECORD_CAPACITY];
+	} crashRecord;
+} storage_t;
+
+// Should be called at app startup (before anything reads the storage)
+void storage_initialize();
+
+bool storage_isAttestKeyPersistent();
+void storage_readAttestKey(uint8_t* key, size_t keySize);
+
+// Persists the key and enables persistence
+void storage_enablePersistentAttestKey(const uint8_t* key, size_t keySize);
+// Wipes the key and disables persistence
+void storage_disablePersistentAttestKey();
+
+uint8_t storage_getTrustedAddressCount();
+void storage_readTrustedAddress(uint8_t index, uint8_t* digest, size_t digestSize);
+// Appends the digest (there has to be space left)
+void storage_addTrustedAddress(const uint8_t* digest, size_t digestSize);
+void storage_clearTrustedAddresses();
+
+uint8_t storage_getPolicyProfile();
+void storage_setPolicyProfile(uint8_t profile);
+
+// Returns the size of the saved record (0 if there is none)
+size_t storage_readCrashRecord(uint8_t* buffer, size_t bufferSize);
+void storage_writeCrashRecord(const uint8_t* record, size_t recordSize);
+void storage_clearCrashRecord();
+
+#endif
@@ -47,7 +47,7 @@ void stream_ensureAvailableBytes(const stream_t* stream, size_t requiredSize)
 void stream_advancePos(stream_t* stream, size_t advanceBy)
 {
 	// just in case somebody changes to signed
-	ASSERT(advanceBy >= 0);
+	ASSERT_TYPE(advanceBy, size_t);
 	// Wraparound
 	ASSERT(stream->streamPos + advanceBy > stream->streamPos);
 
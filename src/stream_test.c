@@ -7,7 +7,7 @@
 #include "test_utils.h"
 #include "state.h"
 
-static ins_tests_context_t* ctx = &(instructionState.testsContext);
+#define ctx (&appContext->instructionState.testsContext)
 
 void _run_stream_test(stream_t* s)
 {
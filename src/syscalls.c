@@ -0,0 +1,170 @@
+#ifdef DEVEL
+
+// Wrappers below call the real syscalls
+#define SYSCALLS_NO_REDIRECT
+
+#include "common.h"
+#include "syscalls.h"
+#include "state.h"
+#include "endian.h"
+
+static syscall_counter_t* syscalls_getCounter(syscall_id_t id)
+{
+	ASSERT(id < _SYSCALL_COUNT);
+	syscallStats_t* stats = &appContext->syscallStats;
+
+	const uint8_t ins = (appContext->currentInstruction < 0)
+	                    ? SYSCALL_STATS_INS_NONE
+	                    : (uint8_t) appContext->currentInstruction;
+
+	for (uint8_t i = 0; i < stats->numInstructions; i++) {
+		if (stats->instructions[i].ins == ins) {
+			return &stats->instructions[i].counters[id];
+		}
+	}
+
+	if (stats->numInstructions >= ARRAY_LEN(stats->instructions)) {
+		return NULL;
+	}
+	stats->instructions[stats->numInstructions].ins = ins;
+	return &stats->instructions[stats->numInstructions++].counters[id];
+}
+
+static void syscalls_count(syscall_id_t id, uint32_t bytes)
+{
+	syscall_counter_t* counter = syscalls_getCounter(id);
+	if (counter == NULL) {
+		appContext->syscallStats.numDroppedCalls++;
+		return;
+	}
+	counter->calls++;
+	counter->bytes += bytes;
+}
+
+void syscalls_reset()
+{
+	os_memset(&appContext->syscallStats, 0, SIZEOF(appContext->syscallStats));
+}
+
+int syscall_cx_hash(
+        cx_hash_t* hash, int mode,
+        const unsigned char* in, unsigned int inSize,
+        unsigned char* out, unsigned int outSize
+)
+{
+	syscalls_count(SYSCALL_CX_HASH, inSize);
+	return cx_hash(hash, mode, in, inSize, out, outSize);
+}
+
+int syscall_cx_hmac_sha256(
+        const unsigned char* key, unsigned int keySize,
+        const unsigned char* in, unsigned int inSize,
+        unsigned char* mac, unsigned int macSize
+)
+{
+	syscalls_count(SYSCALL_CX_HMAC_SHA256, inSize);
+	return cx_hmac_sha256(key, keySize, in, inSize, mac, macSize);
+}
+
+void syscall_os_perso_derive_node_bip32(
+        cx_curve_t curve,
+        const uint32_t* path, unsigned int pathLength,
+        unsigned char* privateKey,
+        unsigned char* chain
+)
+{
+	syscalls_count(SYSCALL_OS_PERSO_DERIVE_NODE_BIP32, pathLength);
+	os_perso_derive_node_bip32(curve, path, pathLength, privateKey, chain);
+}
+
+int syscall_cx_eddsa_sign(
+        const struct cx_ecfp_256_private_key_s* privateKey,
+        int mode, cx_md_t hashId,
+        const unsigned char* in, unsigned int inSize,
+        const unsigned char* ctx, unsigned int ctxSize,
+        unsigned char* signature, unsigned int signatureSize,
+        unsigned int* info
+)
+{
+	syscalls_count(SYSCALL_CX_EDDSA_SIGN, inSize);
+	return cx_eddsa_sign(privateKey, mode, hashId, in, inSize, ctx, ctxSize, signature, signatureSize, info);
+}
+
+void syscall_cx_eddsa_get_public_key(
+        const struct cx_ecfp_256_private_key_s* privateKey,
+        cx_md_t hashId,
+        cx_ecfp_public_key_t* publicKey,
+        unsigned char* a, unsigned int aSize,
+        unsigned char* h, unsigned int hSize
+)
+{
+	syscalls_count(SYSCALL_CX_EDDSA_GET_PUBLIC_KEY, 0);
+	cx_eddsa_get_public_key(privateKey, hashId, publicKey, a, aSize, h, hSize);
+}
+
+unsigned char* syscall_cx_rng(unsigned char* buffer, unsigned int size)
+{
+	syscalls_count(SYSCALL_CX_RNG, size);
+	return cx_rng(buffer, size);
+}
+
+
+enum {
+	P1_GET_INSTRUCTIONS = 0x01,
+	P1_GET_COUNTERS = 0x02,
+	P1_RESET = 0x03,
+};
+
+static const uint8_t P2_UNUSED = 0x00;
+
+void syscalls_handleAPDU(
+        uint8_t p1, uint8_t p2,
+        uint8_t* wireBuffer MARK_UNUSED, size_t wireSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(wireSize == 0, ERR_INVALID_DATA);
+
+	const syscallStats_t* stats = &appContext->syscallStats;
+	uint8_t response[4 + _SYSCALL_COUNT * 8];
+	size_t responseSize = 0;
+
+	switch (p1) {
+	case P1_GET_INSTRUCTIONS:
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		u4be_write(response, stats->numDroppedCalls);
+		responseSize = 4;
+		STATIC_ASSERT(4 + SYSCALL_STATS_MAX_INSTRUCTIONS <= SIZEOF(response), "bad response size");
+		for (uint8_t i = 0; i < stats->numInstructions; i++) {
+			response[responseSize++] = stats->instructions[i].ins;
+		}
+		break;
+
+	case P1_GET_COUNTERS:
+		// P2 is the instruction, counters of an unknown one are zero
+		os_memset(response, 0, SIZEOF(response));
+		responseSize = _SYSCALL_COUNT * 8;
+		for (uint8_t i = 0; i < stats->numInstructions; i++) {
+			if (stats->instructions[i].ins != p2) continue;
+			for (size_t id = 0; id < _SYSCALL_COUNT; id++) {
+				u4be_write(response + 8 * id, stats->instructions[i].counters[id].calls);
+				u4be_write(response + 8 * id + 4, stats->instructions[i].counters[id].bytes);
+			}
+		}
+		break;
+
+	case P1_RESET:
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		syscalls_reset();
+		break;
+
+	default:
+		THROW(ERR_INVALID_REQUEST_PARAMETERS);
+	}
+
+	ASSERT(responseSize <= SIZEOF(response));
+	io_send_buf(SUCCESS, response, responseSize);
+	ui_idle();
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef H_CARDANO_APP_SYSCALLS
+#define H_CARDANO_APP_SYSCALLS
+
+#include "common.h"
+#include "handlers.h"
+
+// Accounting of the (slow) cx / os syscalls per active instruction,
+// DEVEL builds only. Read and reset through INS 0xF5.
+//
+// Files making these syscalls include this header. In DEVEL builds it
+// redirects the calls to counting wrappers (see syscalls.c).
+
+typedef enum {
+	SYSCALL_CX_HASH = 0,
+	SYSCALL_CX_HMAC_SHA256 = 1,
+	SYSCALL_OS_PERSO_DERIVE_NODE_BIP32 = 2,
+	SYSCALL_CX_EDDSA_SIGN = 3,
+	SYSCALL_CX_EDDSA_GET_PUBLIC_KEY = 4,
+	SYSCALL_CX_RNG = 5,
+	_SYSCALL_COUNT,
+} syscall_id_t;
+
+enum {
+	SYSCALL_STATS_MAX_INSTRUCTIONS = 6,
+	// Syscalls made while no instruction is active (app startup, menu)
+	SYSCALL_STATS_INS_NONE = 0xFF,
+};
+
+typedef struct {
+	uint32_t calls;
+	// Input size (output size for cx_rng, path length for derivation,
+	// nothing for public keys)
+	uint32_t bytes;
+} syscall_counter_t;
+
+typedef struct {
+	struct {
+		uint8_t ins;
+		syscall_counter_t counters[_SYSCALL_COUNT];
+	} instructions[SYSCALL_STATS_MAX_INSTRUCTIONS];
+	uint8_t numInstructions;
+	// Calls made by instructions that did not fit into the table
+	uint32_t numDroppedCalls;
+} syscallStats_t;
+
+#ifdef DEVEL
+
+void syscalls_reset();
+
+handler_fn_t syscalls_handleAPDU;
+
+int syscall_cx_hash(
+        cx_hash_t* hash, int mode,
+        const unsigned char* in, unsigned int inSize,
+        unsigned char* out, unsigned int outSize
+);
+
+int syscall_cx_hmac_sha256(
+        const unsigned char* key, unsigned int keySize,
+        const unsigned char* in, unsigned int inSize,
+        unsigned char* mac, unsigned int macSize
+);
+
+void syscall_os_perso_derive_node_bip32(
+        cx_curve_t curve,
+        const uint32_t* path, unsigned int pathLength,
+        unsigned char* privateKey,
+        unsigned char* chain
+);
+
+int syscall_cx_eddsa_sign(
+        const struct cx_ecfp_256_private_key_s* privateKey,
+        int mode, cx_md_t hashId,
+        const unsigned char* in, unsigned int inSize,
+        const unsigned char* ctx, unsigned int ctxSize,
+        unsigned char* signature, unsigned int signatureSize,
+        unsigned int* info
+);
+
+void syscall_cx_eddsa_get_public_key(
+        const struct cx_ecfp_256_private_key_s* privateKey,
+        cx_md_t hashId,
+        cx_ecfp_public_key_t* publicKey,
+        unsigned char* a, unsigned int aSize,
+        unsigned char* h, unsigned int hSize
+);
+
+unsigned char* syscall_cx_rng(unsigned char* buffer, unsigned int size);
+
+void run_syscalls_test();
+
+#ifndef SYSCALLS_NO_REDIRECT
+#define cx_hash syscall_cx_hash
+#define cx_hmac_sha256 syscall_cx_hmac_sha256
+#define os_perso_derive_node_bip32 syscall_os_perso_derive_node_bip32
+#define cx_eddsa_sign syscall_cx_eddsa_sign
+#define cx_eddsa_get_public_key syscall_cx_eddsa_get_public_key
+#define cx_rng syscall_cx_rng
+#endif
+
+#endif
+
+#endif
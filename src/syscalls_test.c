@@ -0,0 +1,44 @@
+#ifdef DEVEL
+
+#include "common.h"
+#include "syscalls.h"
+#include "state.h"
+#include "test_utils.h"
+
+void run_syscalls_test()
+{
+	PRINTF("syscalls test\n");
+
+	const int savedInstruction = appContext->currentInstruction;
+	const syscallStats_t* stats = &appContext->syscallStats;
+	uint8_t buffer[10];
+
+	syscalls_reset();
+	appContext->currentInstruction = 0x42;
+	cx_rng(buffer, 3);
+	cx_rng(buffer, 5);
+	EXPECT_EQ(stats->numInstructions, 1);
+	EXPECT_EQ(stats->instructions[0].ins, 0x42);
+	EXPECT_EQ(stats->instructions[0].counters[SYSCALL_CX_RNG].calls, 2);
+	EXPECT_EQ(stats->instructions[0].counters[SYSCALL_CX_RNG].bytes, 8);
+	EXPECT_EQ(stats->instructions[0].counters[SYSCALL_CX_HASH].calls, 0);
+
+	appContext->currentInstruction = -1;
+	cx_rng(buffer, 1);
+	EXPECT_EQ(stats->numInstructions, 2);
+	EXPECT_EQ(stats->instructions[1].ins, SYSCALL_STATS_INS_NONE);
+
+	// Calls of instructions beyond the capacity are only counted
+	for (int ins = 0; ins < SYSCALL_STATS_MAX_INSTRUCTIONS; ins++) {
+		appContext->currentInstruction = ins;
+		cx_rng(buffer, 1);
+	}
+	EXPECT_EQ(stats->numInstructions, SYSCALL_STATS_MAX_INSTRUCTIONS);
+	EXPECT_EQ(stats->numDroppedCalls, 2);
+
+	appContext->currentInstruction = savedInstruction;
+	syscalls_reset();
+	EXPECT_EQ(stats->numInstructions, 0);
+}
+
+#endif
@@ -7,37 +7,91 @@
 		ptr++; \
 	}
 
-size_t str_formatAdaAmount(
-        char* out, size_t outSize,
-        uint64_t amount
-)
+// Note: Cortex-M0 has no 64-bit division and __aeabi_uldivmod
+// is painfully slow. We therefore split 64-bit values into chunks
+// using long division over bytes where each step fits into 32 bits.
+STATIC_ASSERT(U64_CHUNK_DIVISOR < (1u << 24), "remainder << 8 must fit into uint32_t");
+
+// Divides *value by U64_CHUNK_DIVISOR in place, returning the remainder
+static uint32_t u64_divmodChunk(uint64_t* value)
 {
-	ASSERT(outSize < BUFFER_SIZE_PARANOIA);
+	uint32_t hi = (uint32_t) (*value >> 32);
+	uint32_t lo = (uint32_t) (*value);
 
-	char scratchBuffer[30];
-	char* ptr = BEGIN(scratchBuffer);
-	char* end = END(scratchBuffer);
+	if (hi == 0) {
+		// Fast path, fits into 32 bits
+		*value = lo / U64_CHUNK_DIVISOR;
+		return lo % U64_CHUNK_DIVISOR;
+	}
 
-	// We print in reverse
+	uint32_t quotientHi = 0;
+	uint32_t quotientLo = 0;
+	uint32_t remainder = 0;
 
-	// decimal digits
-	for (int dec = 0; dec < 6; dec++) {
-		WRITE_CHAR(ptr, end, '0' + (amount % 10));
-		amount /= 10;
+	for (int i = 0; i < 8; i++) {
+		// Next byte of the dividend, most significant first
+		uint32_t byte = (i < 4)
+		                ? (hi >> (24 - 8 * i)) & 0xFF
+		                : (lo >> (24 - 8 * (i - 4))) & 0xFF;
+		uint32_t current = (remainder << 8) | byte;
+		// Note: current < U64_CHUNK_DIVISOR * 256 so quotient digit fits into a byte
+		uint32_t digit = current / U64_CHUNK_DIVISOR;
+		remainder = current - digit * U64_CHUNK_DIVISOR;
+
+		if (i < 4) {
+			quotientHi = (quotientHi << 8) | digit;
+		} else {
+			quotientLo = (quotientLo << 8) | digit;
+		}
 	}
-	WRITE_CHAR(ptr, end, '.');
-	// We want at least one iteration
+
+	*value = ((uint64_t) quotientHi << 32) | quotientLo;
+	return remainder;
+}
+
+// Writes decimal digits of the value in reverse order.
+// Uses only 32-bit arithmetic.
+static char* writeReversedDecimal(
+        char* ptr, char* end,
+        uint64_t value,
+        bool thousandsSeparator
+)
+{
 	int place = 0;
+	// We want at least one iteration
 	do {
-		// thousands separator
-		if (place && (place % 3 == 0)) {
-			WRITE_CHAR(ptr, end, ',');
+		uint32_t chunk;
+		int chunkDigits;
+		if (value >= U64_CHUNK_DIVISOR) {
+			chunk = u64_divmodChunk(&value);
+			// Chunks in the middle are zero-padded
+			chunkDigits = U64_CHUNK_DIGITS;
+		} else {
+			chunk = (uint32_t) value;
+			value = 0;
+			chunkDigits = 0;
 		}
-		WRITE_CHAR(ptr, end, '0' + (amount % 10));
-		amount /= 10;
-		place++;
-	} while (amount > 0);
 
+		for (int digit = 0; digit < chunkDigits || chunk > 0 || place == 0; digit++) {
+			// thousands separator
+			if (thousandsSeparator && place && (place % 3 == 0)) {
+				WRITE_CHAR(ptr, end, ',');
+			}
+			WRITE_CHAR(ptr, end, '0' + (chunk % 10));
+			chunk /= 10;
+			place++;
+		}
+	} while (value > 0);
+
+	return ptr;
+}
+
+// Copies reversed scratch buffer into the output & appends terminator
+static size_t finalizeReversed(
+        const char* scratchBuffer, const char* ptr,
+        char* out, size_t outSize
+)
+{
 	// Size without terminating character
 	STATIC_ASSERT(sizeof(ptr - scratchBuffer) == sizeof(size_t), "bad size_t size");
 	size_t rawSize = (size_t) (ptr - scratchBuffer);
@@ -54,3 +108,47 @@ size_t str_formatAdaAmount(
 
 	return rawSize;
 }
+
+size_t str_formatAdaAmount(
+        char* out, size_t outSize,
+        uint64_t amount
+)
+{
+	ASSERT(outSize < BUFFER_SIZE_PARANOIA);
+
+	char scratchBuffer[30];
+	char* ptr = BEGIN(scratchBuffer);
+	char* end = END(scratchBuffer);
+
+	// We print in reverse
+
+	// decimal digits
+	STATIC_ASSERT(U64_CHUNK_DIVISOR == 1000000, "lovelace chunk should be 10^6");
+	uint32_t lovelace = u64_divmodChunk(&amount);
+	for (int dec = 0; dec < 6; dec++) {
+		WRITE_CHAR(ptr, end, '0' + (lovelace % 10));
+		lovelace /= 10;
+	}
+	WRITE_CHAR(ptr, end, '.');
+
+	ptr = writeReversedDecimal(ptr, end, amount, true);
+
+	return finalizeReversed(scratchBuffer, ptr, out, outSize);
+}
+
+size_t str_formatUint64(
+        char* out, size_t outSize,
+        uint64_t value
+)
+{
+	ASSERT(outSize < BUFFER_SIZE_PARANOIA);
+
+	// 2^64 has 20 decimal digits
+	char scratchBuffer[20];
+	char* ptr = BEGIN(scratchBuffer);
+	char* end = END(scratchBuffer);
+
+	ptr = writeReversedDecimal(ptr, end, value, false);
+
+	return finalizeReversed(scratchBuffer, ptr, out, outSize);
+}
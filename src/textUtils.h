@@ -3,8 +3,36 @@
 
 #include "common.h"
 
+enum {
+	// 64-bit values are formatted in chunks of this size
+	U64_CHUNK_DIVISOR = 1000000,
+	U64_CHUNK_DIGITS = 6,
+};
+
 size_t str_formatAdaAmount(char* out, size_t outSize, uint64_t amount);
 
+// Ledger's PRINTF does not support 64-bit integers
+size_t str_formatUint64(char* out, size_t outSize, uint64_t value);
+
+#ifdef DEVEL
+#define TRACE_ADA_AMOUNT(PREFIX, AMOUNT) \
+	do { \
+		char __adaAmountStr[30]; \
+		str_formatAdaAmount(__adaAmountStr, SIZEOF(__adaAmountStr), (AMOUNT)); \
+		TRACE("%s%s", PREFIX, __adaAmountStr); \
+	} while(0)
+
+#define TRACE_UINT64(PREFIX, VALUE) \
+	do { \
+		char __uint64Str[21]; \
+		str_formatUint64(__uint64Str, SIZEOF(__uint64Str), (VALUE)); \
+		TRACE("%s%s", PREFIX, __uint64Str); \
+	} while(0)
+#else
+#define TRACE_ADA_AMOUNT(PREFIX, AMOUNT)
+#define TRACE_UINT64(PREFIX, VALUE)
+#endif
+
 void run_textUtils_test();
 
 #endif
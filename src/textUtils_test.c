@@ -23,13 +23,15 @@ void test_formatAda()
 	testcase_formatAda(10,      "0.000010");
 	testcase_formatAda(123456,  "0.123456");
 	testcase_formatAda(1000000, "1.000000");
+	testcase_formatAda(1000000000000u, "1,000,000.000000");
+	testcase_formatAda(45000000000000000u, "45,000,000,000.000000");
 	testcase_formatAda(
 	        12345678901234567890u,
 	        "12,345,678,901,234.567890"
 	);
 
 	{
-		PRINTF("test_formatAda edge cases");
+		PRINTF("test_formatAda edge cases\n");
 		char tmp[12];
 		os_memset(tmp, 'X', SIZEOF(tmp));
 		str_formatAdaAmount(tmp, 9, 0);
@@ -42,9 +44,49 @@ void test_formatAda()
 	}
 }
 
+void testcase_formatUint64(
+        uint64_t number,
+        const char* expected
+)
+{
+	PRINTF("testcase_formatUint64 %s\n", expected);
+	char tmp[30];
+	size_t len = str_formatUint64(tmp, SIZEOF(tmp), number);
+	EXPECT_EQ(len, strlen(expected));
+	EXPECT_EQ(strcmp(tmp, expected), 0);
+}
+
+void test_formatUint64()
+{
+	testcase_formatUint64(0,       "0");
+	testcase_formatUint64(1,       "1");
+	testcase_formatUint64(999999,  "999999");
+	testcase_formatUint64(1000000, "1000000");
+	testcase_formatUint64(4294967295u, "4294967295");
+	testcase_formatUint64(4294967296u, "4294967296");
+	testcase_formatUint64(1000000000000000001u, "1000000000000000001");
+	testcase_formatUint64(
+	        18446744073709551615u,
+	        "18446744073709551615"
+	);
+
+	{
+		PRINTF("test_formatUint64 edge cases\n");
+		char tmp[12];
+		os_memset(tmp, 'X', SIZEOF(tmp));
+		str_formatUint64(tmp, 3, 99);
+		EXPECT_EQ(tmp[2], 0);
+		EXPECT_EQ(tmp[3], 'X');
+
+		EXPECT_THROWS(str_formatUint64(tmp, 3, 100), ERR_DATA_TOO_LARGE);
+		EXPECT_EQ(tmp[3], 'X');
+	}
+}
+
 void run_textUtils_test()
 {
 	test_formatAda();
+	test_formatUint64();
 }
 
 #endif
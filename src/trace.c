@@ -0,0 +1,100 @@
+#ifdef DEVEL
+
+#include "common.h"
+#include "trace.h"
+#include "state.h"
+#include "endian.h"
+
+STATIC_ASSERT(TRACE_BUFFER_SIZE <= 255, "bad trace buffer size");
+
+void trace_record(trace_module_t module, uint16_t line, uint32_t a, uint32_t b)
+{
+	traceState_t* state = &appContext->trace;
+
+	uint8_t index;
+	if (state->size < TRACE_BUFFER_SIZE) {
+		index = (uint8_t) ((state->first + state->size) % TRACE_BUFFER_SIZE);
+		state->size++;
+	} else {
+		// Overwrite the oldest one
+		index = state->first;
+		state->first = (uint8_t) ((state->first + 1) % TRACE_BUFFER_SIZE);
+		state->numLost++;
+	}
+
+	trace_record_t* record = &state->records[index];
+	record->module = (uint8_t) module;
+	record->line = line;
+	record->a = a;
+	record->b = b;
+}
+
+void trace_reset()
+{
+	os_memset(&appContext->trace, 0, SIZEOF(appContext->trace));
+}
+
+enum {
+	P1_DRAIN = 0x01,
+	P1_RESET = 0x02,
+};
+
+static const uint8_t P2_UNUSED = 0x00;
+
+enum {
+	TRACE_RECORD_WIRE_SIZE = 1 + 2 + 4 + 4,
+	// Fits into a short APDU response
+	TRACE_MAX_RECORDS_PER_RESPONSE = 20,
+};
+
+void trace_handleAPDU(
+        uint8_t p1, uint8_t p2,
+        uint8_t* wireBuffer MARK_UNUSED, size_t wireSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireSize == 0, ERR_INVALID_DATA);
+
+	traceState_t* state = &appContext->trace;
+	uint8_t response[4 + 1 + TRACE_MAX_RECORDS_PER_RESPONSE * TRACE_RECORD_WIRE_SIZE];
+	size_t responseSize = 0;
+
+	switch (p1) {
+	case P1_DRAIN: {
+		// Oldest records first, the rest stays for the next drain
+		u4be_write(response, state->numLost);
+		state->numLost = 0;
+		const uint8_t count = (state->size < TRACE_MAX_RECORDS_PER_RESPONSE)
+		                      ? state->size
+		                      : TRACE_MAX_RECORDS_PER_RESPONSE;
+		response[4] = (uint8_t) (state->size - count);
+		responseSize = 5;
+		for (uint8_t i = 0; i < count; i++) {
+			const trace_record_t* record = &state->records[state->first];
+			response[responseSize] = record->module;
+			u2be_write(response + responseSize + 1, record->line);
+			u4be_write(response + responseSize + 3, record->a);
+			u4be_write(response + responseSize + 7, record->b);
+			responseSize += TRACE_RECORD_WIRE_SIZE;
+
+			state->first = (uint8_t) ((state->first + 1) % TRACE_BUFFER_SIZE);
+			state->size--;
+		}
+		break;
+	}
+
+	case P1_RESET:
+		trace_reset();
+		break;
+
+	default:
+		THROW(ERR_INVALID_REQUEST_PARAMETERS);
+	}
+
+	ASSERT(responseSize <= SIZEOF(response));
+	io_send_buf(SUCCESS, response, responseSize);
+	ui_idle();
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef H_CARDANO_APP_TRACE
+#define H_CARDANO_APP_TRACE
+
+#include "common.h"
+#include "handlers.h"
+
+// Binary trace records in a RAM ring buffer, DEVEL builds only. Drained
+// through INS 0xF7.
+//
+// Unlike TRACE (which prints synchronously through PRINTF and changes the
+// timing a lot) recording is a few stores, i.e. usable on the streaming
+// paths. A record is the site (module and source line) and two integers.
+//
+// Usage:
+//   #define TRACE_MODULE SIGN_TX  // after the includes
+//   TRACE_EVENT(TRACE_LEVEL_INFO, outputIndex, amount);
+
+typedef enum {
+	TRACE_MODULE_IO = 1,
+	TRACE_MODULE_ATTEST_UTXO = 2,
+	TRACE_MODULE_SIGN_TX = 3,
+} trace_module_t;
+
+enum {
+	TRACE_LEVEL_OFF = 0,
+	TRACE_LEVEL_INFO = 1,
+	TRACE_LEVEL_DEBUG = 2,
+};
+
+// Compile-time levels, records of higher levels are compiled out.
+// Override e.g. with DEFINES += TRACE_LEVEL_SIGN_TX=2 in the Makefile.
+#ifndef TRACE_LEVEL_IO
+#define TRACE_LEVEL_IO TRACE_LEVEL_INFO
+#endif
+#ifndef TRACE_LEVEL_ATTEST_UTXO
+#define TRACE_LEVEL_ATTEST_UTXO TRACE_LEVEL_INFO
+#endif
+#ifndef TRACE_LEVEL_SIGN_TX
+#define TRACE_LEVEL_SIGN_TX TRACE_LEVEL_INFO
+#endif
+
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 16
+#endif
+
+typedef struct {
+	uint8_t module;
+	uint16_t line;
+	uint32_t a;
+	uint32_t b;
+} trace_record_t;
+
+typedef struct {
+	trace_record_t records[TRACE_BUFFER_SIZE];
+	// Index of the oldest record
+	uint8_t first;
+	uint8_t size;
+	// Records overwritten before they were drained
+	uint32_t numLost;
+} traceState_t;
+
+#ifdef DEVEL
+
+void trace_record(trace_module_t module, uint16_t line, uint32_t a, uint32_t b);
+void trace_reset();
+
+handler_fn_t trace_handleAPDU;
+
+void run_trace_test();
+
+#define TRACE_CONCAT_(A, B) A ## B
+#define TRACE_CONCAT(A, B) TRACE_CONCAT_(A, B)
+
+#define TRACE_EVENT(LEVEL, A, B) \
+	do { \
+		if (TRACE_CONCAT(TRACE_LEVEL_, TRACE_MODULE) >= (LEVEL)) { \
+			trace_record( \
+			        TRACE_CONCAT(TRACE_MODULE_, TRACE_MODULE), __LINE__, \
+			        (uint32_t) (A), (uint32_t) (B) \
+			); \
+		} \
+	} while(0)
+
+#else
+
+#define TRACE_EVENT(LEVEL, A, B)
+
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+#ifdef DEVEL
+
+#include "common.h"
+#include "trace.h"
+#include "state.h"
+#include "test_utils.h"
+
+#define TRACE_MODULE IO
+
+void run_trace_test()
+{
+	PRINTF("trace test\n");
+
+	const traceState_t* state = &appContext->trace;
+	trace_reset();
+
+	TRACE_EVENT(TRACE_LEVEL_INFO, 1, 2);
+	EXPECT_EQ(state->size, 1);
+	const trace_record_t* record = &state->records[state->first];
+	EXPECT_EQ(record->module, TRACE_MODULE_IO);
+	EXPECT_EQ(record->line, __LINE__ - 4);
+	EXPECT_EQ(record->a, 1);
+	EXPECT_EQ(record->b, 2);
+
+	#if TRACE_LEVEL_IO < TRACE_LEVEL_DEBUG
+	// Compiled out
+	TRACE_EVENT(TRACE_LEVEL_DEBUG, 3, 4);
+	EXPECT_EQ(state->size, 1);
+	#endif
+
+	// Full buffer overwrites the oldest records
+	for (uint32_t i = 0; i < TRACE_BUFFER_SIZE + 2; i++) {
+		trace_record(TRACE_MODULE_SIGN_TX, 10, i, 0);
+	}
+	EXPECT_EQ(state->size, TRACE_BUFFER_SIZE);
+	EXPECT_EQ(state->numLost, 3);
+	EXPECT_EQ(state->records[state->first].a, 2);
+
+	trace_reset();
+	EXPECT_EQ(state->size, 0);
+}
+
+#endif
@@ -0,0 +1,167 @@
+#include "common.h"
+#include "trustedAddress.h"
+#include "storage.h"
+#include "state.h"
+#include "uiHelpers.h"
+#include "securityPolicy.h"
+#include "addressUtils.h"
+#include "base58.h"
+
+STATIC_ASSERT((int) BLAKE2B_224_SIZE == (int) STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE, "bad STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE");
+
+static inline bool trustedAddress_filterContains(uint8_t firstByte)
+{
+	const trustedAddressFilter_t* filter = &appContext->trustedAddressFilter;
+	return (filter->bits[firstByte / 8] & (1 << (firstByte % 8))) != 0;
+}
+
+static inline void trustedAddress_filterAdd(uint8_t firstByte)
+{
+	trustedAddressFilter_t* filter = &appContext->trustedAddressFilter;
+	filter->bits[firstByte / 8] |= (uint8_t) (1 << (firstByte % 8));
+}
+
+void trustedAddress_initialize()
+{
+	os_memset(&appContext->trustedAddressFilter, 0, SIZEOF(appContext->trustedAddressFilter));
+
+	uint8_t digest[STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE];
+	for (uint8_t i = 0; i < storage_getTrustedAddressCount(); i++) {
+		storage_readTrustedAddress(i, digest, SIZEOF(digest));
+		trustedAddress_filterAdd(digest[0]);
+	}
+}
+
+bool trustedAddress_find(const uint8_t* digest, size_t digestSize, uint8_t* index)
+{
+	ASSERT(digestSize == STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE);
+
+	if (!trustedAddress_filterContains(digest[0])) return false;
+
+	uint8_t storedDigest[STORAGE_TRUSTED_ADDRESS_DIGEST_SIZE];
+	for (uint8_t i = 0; i < storage_getTrustedAddressCount(); i++) {
+		storage_readTrustedAddress(i, storedDigest, SIZEOF(storedDigest));
+		if (os_memcmp(storedDigest, digest, digestSize) == 0) {
+			*index = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool trustedAddress_contains(const uint8_t* digest, size_t digestSize)
+{
+	uint8_t index;
+	return trustedAddress_find(digest, digestSize, &index);
+}
+
+uint8_t trustedAddress_getCount()
+{
+	return storage_getTrustedAddressCount();
+}
+
+void trustedAddress_clearAll()
+{
+	storage_clearTrustedAddresses();
+	os_memset(&appContext->trustedAddressFilter, 0, SIZEOF(appContext->trustedAddressFilter));
+}
+
+
+#define ctx (&appContext->instructionState.addTrustedAddressContext)
+
+// forward declaration
+static void addTrustedAddress_ui_runStep();
+enum {
+	ADD_TRUSTED_ADDRESS_STEP_DISPLAY = 100,
+	ADD_TRUSTED_ADDRESS_STEP_CONFIRM,
+	ADD_TRUSTED_ADDRESS_STEP_RESPOND,
+	ADD_TRUSTED_ADDRESS_STEP_INVALID,
+};
+
+void addTrustedAddress_handleAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        uint8_t* wireDataBuffer,
+        size_t wireDataSize,
+        bool isNewCall
+)
+{
+	if (isNewCall) {
+		os_memset(ctx, 0, SIZEOF(*ctx));
+	}
+
+	VALIDATE(p1 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(p2 == 0, ERR_INVALID_REQUEST_PARAMETERS);
+	// The user has to be able to check the whole address
+	VALIDATE(wireDataSize <= BASE58_MAX_INPUT_SIZE, ERR_INVALID_DATA);
+	ASSERT(wireDataSize <= SIZEOF(ctx->address.buffer));
+
+	os_memmove(ctx->address.buffer, wireDataBuffer, wireDataSize);
+	ctx->address.size = wireDataSize;
+
+	const uint8_t* rawAddressBuffer = NULL;
+	size_t rawAddressSize = unboxChecksummedAddressInPlace(
+	                                ctx->address.buffer, ctx->address.size,
+	                                &rawAddressBuffer
+	                        );
+	blake2b_224_hash(rawAddressBuffer, rawAddressSize, ctx->digest, SIZEOF(ctx->digest));
+
+	// Note: adding an address which is already trusted is a no-op
+	if (!trustedAddress_contains(ctx->digest, SIZEOF(ctx->digest))) {
+		VALIDATE(trustedAddress_getCount() < STORAGE_TRUSTED_ADDRESSES_CAPACITY, ERR_INVALID_STATE);
+	}
+
+	security_policy_t policy = policyForAddTrustedAddress();
+	ENSURE_NOT_DENIED(policy);
+
+	switch (policy) {
+#	define  CASE(policy, step) case policy: {ctx->ui_step = step; break;}
+		CASE(POLICY_PROMPT_BEFORE_RESPONSE, ADD_TRUSTED_ADDRESS_STEP_DISPLAY);
+		CASE(POLICY_ALLOW_WITHOUT_PROMPT,   ADD_TRUSTED_ADDRESS_STEP_RESPOND);
+#	undef   CASE
+	default:
+		THROW(ERR_NOT_IMPLEMENTED);
+	}
+	addTrustedAddress_ui_runStep();
+}
+
+static void addTrustedAddress_ui_runStep()
+{
+	TRACE("step %d", ctx->ui_step);
+	ui_callback_fn_t* this_fn = addTrustedAddress_ui_runStep;
+
+	UI_STEP_BEGIN(ctx->ui_step);
+
+	UI_STEP(ADD_TRUSTED_ADDRESS_STEP_DISPLAY) {
+		char address58Str[200];
+		encode_base58(
+		        ctx->address.buffer,
+		        ctx->address.size,
+		        address58Str,
+		        SIZEOF(address58Str)
+		);
+		ui_displayPaginatedText(
+		        "Trusted address",
+		        address58Str,
+		        this_fn
+		);
+	}
+	UI_STEP(ADD_TRUSTED_ADDRESS_STEP_CONFIRM) {
+		ui_displayPrompt(
+		        "Skip review of",
+		        "outputs to it?",
+		        this_fn,
+		        respond_with_user_reject
+		);
+	}
+	UI_STEP(ADD_TRUSTED_ADDRESS_STEP_RESPOND) {
+		if (!trustedAddress_contains(ctx->digest, SIZEOF(ctx->digest))) {
+			storage_addTrustedAddress(ctx->digest, SIZEOF(ctx->digest));
+			trustedAddress_filterAdd(ctx->digest[0]);
+		}
+
+		io_send_buf(SUCCESS, NULL, 0);
+		ui_idle();
+	}
+	UI_STEP_END(ADD_TRUSTED_ADDRESS_STEP_INVALID);
+}
@@ -0,0 +1,38 @@
+#ifndef H_CARDANO_APP_TRUSTED_ADDRESS
+#define H_CARDANO_APP_TRUSTED_ADDRESS
+
+#include "common.h"
+#include "handlers.h"
+#include "hash.h"
+
+typedef struct {
+	// Boxed (checksummed) address as sent by the host
+	struct {
+		uint8_t buffer[200];
+		size_t size;
+	} address;
+	uint8_t digest[BLAKE2B_224_SIZE];
+	int ui_step;
+} ins_add_trusted_address_context_t;
+
+// First bytes of all stored digests. Most outputs are not trusted
+// and this lets us reject them without scanning NVRAM entries.
+typedef struct {
+	uint8_t bits[256 / 8];
+} trustedAddressFilter_t;
+
+handler_fn_t addTrustedAddress_handleAPDU;
+
+// Should be called at app startup (after storage_initialize)
+void trustedAddress_initialize();
+
+// Digest is blake2b_224 of the raw (unboxed) address
+bool trustedAddress_contains(const uint8_t* digest, size_t digestSize);
+// Same as trustedAddress_contains, also returns the index of the address
+// in the registry (stable until the registry is cleared)
+bool trustedAddress_find(const uint8_t* digest, size_t digestSize, uint8_t* index);
+
+uint8_t trustedAddress_getCount();
+void trustedAddress_clearAll();
+
+#endif
@@ -8,25 +8,36 @@
 
 // Syntactic sugar
 #define BUILDER_APPEND_CBOR(type, value) \
-	blake2b_256_append_cbor(&builder->txHash, type, value)
+	txHashBuilder_appendCbor(builder, type, value)
 
 #define BUILDER_APPEND_DATA(buffer, bufferSize) \
-	blake2b_256_append(&builder->txHash, buffer, bufferSize)
+	txHashBuilder_appendData(builder, buffer, bufferSize)
 
 
-void blake2b_256_append_cbor(
-        blake2b_256_context_t* hashCtx,
+static void txHashBuilder_appendData(
+        tx_hash_builder_t* builder,
+        const uint8_t* buffer, size_t bufferSize
+)
+{
+	ASSERT(bufferSize < BUFFER_SIZE_PARANOIA);
+	blake2b_256_append(&builder->txHash, buffer, bufferSize);
+	builder->serializedSize += bufferSize;
+}
+
+static void txHashBuilder_appendCbor(
+        tx_hash_builder_t* builder,
         uint8_t type, uint64_t value
 )
 {
 	uint8_t buffer[10];
 	size_t size = cbor_writeToken(type, value, buffer, SIZEOF(buffer));
-	blake2b_256_append(hashCtx, buffer, size);
+	txHashBuilder_appendData(builder, buffer, size);
 }
 
 void txHashBuilder_init(tx_hash_builder_t* builder)
 {
 	blake2b_256_init(&builder->txHash);
+	builder->serializedSize = 0;
 	{
 		// main preamble
 		BUILDER_APPEND_CBOR(CBOR_TYPE_ARRAY, 3);
@@ -122,13 +133,13 @@ void txHashBuilder_enterOutputs(tx_hash_builder_t* builder)
 	builder->state = TX_HASH_BUILDER_IN_OUTPUTS;
 }
 
-void txHashBuilder_addOutput(
+void txHashBuilder_beginOutput(
         tx_hash_builder_t* builder,
-        const uint8_t* rawAddressBuffer, size_t rawAddressSize,
-        uint64_t amount
+        size_t rawAddressSize
 )
 {
 	ASSERT(builder->state == TX_HASH_BUILDER_IN_OUTPUTS);
+	ASSERT(rawAddressSize < BUFFER_SIZE_PARANOIA);
 
 	// Array(2)[
 	//   Array(2)[
@@ -147,9 +158,39 @@ void txHashBuilder_addOutput(
 			{
 				BUILDER_APPEND_CBOR(CBOR_TYPE_TAG, CBOR_TAG_EMBEDDED_CBOR_BYTE_STRING);
 				BUILDER_APPEND_CBOR(CBOR_TYPE_BYTES, rawAddressSize);
-				BUILDER_APPEND_DATA(rawAddressBuffer, rawAddressSize);
-			} {
-				uint32_t checksum = crc32(rawAddressBuffer, rawAddressSize);
+				// raw address follows in chunks
+			}
+		}
+	}
+	builder->outputAddress.remainingSize = rawAddressSize;
+	builder->outputAddress.crc = crc32_init();
+	builder->state = TX_HASH_BUILDER_IN_OUTPUT_ADDRESS;
+}
+
+void txHashBuilder_addOutputAddressChunk(
+        tx_hash_builder_t* builder,
+        const uint8_t* chunkBuffer, size_t chunkSize
+)
+{
+	ASSERT(builder->state == TX_HASH_BUILDER_IN_OUTPUT_ADDRESS);
+	ASSERT(chunkSize <= builder->outputAddress.remainingSize);
+
+	BUILDER_APPEND_DATA(chunkBuffer, chunkSize);
+	builder->outputAddress.crc = crc32_update(builder->outputAddress.crc, chunkBuffer, chunkSize);
+	builder->outputAddress.remainingSize -= chunkSize;
+}
+
+void txHashBuilder_endOutput(
+        tx_hash_builder_t* builder,
+        uint64_t amount
+)
+{
+	ASSERT(builder->state == TX_HASH_BUILDER_IN_OUTPUT_ADDRESS);
+	ASSERT(builder->outputAddress.remainingSize == 0);
+	{
+		{
+			{
+				uint32_t checksum = crc32_finalize(builder->outputAddress.crc);
 				BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, checksum);
 			}
 		} {
@@ -157,6 +198,18 @@ void txHashBuilder_addOutput(
 			BUILDER_APPEND_CBOR(CBOR_TYPE_UNSIGNED, amount);
 		}
 	}
+	builder->state = TX_HASH_BUILDER_IN_OUTPUTS;
+}
+
+void txHashBuilder_addOutput(
+        tx_hash_builder_t* builder,
+        const uint8_t* rawAddressBuffer, size_t rawAddressSize,
+        uint64_t amount
+)
+{
+	txHashBuilder_beginOutput(builder, rawAddressSize);
+	txHashBuilder_addOutputAddressChunk(builder, rawAddressBuffer, rawAddressSize);
+	txHashBuilder_endOutput(builder, amount);
 }
 
 void txHashBuilder_enterMetadata(tx_hash_builder_t* builder)
@@ -172,10 +225,60 @@ void txHashBuilder_enterMetadata(tx_hash_builder_t* builder)
 	builder->state = TX_HASH_BUILDER_IN_METADATA;
 }
 
+void txHashBuilder_enterMetadataChunks(tx_hash_builder_t* builder)
+{
+	ASSERT(builder->state == TX_HASH_BUILDER_IN_OUTPUTS);
+	{
+		// End outputs
+		BUILDER_APPEND_CBOR(CBOR_TYPE_INDEF_END, 0);
+		// Attributes follow as raw data
+	}
+	builder->state = TX_HASH_BUILDER_IN_METADATA_CHUNKS;
+}
+
+void txHashBuilder_addMetadataChunk(
+        tx_hash_builder_t* builder,
+        const uint8_t* chunkBuffer, size_t chunkSize
+)
+{
+	ASSERT(builder->state == TX_HASH_BUILDER_IN_METADATA_CHUNKS);
+	BUILDER_APPEND_DATA(chunkBuffer, chunkSize);
+}
+
+void txHashBuilder_finishMetadataChunks(tx_hash_builder_t* builder)
+{
+	ASSERT(builder->state == TX_HASH_BUILDER_IN_METADATA_CHUNKS);
+	builder->state = TX_HASH_BUILDER_IN_METADATA;
+}
+
+void txHashBuilder_initRaw(tx_hash_builder_t* builder)
+{
+	blake2b_256_init(&builder->txHash);
+	builder->serializedSize = 0;
+	builder->state = TX_HASH_BUILDER_RAW;
+}
+
+void txHashBuilder_appendRaw(
+        tx_hash_builder_t* builder,
+        const uint8_t* chunkBuffer, size_t chunkSize
+)
+{
+	ASSERT(builder->state == TX_HASH_BUILDER_RAW);
+	BUILDER_APPEND_DATA(chunkBuffer, chunkSize);
+}
+
+
+size_t txHashBuilder_getSerializedSize(const tx_hash_builder_t* builder)
+{
+	return builder->serializedSize;
+}
 
 void txHashBuilder_finalize(tx_hash_builder_t* builder, uint8_t* outBuffer, size_t outSize)
 {
-	ASSERT(builder->state == TX_HASH_BUILDER_IN_METADATA);
+	ASSERT(
+	        builder->state == TX_HASH_BUILDER_IN_METADATA ||
+	        builder->state == TX_HASH_BUILDER_RAW
+	);
 	ASSERT(outSize == 32);
 	{
 		blake2b_256_finalize(&builder->txHash, outBuffer, outSize);
@@ -9,11 +9,21 @@ typedef enum {
 	TX_HASH_BUILDER_IN_OUTPUTS = 3,
 	TX_HASH_BUILDER_IN_METADATA = 4,
 	TX_HASH_BUILDER_FINISHED = 5,
+	TX_HASH_BUILDER_IN_METADATA_CHUNKS = 6,
+	TX_HASH_BUILDER_IN_OUTPUT_ADDRESS = 7,
+	TX_HASH_BUILDER_RAW = 8,
 } tx_hash_builder_state_t;
 
 typedef struct {
 	tx_hash_builder_state_t state;
 	blake2b_256_context_t txHash;
+	// Number of bytes of the serialized transaction body so far
+	size_t serializedSize;
+	// Output address being streamed
+	struct {
+		size_t remainingSize;
+		uint32_t crc;
+	} outputAddress;
 } tx_hash_builder_t;
 
 
@@ -35,8 +45,43 @@ void txHashBuilder_addOutput(
         uint64_t amount
 );
 
+// Same as txHashBuilder_addOutput but the raw address is streamed
+// in chunks (checksum is computed incrementally)
+void txHashBuilder_beginOutput(
+        tx_hash_builder_t* builder,
+        size_t rawAddressSize
+);
+void txHashBuilder_addOutputAddressChunk(
+        tx_hash_builder_t* builder,
+        const uint8_t* chunkBuffer, size_t chunkSize
+);
+void txHashBuilder_endOutput(
+        tx_hash_builder_t* builder,
+        uint64_t amount
+);
+
+// Empty attributes
 void txHashBuilder_enterMetadata(tx_hash_builder_t* builder);
 
+// Attributes streamed by the caller as raw CBOR chunks.
+// Note: the caller is responsible for validating the CBOR
+void txHashBuilder_enterMetadataChunks(tx_hash_builder_t* builder);
+void txHashBuilder_addMetadataChunk(
+        tx_hash_builder_t* builder,
+        const uint8_t* chunkBuffer, size_t chunkSize
+);
+void txHashBuilder_finishMetadataChunks(tx_hash_builder_t* builder);
+
+// Serialized transaction body supplied by the caller and hashed as is.
+// Note: the caller is responsible for parsing/validating it
+void txHashBuilder_initRaw(tx_hash_builder_t* builder);
+void txHashBuilder_appendRaw(
+        tx_hash_builder_t* builder,
+        const uint8_t* chunkBuffer, size_t chunkSize
+);
+
+size_t txHashBuilder_getSerializedSize(const tx_hash_builder_t* builder);
+
 void txHashBuilder_finalize(
         tx_hash_builder_t* builder,
         uint8_t* outBuffer, size_t outSize
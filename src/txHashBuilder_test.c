@@ -4,6 +4,7 @@
 #include "txHashBuilder.h"
 #include "hex_utils.h"
 #include "test_utils.h"
+#include "cbor.h"
 
 static struct {
 	const char* txHashHex;
@@ -52,38 +53,56 @@ static struct {
 };
 
 static const char* expectedHex = "f33b1f56240c9f4afc9dd9a9141737b2937b6cd856dd67fda81cc794d2670580";
+static const size_t expectedSerializedSize = 462;
 
 
-void run_txHashBuilder_test()
+// Outputs are streamed in chunks of given size, 0 means all at once
+static void addInputsAndOutputs(tx_hash_builder_t* builder, size_t outputChunkSize)
 {
-	PRINTF("txHashBuilder test\n");
-	tx_hash_builder_t builder;
-	txHashBuilder_init(&builder);
-
-	txHashBuilder_enterInputs(&builder);
+	txHashBuilder_enterInputs(builder);
 	ITERATE(it, inputs) {
 		uint8_t tmp[32];
 		size_t tmpSize = parseHexString(PTR_PIC(it->txHashHex), tmp, SIZEOF(tmp));
 		txHashBuilder_addUtxoInput(
-		        &builder,
+		        builder,
 		        tmp, tmpSize,
 		        it->index
 		);
 	}
 
-	txHashBuilder_enterOutputs(&builder);
+	txHashBuilder_enterOutputs(builder);
 	ITERATE(it, outputs) {
 		uint8_t tmp[70];
 		size_t tmpSize = parseHexString(PTR_PIC(it->rawAddressHex), tmp, SIZEOF(tmp));
-		txHashBuilder_addOutput(
-		        &builder,
-		        tmp, tmpSize,
-		        it->amount
-		);
+		if (outputChunkSize == 0) {
+			txHashBuilder_addOutput(
+			        builder,
+			        tmp, tmpSize,
+			        it->amount
+			);
+		} else {
+			txHashBuilder_beginOutput(builder, tmpSize);
+			for (size_t i = 0; i < tmpSize; i += outputChunkSize) {
+				size_t chunkSize = (outputChunkSize < tmpSize - i) ? outputChunkSize : tmpSize - i;
+				txHashBuilder_addOutputAddressChunk(builder, tmp + i, chunkSize);
+			}
+			txHashBuilder_endOutput(builder, it->amount);
+		}
 	}
+}
+
+static void test_emptyMetadata()
+{
+	PRINTF("txHashBuilder test\n");
+	tx_hash_builder_t builder;
+	txHashBuilder_init(&builder);
+
+	addInputsAndOutputs(&builder, 0);
 
 	txHashBuilder_enterMetadata(&builder);
 
+	EXPECT_EQ(txHashBuilder_getSerializedSize(&builder), expectedSerializedSize);
+
 	uint8_t expected[32];
 	parseHexString(expectedHex, expected, SIZEOF(expected));
 
@@ -96,4 +115,58 @@ void run_txHashBuilder_test()
 	EXPECT_EQ_BYTES(result, expected, 32);
 }
 
+// Streaming an empty map must give the same hash as enterMetadata
+static void test_metadataChunks()
+{
+	PRINTF("txHashBuilder metadata chunks test\n");
+	tx_hash_builder_t builder;
+	txHashBuilder_init(&builder);
+
+	addInputsAndOutputs(&builder, 0);
+
+	txHashBuilder_enterMetadataChunks(&builder);
+	const uint8_t emptyMap[] = {CBOR_TYPE_MAP};
+	txHashBuilder_addMetadataChunk(&builder, emptyMap, SIZEOF(emptyMap));
+	txHashBuilder_finishMetadataChunks(&builder);
+
+	EXPECT_EQ(txHashBuilder_getSerializedSize(&builder), expectedSerializedSize);
+
+	uint8_t expected[32];
+	parseHexString(expectedHex, expected, SIZEOF(expected));
+
+	uint8_t result[32];
+	txHashBuilder_finalize(&builder, result, SIZEOF(result));
+
+	EXPECT_EQ_BYTES(result, expected, 32);
+}
+
+// Streaming output addresses must give the same hash as addOutput
+static void test_outputChunks()
+{
+	PRINTF("txHashBuilder output chunks test\n");
+	tx_hash_builder_t builder;
+	txHashBuilder_init(&builder);
+
+	addInputsAndOutputs(&builder, 7);
+
+	txHashBuilder_enterMetadata(&builder);
+
+	EXPECT_EQ(txHashBuilder_getSerializedSize(&builder), expectedSerializedSize);
+
+	uint8_t expected[32];
+	parseHexString(expectedHex, expected, SIZEOF(expected));
+
+	uint8_t result[32];
+	txHashBuilder_finalize(&builder, result, SIZEOF(result));
+
+	EXPECT_EQ_BYTES(result, expected, 32);
+}
+
+void run_txHashBuilder_test()
+{
+	test_emptyMetadata();
+	test_metadataChunks();
+	test_outputChunks();
+}
+
 #endif
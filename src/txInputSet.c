@@ -0,0 +1,72 @@
+#include "common.h"
+#include "txInputSet.h"
+#include "hash.h"
+#include "endian.h"
+#include "syscalls.h"
+
+void txInputSet_init(tx_input_set_t* set)
+{
+	MEMCLEAR(set, tx_input_set_t);
+	cx_rng(set->salt, SIZEOF(set->salt));
+}
+
+// Note: bloom filter positions and the fingerprint
+// are taken from a single salted hash of the input
+static void txInputSet_hashInput(
+        const tx_input_set_t* set,
+        const uint8_t* txHashBuffer, size_t txHashSize,
+        uint32_t index,
+        uint8_t* outBuffer, size_t outSize
+)
+{
+	uint8_t indexBuffer[4];
+	u4be_write(indexBuffer, index);
+
+	blake2b_256_context_t hashCtx;
+	blake2b_256_init(&hashCtx);
+	blake2b_256_append(&hashCtx, set->salt, SIZEOF(set->salt));
+	blake2b_256_append(&hashCtx, txHashBuffer, txHashSize);
+	blake2b_256_append(&hashCtx, indexBuffer, SIZEOF(indexBuffer));
+	blake2b_256_finalize(&hashCtx, outBuffer, outSize);
+}
+
+bool txInputSet_tryAdd(
+        tx_input_set_t* set,
+        const uint8_t* txHashBuffer, size_t txHashSize,
+        uint32_t index
+)
+{
+	ASSERT(txHashSize == 32);
+	ASSERT(set->size <= TX_INPUT_SET_CAPACITY);
+
+	uint8_t digest[BLAKE2B_256_SIZE];
+	txInputSet_hashInput(set, txHashBuffer, txHashSize, index, digest, SIZEOF(digest));
+
+	STATIC_ASSERT(TX_INPUT_SET_BLOOM_BITS == 512, "bloom positions are 9 bits");
+	STATIC_ASSERT(2 * TX_INPUT_SET_BLOOM_HASHES + 4 <= BLAKE2B_256_SIZE, "digest too short");
+
+	bool isInBloom = true;
+	uint16_t positions[TX_INPUT_SET_BLOOM_HASHES];
+	for (size_t i = 0; i < TX_INPUT_SET_BLOOM_HASHES; i++) {
+		positions[i] = u2be_read(digest + 2 * i) % TX_INPUT_SET_BLOOM_BITS;
+		if (!(set->bloom[positions[i] / 8] & (1 << (positions[i] % 8)))) {
+			isInBloom = false;
+		}
+	}
+	uint32_t fingerprint = u4be_read(digest + 2 * TX_INPUT_SET_BLOOM_HASHES);
+
+	if (isInBloom) {
+		// Most likely a duplicate, check fingerprints to rule out a false positive
+		for (size_t i = 0; i < set->size; i++) {
+			if (set->fingerprints[i] == fingerprint) return false;
+		}
+	}
+
+	VALIDATE(set->size < TX_INPUT_SET_CAPACITY, ERR_TX_TOO_LARGE);
+	set->fingerprints[set->size] = fingerprint;
+	set->size++;
+	for (size_t i = 0; i < TX_INPUT_SET_BLOOM_HASHES; i++) {
+		set->bloom[positions[i] / 8] |= (uint8_t) (1 << (positions[i] % 8));
+	}
+	return true;
+}
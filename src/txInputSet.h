@@ -0,0 +1,43 @@
+#ifndef H_CARDANO_APP_TX_INPUT_SET
+#define H_CARDANO_APP_TX_INPUT_SET
+
+#include "common.h"
+
+// Constant-memory set of transaction inputs used to reject duplicates.
+// A (salted) Bloom filter answers most lookups in O(1), its positives
+// are re-checked against a table of 32-bit fingerprints.
+
+enum {
+	// Note: each input needs at least ~40 bytes of tx body and a 139 byte
+	// witness so no more than ~22 inputs fit into the maximum tx size.
+	// Transactions of a signing session share the set, the capacity is
+	// what fits into Nano S RAM (see state.c)
+	TX_INPUT_SET_CAPACITY = 40,
+	TX_INPUT_SET_BLOOM_BITS = 512,
+	TX_INPUT_SET_BLOOM_HASHES = 3,
+	TX_INPUT_SET_SALT_SIZE = 16,
+};
+
+typedef struct {
+	// Random per-set salt, the host cannot predict filter positions
+	uint8_t salt[TX_INPUT_SET_SALT_SIZE];
+	uint8_t bloom[TX_INPUT_SET_BLOOM_BITS / 8];
+	uint32_t fingerprints[TX_INPUT_SET_CAPACITY];
+	uint16_t size;
+} tx_input_set_t;
+
+void txInputSet_init(tx_input_set_t* set);
+
+// Returns false if the input is (most likely) already in the set.
+// Throws ERR_TX_TOO_LARGE if the set is full
+bool txInputSet_tryAdd(
+        tx_input_set_t* set,
+        const uint8_t* txHashBuffer, size_t txHashSize,
+        uint32_t index
+);
+
+#ifdef DEVEL
+void run_txInputSet_test();
+#endif
+
+#endif
@@ -0,0 +1,37 @@
+#ifdef DEVEL
+
+#include "common.h"
+#include "txInputSet.h"
+#include "test_utils.h"
+
+void run_txInputSet_test()
+{
+	PRINTF("txInputSet test\n");
+
+	tx_input_set_t set;
+	txInputSet_init(&set);
+
+	uint8_t txHash[32];
+	os_memset(txHash, 0x42, SIZEOF(txHash));
+
+	for (uint32_t index = 0; index < 10; index++) {
+		EXPECT_EQ(txInputSet_tryAdd(&set, txHash, SIZEOF(txHash), index), true);
+	}
+	for (uint32_t index = 0; index < 10; index++) {
+		EXPECT_EQ(txInputSet_tryAdd(&set, txHash, SIZEOF(txHash), index), false);
+	}
+
+	// Same index, different transaction
+	txHash[31] ^= 1;
+	EXPECT_EQ(txInputSet_tryAdd(&set, txHash, SIZEOF(txHash), 0), true);
+	EXPECT_EQ(txInputSet_tryAdd(&set, txHash, SIZEOF(txHash), 0), false);
+	EXPECT_EQ(set.size, 11);
+
+	// Fill up
+	for (uint32_t index = 100; set.size < TX_INPUT_SET_CAPACITY; index++) {
+		EXPECT_EQ(txInputSet_tryAdd(&set, txHash, SIZEOF(txHash), index), true);
+	}
+	EXPECT_THROWS(txInputSet_tryAdd(&set, txHash, SIZEOF(txHash), 1000), ERR_TX_TOO_LARGE);
+}
+
+#endif
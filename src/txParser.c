@@ -0,0 +1,329 @@
+#include "common.h"
+#include "txParser.h"
+#include "cbor.h"
+#include "cardano.h"
+#include "crc32.h"
+
+static const uint16_t TX_PARSER_INIT_MAGIC = 4747;
+
+static inline size_t size_min(size_t x, size_t y)
+{
+	return (x < y) ? x : y;
+}
+
+// Copies (part of) the raw address into the output buffer
+static void txParser_takeAddressBytes(tx_parser_state_t* state)
+{
+	stream_t* stream = &state->stream; // shorthand
+	stream_ensureAvailableBytes(stream, 1); // We have to consume at least something
+	size_t bytesToConsume =
+	        size_min(
+	                stream_availableBytes(stream),
+	                state->output.addressDataRemainingBytes
+	        );
+	ASSERT(bytesToConsume < BUFFER_SIZE_PARANOIA);
+	ASSERT(state->output.rawAddressSize + bytesToConsume <= SIZEOF(state->output.rawAddress));
+
+	const uint8_t* data = stream_head(stream);
+	os_memmove(state->output.rawAddress + state->output.rawAddressSize, data, bytesToConsume);
+	state->output.crc = crc32_update(state->output.crc, data, bytesToConsume);
+	state->output.rawAddressSize += bytesToConsume;
+	state->output.addressDataRemainingBytes -= bytesToConsume;
+
+	stream_advancePos(stream, bytesToConsume);
+}
+
+// Feeds attributes through the validator. Note that anything after
+// the attributes would be trailing data and the validator rejects it
+static void txParser_takeAttributesBytes(tx_parser_state_t* state)
+{
+	stream_t* stream = &state->stream; // shorthand
+	stream_ensureAvailableBytes(stream, 1); // We have to consume at least something
+	size_t bytesToConsume = stream_availableBytes(stream);
+	ASSERT(bytesToConsume < BUFFER_SIZE_PARANOIA);
+
+	cborValidator_feed(&state->attributes.validator, stream_head(stream), bytesToConsume);
+	state->attributes.size += bytesToConsume;
+
+	stream_advancePos(stream, bytesToConsume);
+}
+
+// Performs a single transition on the Input parser
+static void txParser_advanceInputState(tx_parser_state_t* state)
+{
+	stream_t* stream = &state->stream; // shorthand
+
+// Note: see attestUtxo.c for the explanation of the parser macros.
+// The same rule applies -- code between TRANSITION_TO *must* be atomic
+// if throwing ERR_NOT_ENOUGH_INPUT
+#define PARSER_BEGIN switch (state->inputState) { case TXP_INPUT_NOT_STARTED:
+#define PARSER_END   break; default: ASSERT(false); }
+#define TRANSITION_TO(NEXT_STATE) state->inputState = NEXT_STATE; break; case NEXT_STATE:
+
+	// Array(2)[
+	//    Unsigned[0],
+	//    Tag(24):Bytes[
+	//       Array(2)[
+	//          Bytes(32)[tx hash],
+	//          Unsigned[output index]
+	//       ]
+	//    ]
+	// ]
+	PARSER_BEGIN;
+
+	TRANSITION_TO(TXP_INPUT_EXPECT_PREAMBLE);
+
+	cbor_takeTokenWithValue(stream, CBOR_TYPE_ARRAY, 2);
+	{
+		TRANSITION_TO(TXP_INPUT_EXPECT_TYPE);
+
+		cbor_takeTokenWithValue(stream, CBOR_TYPE_UNSIGNED, CARDANO_INPUT_TYPE_UTXO);
+	}
+	{
+		TRANSITION_TO(TXP_INPUT_EXPECT_TAG);
+
+		cbor_takeTokenWithValue(stream, CBOR_TYPE_TAG, CBOR_TAG_EMBEDDED_CBOR_BYTE_STRING);
+
+		TRANSITION_TO(TXP_INPUT_EXPECT_DATA_PREAMBLE);
+
+		uint64_t dataSize = cbor_takeToken(stream, CBOR_TYPE_BYTES);
+		// Embedded utxo is short, anything else is suspicious
+		VALIDATE(dataSize < BUFFER_SIZE_PARANOIA, ERR_INVALID_DATA);
+		state->embeddedDataEnd = stream->streamPos + (size_t) dataSize;
+		{
+			TRANSITION_TO(TXP_INPUT_EXPECT_UTXO_PREAMBLE);
+
+			cbor_takeTokenWithValue(stream, CBOR_TYPE_ARRAY, 2);
+
+			TRANSITION_TO(TXP_INPUT_EXPECT_TX_HASH_PREAMBLE);
+
+			cbor_takeTokenWithValue(stream, CBOR_TYPE_BYTES, SIZEOF(state->input.txHash));
+
+			TRANSITION_TO(TXP_INPUT_IN_TX_HASH);
+
+			stream_ensureAvailableBytes(stream, SIZEOF(state->input.txHash));
+			os_memmove(state->input.txHash, stream_head(stream), SIZEOF(state->input.txHash));
+			stream_advancePos(stream, SIZEOF(state->input.txHash));
+
+			TRANSITION_TO(TXP_INPUT_EXPECT_INDEX);
+
+			uint64_t index = cbor_takeToken(stream, CBOR_TYPE_UNSIGNED);
+			VALIDATE(index <= UINT32_MAX, ERR_INVALID_DATA);
+			state->input.index = (uint32_t) index;
+		}
+		// Embedded cbor has to be consumed exactly
+		VALIDATE(stream->streamPos == state->embeddedDataEnd, ERR_INVALID_DATA);
+	}
+	TRANSITION_TO(TXP_INPUT_FINISHED);
+	{
+		// should be handled by the caller
+		ASSERT(false);
+	}
+
+	PARSER_END;
+
+#undef  PARSER_BEGIN
+#undef  PARSER_END
+#undef  TRANSITION_TO
+}
+
+// Performs a single transition on the Output parser
+static void txParser_advanceOutputState(tx_parser_state_t* state)
+{
+	stream_t* stream = &state->stream; // shorthand
+
+#define PARSER_BEGIN switch (state->outputState) { case TXP_OUTPUT_NOT_STARTED:
+#define PARSER_END   break; default: ASSERT(false); }
+#define TRANSITION_TO(NEXT_STATE) state->outputState = NEXT_STATE; break; case NEXT_STATE:
+
+	// Array(2)[
+	//   Array(2)[
+	//      Tag(24):Bytes[raw address],
+	//      Unsigned[checksum]
+	//   ],
+	//   Unsigned[amount]
+	// ]
+	PARSER_BEGIN;
+
+	TRANSITION_TO(TXP_OUTPUT_EXPECT_PREAMBLE);
+
+	cbor_takeTokenWithValue(stream, CBOR_TYPE_ARRAY, 2);
+	{
+		TRANSITION_TO(TXP_OUTPUT_EXPECT_ADDRESS_PREAMBLE);
+
+		cbor_takeTokenWithValue(stream, CBOR_TYPE_ARRAY, 2);
+		{
+			TRANSITION_TO(TXP_OUTPUT_EXPECT_ADDRESS_TAG);
+
+			cbor_takeTokenWithValue(stream, CBOR_TYPE_TAG, CBOR_TAG_EMBEDDED_CBOR_BYTE_STRING);
+
+			TRANSITION_TO(TXP_OUTPUT_EXPECT_ADDRESS_DATA_PREAMBLE);
+
+			uint64_t addressSize = cbor_takeToken(stream, CBOR_TYPE_BYTES);
+			// Note: longer addresses can still be signed using chunked outputs
+			VALIDATE(addressSize > 0, ERR_INVALID_DATA);
+			VALIDATE(addressSize <= SIZEOF(state->output.rawAddress), ERR_INVALID_DATA);
+			state->output.addressDataRemainingBytes = (size_t) addressSize;
+			state->output.rawAddressSize = 0;
+			state->output.crc = crc32_init();
+
+			TRANSITION_TO(TXP_OUTPUT_IN_ADDRESS_DATA);
+
+			if (state->output.addressDataRemainingBytes != 0) {
+				txParser_takeAddressBytes(state);
+				// Warning: this break has to be here as we might not
+				// get through all bytes in one go
+				break;
+			}
+		}
+		{
+			TRANSITION_TO(TXP_OUTPUT_EXPECT_ADDRESS_CHECKSUM);
+
+			uint64_t checksum = cbor_takeToken(stream, CBOR_TYPE_UNSIGNED);
+			VALIDATE(checksum == crc32_finalize(state->output.crc), ERR_INVALID_DATA);
+		}
+	}
+	{
+		TRANSITION_TO(TXP_OUTPUT_EXPECT_AMOUNT);
+
+		uint64_t amount = cbor_takeToken(stream, CBOR_TYPE_UNSIGNED);
+		VALIDATE(amount <= LOVELACE_MAX_SUPPLY, ERR_INVALID_DATA);
+		state->output.amount = amount;
+	}
+	TRANSITION_TO(TXP_OUTPUT_FINISHED);
+	{
+		// should be handled by the caller
+		ASSERT(false);
+	}
+
+	PARSER_END;
+
+#undef  PARSER_BEGIN
+#undef  PARSER_END
+#undef  TRANSITION_TO
+}
+
+// Makes one parsing step or throws ERR_NOT_ENOUGH_INPUT
+static void txParser_advanceMainState(tx_parser_state_t* state)
+{
+	stream_t* stream = &state->stream; // shorthand
+
+#define PARSER_BEGIN switch (state->mainState) { case TXP_MAIN_NOT_STARTED:
+#define PARSER_END   break; default: ASSERT(false); }
+#define TRANSITION_TO(NEXT_STATE) state->mainState = NEXT_STATE; break; case NEXT_STATE:
+#define JUMP(NEXT_STATE) state->mainState = NEXT_STATE; break;
+
+	PARSER_BEGIN;
+
+	TRANSITION_TO(TXP_MAIN_EXPECT_TX_PREAMBLE);
+
+	cbor_takeTokenWithValue(stream, CBOR_TYPE_ARRAY, 3);
+	{
+		TRANSITION_TO(TXP_MAIN_EXPECT_INPUTS_PREAMBLE);
+
+		cbor_takeTokenWithValue(stream, CBOR_TYPE_ARRAY_INDEF, 0);
+		{
+			TRANSITION_TO(TXP_MAIN_EXPECT_END_OR_INPUT);
+
+			if (cbor_peekNextIsIndefEnd(stream)) {
+				cbor_takeTokenWithValue(stream, CBOR_TYPE_INDEF_END, 0);
+				JUMP(TXP_MAIN_EXPECT_OUTPUTS_PREAMBLE);
+			}
+
+			VALIDATE(state->numInputs < TX_PARSER_MAX_ITEMS, ERR_INVALID_DATA);
+			MEMCLEAR(&state->input, state->input);
+			state->inputState = TXP_INPUT_NOT_STARTED;
+
+			TRANSITION_TO(TXP_MAIN_IN_INPUT);
+
+			if (state->inputState != TXP_INPUT_FINISHED) {
+				txParser_advanceInputState(state);
+				break;
+			}
+
+			state->numInputs++;
+			state->pendingEvent = TX_PARSER_EVENT_INPUT;
+			JUMP(TXP_MAIN_EXPECT_END_OR_INPUT);
+		}
+	}
+	{
+		TRANSITION_TO(TXP_MAIN_EXPECT_OUTPUTS_PREAMBLE);
+
+		cbor_takeTokenWithValue(stream, CBOR_TYPE_ARRAY_INDEF, 0);
+		{
+			TRANSITION_TO(TXP_MAIN_EXPECT_END_OR_OUTPUT);
+
+			if (cbor_peekNextIsIndefEnd(stream)) {
+				cbor_takeTokenWithValue(stream, CBOR_TYPE_INDEF_END, 0);
+				JUMP(TXP_MAIN_EXPECT_ATTRIBUTES_PREAMBLE);
+			}
+
+			VALIDATE(state->numOutputs < TX_PARSER_MAX_ITEMS, ERR_INVALID_DATA);
+			MEMCLEAR(&state->output, state->output);
+			state->outputState = TXP_OUTPUT_NOT_STARTED;
+
+			TRANSITION_TO(TXP_MAIN_IN_OUTPUT);
+
+			if (state->outputState != TXP_OUTPUT_FINISHED) {
+				txParser_advanceOutputState(state);
+				break;
+			}
+
+			state->numOutputs++;
+			state->pendingEvent = TX_PARSER_EVENT_OUTPUT;
+			JUMP(TXP_MAIN_EXPECT_END_OR_OUTPUT);
+		}
+	}
+	{
+		TRANSITION_TO(TXP_MAIN_EXPECT_ATTRIBUTES_PREAMBLE);
+
+		// Attributes must be a map, its content is only validated
+		stream_ensureAvailableBytes(stream, 1);
+		VALIDATE((stream_peekByte(stream) & CBOR_TYPE_MASK) == CBOR_TYPE_MAP, ERR_INVALID_DATA);
+		cborValidator_init(&state->attributes.validator);
+		state->attributes.size = 0;
+
+		TRANSITION_TO(TXP_MAIN_IN_ATTRIBUTES);
+
+		if (!cborValidator_isFinished(&state->attributes.validator)) {
+			txParser_takeAttributesBytes(state);
+			break;
+		}
+	}
+	TRANSITION_TO(TXP_MAIN_FINISHED);
+
+	// should be handled separately by the outer loop
+	ASSERT(false);
+
+	PARSER_END;
+
+#undef  PARSER_BEGIN
+#undef  PARSER_END
+#undef  TRANSITION_TO
+#undef  JUMP
+}
+
+void txParser_init(tx_parser_state_t* state)
+{
+	MEMCLEAR(state, tx_parser_state_t);
+	state->mainState = TXP_MAIN_NOT_STARTED;
+	state->pendingEvent = TX_PARSER_EVENT_NONE;
+	stream_init(&state->stream);
+	state->initializedMagic = TX_PARSER_INIT_MAGIC;
+}
+
+tx_parser_event_t txParser_keepParsing(tx_parser_state_t* state)
+{
+	ASSERT(state->initializedMagic == TX_PARSER_INIT_MAGIC);
+
+	while (state->mainState != TXP_MAIN_FINISHED) {
+		txParser_advanceMainState(state);
+
+		if (state->pendingEvent != TX_PARSER_EVENT_NONE) {
+			tx_parser_event_t event = state->pendingEvent;
+			state->pendingEvent = TX_PARSER_EVENT_NONE;
+			return event;
+		}
+	}
+	return TX_PARSER_EVENT_FINISHED;
+}
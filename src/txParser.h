@@ -0,0 +1,122 @@
+#ifndef H_CARDANO_APP_TX_PARSER
+#define H_CARDANO_APP_TX_PARSER
+
+#include "common.h"
+#include "stream.h"
+#include "cborValidator.h"
+
+// Incremental parser of a serialized (unsigned) transaction body
+// Array(3)[inputs, outputs, attributes]
+// The parser stops after every input and output so that
+// the caller can inspect (and e.g. display) it before continuing.
+
+// Note: For the safety concerns, we start enums
+// at non-overlapping ranges
+typedef enum {
+	TXP_MAIN_UNINITIALIZED_PARANOIA = 247,
+	TXP_MAIN_NOT_STARTED,
+	TXP_MAIN_EXPECT_TX_PREAMBLE, // array(3)
+	TXP_MAIN_EXPECT_INPUTS_PREAMBLE, // array(*)
+	TXP_MAIN_EXPECT_END_OR_INPUT,
+	TXP_MAIN_IN_INPUT,
+	// end of inputs
+	TXP_MAIN_EXPECT_OUTPUTS_PREAMBLE, // array(*)
+	TXP_MAIN_EXPECT_END_OR_OUTPUT,
+	TXP_MAIN_IN_OUTPUT,
+	// end of outputs
+	TXP_MAIN_EXPECT_ATTRIBUTES_PREAMBLE, // map
+	TXP_MAIN_IN_ATTRIBUTES,
+	TXP_MAIN_FINISHED,
+} tx_parser_main_state_t;
+
+typedef enum {
+	TXP_INPUT_UNINITIALIZED_PARANOIA = 274,
+	TXP_INPUT_NOT_STARTED,
+	TXP_INPUT_EXPECT_PREAMBLE, // array(2)
+	TXP_INPUT_EXPECT_TYPE, // unsigned(0)
+	TXP_INPUT_EXPECT_TAG, // tag(24)
+	TXP_INPUT_EXPECT_DATA_PREAMBLE, // bytes(len)
+	TXP_INPUT_EXPECT_UTXO_PREAMBLE, // array(2)
+	TXP_INPUT_EXPECT_TX_HASH_PREAMBLE, // bytes(32)
+	TXP_INPUT_IN_TX_HASH, // 32 bytes
+	TXP_INPUT_EXPECT_INDEX, // unsigned
+	TXP_INPUT_FINISHED,
+} tx_parser_input_state_t;
+
+typedef enum {
+	TXP_OUTPUT_UNINITIALIZED_PARANOIA = 347,
+	TXP_OUTPUT_NOT_STARTED,
+	TXP_OUTPUT_EXPECT_PREAMBLE, // array(2)
+	TXP_OUTPUT_EXPECT_ADDRESS_PREAMBLE, // array(2)
+	TXP_OUTPUT_EXPECT_ADDRESS_TAG, // tag(24)
+	TXP_OUTPUT_EXPECT_ADDRESS_DATA_PREAMBLE, // bytes(len)
+	TXP_OUTPUT_IN_ADDRESS_DATA, // bytestring of len
+	TXP_OUTPUT_EXPECT_ADDRESS_CHECKSUM, // unsigned
+	TXP_OUTPUT_EXPECT_AMOUNT, // unsigned
+	TXP_OUTPUT_FINISHED,
+} tx_parser_output_state_t;
+
+typedef enum {
+	TX_PARSER_EVENT_NONE = 0,
+	// parsed input is in state->input
+	TX_PARSER_EVENT_INPUT = 1,
+	// parsed output is in state->output
+	TX_PARSER_EVENT_OUTPUT = 2,
+	// whole transaction was parsed
+	TX_PARSER_EVENT_FINISHED = 3,
+} tx_parser_event_t;
+
+enum {
+	TX_PARSER_MAX_ADDRESS_SIZE = 128,
+	TX_PARSER_MAX_ITEMS = 1000,
+};
+
+typedef struct {
+	uint16_t initializedMagic;
+	tx_parser_main_state_t mainState;
+	tx_parser_input_state_t inputState;
+	tx_parser_output_state_t outputState;
+	tx_parser_event_t pendingEvent;
+
+	stream_t stream;
+
+	// Embedded cbor must be consumed exactly
+	size_t embeddedDataEnd;
+
+	uint16_t numInputs;
+	uint16_t numOutputs;
+
+	// Note: each is cleared when its parsing starts, i.e. after the event
+	// of the previous one was handled, so they can overlap
+	union {
+		struct {
+			uint8_t txHash[32];
+			uint32_t index;
+		} input;
+
+		struct {
+			uint8_t rawAddress[TX_PARSER_MAX_ADDRESS_SIZE];
+			size_t rawAddressSize;
+			size_t addressDataRemainingBytes;
+			uint32_t crc;
+			uint64_t amount;
+		} output;
+
+		struct {
+			size_t size;
+			cbor_validator_t validator;
+		} attributes;
+	};
+} tx_parser_state_t;
+
+void txParser_init(tx_parser_state_t* state);
+
+// Returns the next event or throws ERR_NOT_ENOUGH_INPUT
+// when more data is needed (append it to state->stream)
+tx_parser_event_t txParser_keepParsing(tx_parser_state_t* state);
+
+#ifdef DEVEL
+void run_txParser_test();
+#endif
+
+#endif
@@ -0,0 +1,169 @@
+#ifdef DEVEL
+
+#include "common.h"
+#include "txParser.h"
+#include "hex_utils.h"
+#include "test_utils.h"
+
+// https://cardanoexplorer.com/tx/f33b1f56240c9f4afc9dd9a9141737b2937b6cd856dd67fda81cc794d2670580
+static const char* txHex =
+        "839f8200d818582482582034bbdf0a10e7290ad22e3ee791b6b3c35c206ab8b5"
+        "1bb749a2b06489ceebf5f400ff9f8282d818584283581c5f5bee73ed41ff6c84"
+        "90dfdb4732178e0216ccf7badbe1e77d5d7ff8a101581e581c1e9a0361bdc37d"
+        "b7ab7ea2a3f187761877f3db11211fc7436131f15e001ab10129441b00000185"
+        "ae645c2d8282d818584283581cada4052647c47745abfc9e04d7dc5c5c0a8542"
+        "8f5b741be6687e6005a101581e581cd8669b0c1a9f2fccb28d3ef58ef8efad73"
+        "aead7117b6559a5f857813001acdb5f5841a1633e6208282d818584283581c65"
+        "32caadc0b498be1813d12f33bf81d68d5662255cc640b881a29315a101581e58"
+        "1cca3e553c9c63c580936df7433aac461e4efb6ce966206e083af22d0e001a9c"
+        "7427f71a19cf10348282d818584283581c6fd85cfe0ae8c346552717424229d5"
+        "ac928e72b0cbd5587a5d9bd8e5a101581e581c2b0b011ba3683d2eb420332a08"
+        "4fe7ecbdefa204c415cd7aa17e216d001a1c29005f1ac38bbcf88282d8185842"
+        "83581c431923e34d95851fba3c88e99d9d366eb1d595e5436c68da1b4699a5a1"
+        "01581e581c3054e511bd5acd29e7540b417600367915afa6f95b1a40246aa4fc"
+        "9f001af7fec6a71a794fa104ffa0";
+
+static const uint64_t expectedAmounts[] = {
+	1673668090925,
+	372500000,
+	433000500,
+	3280715000,
+	2035261700,
+};
+
+// Feeds the transaction in chunks of given size and checks parsed events
+static void test_parseTx(size_t chunkSize)
+{
+	PRINTF("test_parseTx %d\n", (int) chunkSize);
+
+	uint8_t tx[500];
+	size_t txSize = parseHexString(PTR_PIC(txHex), tx, SIZEOF(tx));
+
+	// Note: too big for the stack
+	static tx_parser_state_t state;
+	txParser_init(&state);
+
+	unsigned numInputs = 0;
+	unsigned numOutputs = 0;
+	bool isFinished = false;
+
+	for (size_t pos = 0; pos < txSize; pos += chunkSize) {
+		size_t size = (txSize - pos < chunkSize) ? txSize - pos : chunkSize;
+		stream_appendData(&state.stream, tx + pos, size);
+
+		bool needsMoreData = false;
+		while (!needsMoreData && !isFinished) {
+			BEGIN_TRY {
+				TRY {
+					tx_parser_event_t event = txParser_keepParsing(&state);
+					switch (event) {
+					case TX_PARSER_EVENT_INPUT: {
+						uint8_t expectedHash[32];
+						parseHexString(
+						        "34bbdf0a10e7290ad22e3ee791b6b3c35c206ab8b51bb749a2b06489ceebf5f4",
+						        expectedHash, SIZEOF(expectedHash)
+						);
+						EXPECT_EQ_BYTES(state.input.txHash, expectedHash, SIZEOF(expectedHash));
+						EXPECT_EQ(state.input.index, 0);
+						numInputs++;
+						break;
+					}
+					case TX_PARSER_EVENT_OUTPUT: {
+						ASSERT(numOutputs < ARRAY_LEN(expectedAmounts));
+						EXPECT_EQ(state.output.amount, expectedAmounts[numOutputs]);
+						EXPECT_EQ(state.output.rawAddressSize, 66);
+						numOutputs++;
+						break;
+					}
+					case TX_PARSER_EVENT_FINISHED: {
+						isFinished = true;
+						break;
+					}
+					default:
+						ASSERT(false);
+					}
+				}
+				CATCH(ERR_NOT_ENOUGH_INPUT)
+				{
+					needsMoreData = true;
+				}
+				FINALLY {
+				}
+			} END_TRY;
+		}
+	}
+
+	EXPECT_EQ(isFinished, true);
+	EXPECT_EQ(numInputs, 1);
+	EXPECT_EQ(numOutputs, ARRAY_LEN(expectedAmounts));
+	EXPECT_EQ(state.numInputs, 1);
+	EXPECT_EQ(state.numOutputs, ARRAY_LEN(expectedAmounts));
+	// Empty map
+	EXPECT_EQ(state.attributes.size, 1);
+	EXPECT_EQ(stream_availableBytes(&state.stream), 0);
+}
+
+static void parseAll(tx_parser_state_t* state, const char* hex)
+{
+	txParser_init(state);
+	stream_appendFromHexString(&state->stream, hex);
+	while (txParser_keepParsing(state) != TX_PARSER_EVENT_FINISHED) {
+	}
+}
+
+static void test_invalidTx()
+{
+	PRINTF("test_invalidTx\n");
+	tx_parser_state_t state;
+
+	// Bad output address checksum
+	EXPECT_THROWS(
+	        parseAll(
+	                &state,
+	                "839f8200d818582482582034bbdf0a10e7290ad22e3ee791b6b3c35c206ab8b5"
+	                "1bb749a2b06489ceebf5f400ff9f8282d818584283581c5f5bee73ed41ff6c84"
+	                "90dfdb4732178e0216ccf7badbe1e77d5d7ff8a101581e581c1e9a0361bdc37d"
+	                "b7ab7ea2a3f187761877f3db11211fc7436131f15e001ab10129451b00000185"
+	                "ae645c2dffa0"
+	        ),
+	        ERR_INVALID_DATA
+	);
+
+	// Embedded utxo with trailing byte
+	EXPECT_THROWS(
+	        parseAll(
+	                &state,
+	                "839f8200d818582582582034bbdf0a10e7290ad22e3ee791b6b3c35c206ab8b5"
+	                "1bb749a2b06489ceebf5f40000ff9fffa0"
+	        ),
+	        ERR_INVALID_DATA
+	);
+
+	// Attributes are not a map
+	EXPECT_THROWS(
+	        parseAll(
+	                &state,
+	                "839fff9fff80"
+	        ),
+	        ERR_INVALID_DATA
+	);
+
+	// Trailing data after the transaction
+	EXPECT_THROWS(
+	        parseAll(
+	                &state,
+	                "839fff9fffa000"
+	        ),
+	        ERR_INVALID_DATA
+	);
+}
+
+void run_txParser_test()
+{
+	test_parseTx(255);
+	test_parseTx(64);
+	test_parseTx(1);
+	test_invalidTx();
+}
+
+#endif
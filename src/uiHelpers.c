@@ -5,8 +5,7 @@
 #include "io.h"
 #include "utils.h"
 #include "securityPolicy.h"
-
-displayState_t displayState;
+#include "state.h"
 
 // These are global variables declared in ux.h. They can't be defined there
 // because multiple files include ux.h; they need to be defined in exactly one
@@ -82,7 +81,7 @@ void ui_displayPrompt_headless_cb(bool ux_allowed)
 	}
 	TRY_CATCH_UI({
 		assert_uiPrompt_magic();
-		ASSERT(io_state == IO_EXPECT_UI);
+		ASSERT(appContext->io_state == IO_EXPECT_UI);
 		ASSERT(device_is_unlocked() == true);
 		uiCallback_confirm(&promptState->callback);
 	})
@@ -106,7 +105,7 @@ void ui_displayPaginatedText_headless_cb(bool ux_allowed)
 	}
 	TRY_CATCH_UI({
 		assert_uiPaginatedText_magic();
-		ASSERT(io_state == IO_EXPECT_UI);
+		ASSERT(appContext->io_state == IO_EXPECT_UI);
 		ASSERT(device_is_unlocked() == true);
 		uiCallback_confirm(&paginatedTextState->callback);
 	});
@@ -143,7 +142,7 @@ void ui_displayPrompt(
 	ASSERT(text_len < SIZEOF(promptState->text));
 
 	// clear all memory
-	os_memset(&displayState, 0, SIZEOF(displayState));
+	os_memset(&appContext->displayState, 0, SIZEOF(appContext->displayState));
 	promptState_t* ctx = promptState;
 
 	// Copy data
@@ -152,8 +151,8 @@ void ui_displayPrompt(
 
 	uiCallback_init(&ctx->callback, confirm, reject);
 	ctx->initMagic = INIT_MAGIC_PROMPT;
-	ASSERT(io_state == IO_EXPECT_NONE || io_state == IO_EXPECT_UI);
-	io_state = IO_EXPECT_UI;
+	ASSERT(appContext->io_state == IO_EXPECT_NONE || appContext->io_state == IO_EXPECT_UI);
+	appContext->io_state = IO_EXPECT_UI;
 
 	ui_displayPrompt_run();
 
@@ -196,8 +195,8 @@ void ui_displayPaginatedText(
 	ctx->initMagic = INIT_MAGIC_PAGINATED_TEXT;
 	TRACE("setting timeout");
 	TRACE("done");
-	ASSERT(io_state == IO_EXPECT_NONE || io_state == IO_EXPECT_UI);
-	io_state = IO_EXPECT_UI;
+	ASSERT(appContext->io_state == IO_EXPECT_NONE || appContext->io_state == IO_EXPECT_UI);
+	appContext->io_state = IO_EXPECT_UI;
 
 	ui_displayPaginatedText_run();
 
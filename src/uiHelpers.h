@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "securityPolicy.h"
+#include "flightRecorder.h"
 
 typedef void ui_callback_fn_t();
 
@@ -83,13 +84,9 @@ void assert_uiPrompt_magic();
 // processing
 void respond_with_user_reject();
 
-extern displayState_t displayState;
-
-// WARNING(ppershing): Following two references MUST be declared `static`
-// otherwise the Ledger will crash. I am really not sure why is this
-// but it might be related to position-independent-code compilation.
-static paginatedTextState_t* paginatedTextState = &(displayState.paginatedText);
-static promptState_t* promptState = &(displayState.prompt);
+// Note: displayState is a part of app_context_t (see state.h)
+#define paginatedTextState (&appContext->displayState.paginatedText)
+#define promptState (&appContext->displayState.prompt)
 
 enum {
 	INIT_MAGIC_PAGINATED_TEXT = 2345,
@@ -116,6 +113,8 @@ static inline void ui_crash_handler()
 		CATCH_OTHER(e) \
 		{ \
 			TRACE("Error %d\n", (int) e); \
+			flightRecorder_recordStatus((uint16_t) e); \
+			flightRecorder_saveCrash(); \
 			ui_crash_handler(); \
 		} \
 		FINALLY { \
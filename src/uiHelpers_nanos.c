@@ -3,6 +3,7 @@
 
 #include <os_io_seproxyhal.h>
 #include "uiHelpers.h"
+#include "state.h"
 
 #ifdef HEADLESS
 #define HEADLESS_UI_ELEMENT() \
@@ -81,7 +82,7 @@ unsigned int ui_paginatedText_button(
 	paginatedTextState_t* ctx = paginatedTextState;
 	TRY_CATCH_UI({
 		assert_uiPaginatedText_magic();
-		ASSERT(io_state == IO_EXPECT_UI);
+		ASSERT(appContext->io_state == IO_EXPECT_UI);
 		ASSERT(device_is_unlocked() == true);
 		switch (button_mask)
 		{
@@ -110,7 +111,7 @@ unsigned int ui_prompt_button(
 {
 	TRY_CATCH_UI({
 		assert_uiPrompt_magic();
-		ASSERT(io_state == IO_EXPECT_UI);
+		ASSERT(appContext->io_state == IO_EXPECT_UI);
 		ASSERT(device_is_unlocked() == true);
 		switch (button_mask)
 		{
@@ -133,8 +134,8 @@ static const bagl_element_t ui_paginatedText[] = {
 
 	// TODO(ppershing): what are the following magical numbers?
 
-	UI_TEXT(ID_UNSPECIFIED, 0, 12, 128, &displayState.paginatedText.header),
-	UI_TEXT(ID_UNSPECIFIED, 0, 26, 128, &displayState.paginatedText.currentText),
+	UI_TEXT(ID_UNSPECIFIED, 0, 12, 128, &appContext->displayState.paginatedText.header),
+	UI_TEXT(ID_UNSPECIFIED, 0, 26, 128, &appContext->displayState.paginatedText.currentText),
 	#ifdef HEADLESS
 	HEADLESS_UI_ELEMENT(),
 	#endif
@@ -174,8 +175,8 @@ static const bagl_element_t ui_prompt[] = {
 	UI_BACKGROUND(),
 	UI_ICON_LEFT(ID_ICON_REJECT, BAGL_GLYPH_ICON_CROSS),
 	UI_ICON_RIGHT(ID_ICON_CONFIRM, BAGL_GLYPH_ICON_CHECK),
-	UI_TEXT(ID_UNSPECIFIED, 0, 12, 128, displayState.prompt.header),
-	UI_TEXT(ID_UNSPECIFIED, 0, 26, 128, displayState.prompt.text),
+	UI_TEXT(ID_UNSPECIFIED, 0, 12, 128, appContext->displayState.prompt.header),
+	UI_TEXT(ID_UNSPECIFIED, 0, 26, 128, appContext->displayState.prompt.text),
 	#ifdef HEADLESS
 	HEADLESS_UI_ELEMENT(),
 	#endif
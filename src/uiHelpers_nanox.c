@@ -3,6 +3,7 @@
 
 #include <os_io_seproxyhal.h>
 #include "uiHelpers.h"
+#include "state.h"
 
 // Helper macro for better astyle formatting of UX_FLOW definitions
 #define LINES(...) { __VA_ARGS__ }
@@ -22,8 +23,8 @@ UX_STEP_CB(
         bnnn_paging,
         paginated_text_confirm(),
         LINES(
-                (char *) &displayState.paginatedText.header,
-                (char *) &displayState.paginatedText.fullText
+                (char *) &appContext->displayState.paginatedText.header,
+                (char *) &appContext->displayState.paginatedText.fullText
         )
 );
 
@@ -33,8 +34,8 @@ UX_STEP_CB(
         paginated_text_confirm(),
         LINES(
                 &C_icon_eye,
-                (char *) &displayState.paginatedText.header,
-                (char *) &displayState.paginatedText.fullText
+                (char *) &appContext->displayState.paginatedText.header,
+                (char *) &appContext->displayState.paginatedText.fullText
         )
 );
 
@@ -50,7 +51,7 @@ UX_FLOW(
 
 void ui_displayPaginatedText_run()
 {
-	if (strlen((const char*) &displayState.paginatedText.fullText) < 18 ) {
+	if (strlen((const char*) &appContext->displayState.paginatedText.fullText) < 18 ) {
 		ux_flow_init(0, ux_short_text_flow, NULL);
 	} else {
 		ux_layout_bnnn_paging_reset();
@@ -84,8 +85,8 @@ UX_STEP_CB(
         prompt_confirm(),
         LINES(
                 &C_icon_validate_14,
-                (char *) &displayState.paginatedText.header,
-                (char *) &displayState.paginatedText.currentText,
+                (char *) &appContext->displayState.paginatedText.header,
+                (char *) &appContext->displayState.paginatedText.currentText,
         )
 );
 
@@ -20,8 +20,13 @@
 // Does not compile if x *might* be a pointer of some kind
 // Might produce false positives on small structs...
 // Note: ARRAY_NOT_A_PTR does not compile if arg is a struct so this is a workaround
+// Note: on 64-bit hosts (see host/) any 8-byte variable would trip it
+#if __SIZEOF_POINTER__ == 4
 #define SIZEOF_NOT_A_PTR(var) \
 	(sizeof(__typeof(int[0 - (sizeof(var) == sizeof((void *)0))])) * 0)
+#else
+#define SIZEOF_NOT_A_PTR(var) 0
+#endif
 
 // Safe version of SIZEOF, does not compile if you accidentally supply a pointer
 #define SIZEOF(var) \
@@ -90,9 +95,18 @@
 // UI_STEP(2) {do something & setup callback}
 // UI_STEP_END(-1); // invalid state
 
+#ifdef DEVEL
+// See stackUsage.h
+void stackUsage_checkpoint(uint16_t uiStep);
+#define UI_STEP_CHECKPOINT(STEP) stackUsage_checkpoint((uint16_t) (STEP))
+#else
+#define UI_STEP_CHECKPOINT(STEP) do {} while(0)
+#endif
+
 #define UI_STEP_BEGIN(VAR) \
 	{ \
 		int* __ui_step_ptr = &(VAR); \
+		UI_STEP_CHECKPOINT(*__ui_step_ptr); \
 		switch(*__ui_step_ptr) { \
 			default: { \
 				ASSERT(false);
@@ -120,6 +134,8 @@
 // start using such variable. deprecated deals with that.
 #define MARK_UNUSED __attribute__ ((unused, deprecated))
 
+// Note: prints synchronously which changes the timing a lot, use
+// TRACE_EVENT (see trace.h) on the streaming paths
 #if DEVEL
 #define TRACE(...) \
 	do { \